@@ -1,6 +1,8 @@
 #include "baozi_binary_sensor.h"
 #include "baozi_device_manager.h"
 #include "baozi_json.h"
+#include "baozi_json_arena.h"
+#include "baozi_json_writer.h"
 
 namespace Baozi::HA
 {
@@ -16,19 +18,20 @@ namespace Baozi::HA
             return eResult::INVALID_STATE;
         }
 
+        BaoJsonArena arena{g_discoveryArena};
         std::string value_template = std::string("{{ value_json.") + s_state_name + " }}";
         BaoJson json = {
-            KV{"name", m_name},
-            KV{"state_topic", state_topic()},
-            KV{"value_template", value_template},
-            KV{"unit_of_measurement", s_unit_of_measurement},
-            KV{"icon", m_icon},
-            KV{"on_payload", "ON"},
-            KV{"off_payload", "OFF"}};
+            KV{"name"_key, m_name},
+            KV{"state_topic"_key, state_topic()},
+            KV{"value_template"_key, value_template},
+            KV{"unit_of_measurement"_key, s_unit_of_measurement},
+            KV{"icon"_key, m_icon},
+            KV{"on_payload"_key, "ON"},
+            KV{"off_payload"_key, "OFF"}};
 
         if (m_device_class != nullptr)
         {
-            json.AddVal("device_class", m_device_class);
+            json.AddVal("device_class"_key, m_device_class);
         }
 
         return mqtt.Publish(config_topic().c_str(), json);
@@ -42,8 +45,9 @@ namespace Baozi::HA
             return eResult::INVALID_STATE;
         }
 
-        BaoJson json{
-            KV{s_state_name, state ? "ON" : "OFF"}};
+        char payload[STATE_PAYLOAD_SIZE];
+        BaoJsonWriter json{payload};
+        json.AddVals(KV{s_state_name, state ? "ON" : "OFF"});
 
         auto topic = state_topic();
         return mqtt.Publish(topic.c_str(), json);
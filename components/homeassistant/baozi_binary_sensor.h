@@ -25,6 +25,7 @@ namespace Baozi::HA
         const char *m_device_class;
         const char *m_icon = SWITCH_ICON;
 
+        static constexpr size_t STATE_PAYLOAD_SIZE = 32;
         static inline constexpr const char *s_state_name = "state";
         static inline constexpr const char *s_unit_of_measurement = "";
 
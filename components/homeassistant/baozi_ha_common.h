@@ -10,6 +10,11 @@ namespace Baozi
 
         static inline constexpr const char *SWITCH_ICON = "mdi:toggle-switch";
 
+        // scratch memory for building discovery payloads, see BaoJsonArena. Shared by every entity, registrations
+        // of different tasks wait for each other's arena
+        static inline constexpr size_t DISCOVERY_ARENA_SIZE = 1536;
+        inline uint8_t g_discoveryArena[DISCOVERY_ARENA_SIZE];
+
         inline std::string GetDeviceName()
         {
             static char mac[10]{0};
@@ -1,6 +1,7 @@
 #include "baozi_sensor.h"
 #include "baozi_ha_common.h"
 #include "baozi_json.h"
+#include "baozi_json_arena.h"
 
 namespace Baozi::HA
 {
@@ -17,17 +18,18 @@ namespace Baozi::HA
             return eResult::INVALID_STATE;
         }
 
+        BaoJsonArena arena{g_discoveryArena};
         std::string value_template = std::string("{{ value_json.") + m_config.state_name + " | round(2) }}";
 
         BaoJson json{
-            KV{"name", m_name},
-            KV{"state_topic", state_topic()},
-            KV{"value_template", value_template},
-            KV{"unit_of_measurement", m_config.unit_of_measurement}};
+            KV{"name"_key, m_name},
+            KV{"state_topic"_key, state_topic()},
+            KV{"value_template"_key, value_template},
+            KV{"unit_of_measurement"_key, m_config.unit_of_measurement}};
 
         if (m_config.device_class != nullptr)
         {
-            json.AddVal("device_class", m_config.device_class);
+            json.AddVal("device_class"_key, m_config.device_class);
         }
 
         return mqtt.Publish(config_topic().c_str(), std::move(json));
@@ -5,6 +5,8 @@
 
 #include <string>
 #include "baozi_json_traits.h"
+#include "baozi_json_writer.h"
+#include "baozi_json_template.h"
 #include "baozi_mqtt.h"
 #include "baozi_result.h"
 #include "baozi_device_manager.h"
@@ -15,6 +17,8 @@ namespace Baozi::HA
     class Sensor
     {
     public:
+        static constexpr size_t STATE_TEMPLATE_SIZE = 32;
+
         // see examples at the bottom of this file
         struct Config
         {
@@ -22,6 +26,10 @@ namespace Baozi::HA
             const char *unit_of_measurement;
             const char *device_class;
             const char *state_name;
+            int8_t precision = JSON_PRECISION_SHORTEST; // decimals published for floating point states
+
+            // {"state_name": rendered at compile time next to the config (see below), nullptr to publish with BaoJsonWriter
+            const BaoJsonTemplate<STATE_TEMPLATE_SIZE> *state_template = nullptr;
         };
 
         Sensor(const Config &config);
@@ -38,13 +46,29 @@ namespace Baozi::HA
                 return eResult::INVALID_STATE;
             }
 
-            BaoJson json = {
-                KV{m_config.state_name, value}};
+            char payload[STATE_PAYLOAD_SIZE];
+            if constexpr (is_json_template_value_v<T>)
+            {
+                if (m_config.state_template != nullptr)
+                {
+                    if (m_config.state_template->Render(payload, sizeof(payload), value, m_config.precision) == 0)
+                    {
+                        return eResult::OUT_OF_MEMORY;
+                    }
+
+                    return mqtt.Publish(state_topic().c_str(), payload);
+                }
+            }
+
+            BaoJsonWriter json{payload};
+            json.AddVals(KV{m_config.state_name, value});
 
-            return mqtt.Publish(state_topic().c_str(), std::move(json));
+            return mqtt.Publish(state_topic().c_str(), json);
         }
 
     private:
+        static constexpr size_t STATE_PAYLOAD_SIZE = 64;
+
         std::string m_name;
         const Config &m_config;
 
@@ -53,38 +77,49 @@ namespace Baozi::HA
     };
 
     static inline constexpr const char *_temperature_name = "temperature";
+    static inline constexpr BaoJsonTemplate<Sensor::STATE_TEMPLATE_SIZE> _temperature_state{_temperature_name};
     static inline constexpr Sensor::Config TEMPERATURE_SENSOR_CONFIG = {
         .name = _temperature_name,
         .unit_of_measurement = "°C",
         .device_class = _temperature_name,
-        .state_name = _temperature_name};
+        .state_name = _temperature_name,
+        .state_template = &_temperature_state};
 
     static inline constexpr const char *_humidity_name = "humidity";
+    static inline constexpr BaoJsonTemplate<Sensor::STATE_TEMPLATE_SIZE> _humidity_state{_humidity_name};
     static inline constexpr Sensor::Config HUMIDITY_SENSOR_CONFIG = {
         .name = _humidity_name,
         .unit_of_measurement = "%",
         .device_class = _humidity_name,
-        .state_name = _humidity_name};
+        .state_name = _humidity_name,
+        .state_template = &_humidity_state};
 
+    static inline constexpr const char *_light_name = "light";
+    static inline constexpr BaoJsonTemplate<Sensor::STATE_TEMPLATE_SIZE> _light_state{_light_name};
     static inline constexpr Sensor::Config LIGHT_SENSOR_CONFIG = {
-        .name = "light",
+        .name = _light_name,
         .unit_of_measurement = "lx",
         .device_class = "illuminance",
-        .state_name = "light"};
+        .state_name = _light_name,
+        .state_template = &_light_state};
 
     static inline constexpr const char *_battery_name = "battery";
+    static inline constexpr BaoJsonTemplate<Sensor::STATE_TEMPLATE_SIZE> _battery_state{_battery_name};
     static inline constexpr Sensor::Config BATTERY_SENSOR_CONFIG = {
         .name = _battery_name,
         .unit_of_measurement = "%",
         .device_class = _battery_name,
-        .state_name = _battery_name};
+        .state_name = _battery_name,
+        .state_template = &_battery_state};
 
     static inline constexpr const char *_sound_name = "sound";
+    static inline constexpr BaoJsonTemplate<Sensor::STATE_TEMPLATE_SIZE> _sound_state{_sound_name};
     static inline constexpr Sensor::Config SOUND_SENSOR_CONFIG = {
         .name = _sound_name,
         .unit_of_measurement = "dB",
         .device_class = "sound_pressure",
-        .state_name = _sound_name};
+        .state_name = _sound_name,
+        .state_template = &_sound_state};
 
 } // namespace Baozi::HA
 
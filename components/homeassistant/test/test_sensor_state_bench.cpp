@@ -0,0 +1,61 @@
+// on-target cycles of rendering a sensor state payload - the constexpr template of each config against BaoJsonWriter,
+// what Sensor::Publish() formats with before and after the template (the host bench is test/host/json_template_bench)
+
+#include <cstdio>
+#include <cstring>
+#include "unity.h"
+#include "esp_cpu.h"
+#include "baozi_json_writer.h"
+#include "baozi_sensor.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 10000;
+    constexpr size_t PAYLOAD_SIZE = 64; // Sensor::STATE_PAYLOAD_SIZE
+
+    template <typename F>
+    uint32_t cyclesPerOp(F &&op)
+    {
+        op(); // warm up the cache
+
+        esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+        for (uint32_t i = 0; i < ITERATIONS; i++)
+            op();
+
+        return (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+    }
+
+    template <typename T>
+    void benchState(const HA::Sensor::Config &config, T value)
+    {
+        volatile T input = value; // not folded into a constant
+        char written[PAYLOAD_SIZE];
+        char rendered[PAYLOAD_SIZE];
+
+        uint32_t writer = cyclesPerOp([&] {
+            BaoJsonWriter json{written};
+            json.AddVals(KV{config.state_name, static_cast<T>(input)});
+        });
+
+        uint32_t rendering = cyclesPerOp([&] {
+            config.state_template->Render(rendered, sizeof(rendered), static_cast<T>(input), config.precision);
+        });
+
+        printf("{\"state\":\"%s\",\"writerCycles\":%lu,\"templateCycles\":%lu}\n", config.state_name,
+               (unsigned long)writer, (unsigned long)rendering);
+
+        TEST_ASSERT_EQUAL_STRING(written, rendered);
+        TEST_ASSERT_LESS_THAN_UINT32(writer, rendering);
+    }
+} // namespace
+
+TEST_CASE("sensor state payload cycles, template against writer", "[homeassistant][bench]")
+{
+    benchState(HA::TEMPERATURE_SENSOR_CONFIG, 21.5f);
+    benchState(HA::HUMIDITY_SENSOR_CONFIG, 48.25);
+    benchState(HA::LIGHT_SENSOR_CONFIG, 1250);
+    benchState(HA::BATTERY_SENSOR_CONFIG, uint8_t{87});
+    benchState(HA::SOUND_SENSOR_CONFIG, 42.7f);
+}
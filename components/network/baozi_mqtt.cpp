@@ -1,4 +1,5 @@
 #include "baozi_mqtt.h"
+#include <algorithm>
 #include "baozi_log.h"
 #include "baozi_mdns.h"
 
@@ -9,7 +10,7 @@ namespace Baozi
 
     //===============================EVENT HANDLER ==================================================
 
-    void MqttClient::mqttEventHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+    void MqttClient::mqttEventHandler(void *arg, esp_event_base_t, int32_t event_id, void *event_data)
     {
         MqttClient *client = reinterpret_cast<MqttClient *>(arg);
 
@@ -23,6 +24,7 @@ namespace Baozi
             client->Dispatch(EVENT_CONNECTED{});
             break;
         case MQTT_EVENT_DISCONNECTED:
+            client->m_reassembler.Reset();
             client->Dispatch(EVENT_DISCONNECTED{});
             break;
         case MQTT_EVENT_SUBSCRIBED:
@@ -36,7 +38,7 @@ namespace Baozi
             client->Dispatch(EVENT_PUBLISHED{});
             break;
         case MQTT_EVENT_DATA:
-            client->Dispatch(EVENT_INCOMING_DATA{.topic = event->topic, .payload = BaoJson::Parse(event->data).value_or(BaoJson{})});
+            client->onData(*event);
             break;
         case MQTT_EVENT_ERROR:
             client->Dispatch(EVENT_ERROR{});
@@ -47,6 +49,21 @@ namespace Baozi
         }
     }
 
+    // esp-mqtt holds its lock while calling the event handler, waiting here for a task that drains the inbox
+    // and publishes (waits for that lock) would deadlock, so messages are dispatched without waiting. Whole or
+    // chunked, a message is copied once, into a reassembler slot, and the event keeps the slot until it is handled
+    void MqttClient::onData(const esp_mqtt_event_t &event)
+    {
+        auto message = m_reassembler.Feed(event);
+        if (!message.has_value())
+            return;
+
+        if (!Dispatch(EVENT_INCOMING_DATA{.message = MqttHeldMessage{m_reassembler, message.value()}}))
+        {
+            BAO_LOG_WARNING("inbox full, dropping an incoming message");
+        }
+    }
+
     //===============================================================================================
     //===============================PUBLIC METHODS ==================================================
     //===============================================================================================
@@ -60,22 +77,51 @@ namespace Baozi
     {
         configASSERT(callback);
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        mqtt_event_handler_t handler{.cb = callback, .isSubscribed = subscribe(topic)};
-        m_handlers.insert_or_assign(std::string{topic}, std::move(handler));
+        subscribeHandler(topic, mqtt_event_handler_t{.cb = std::make_shared<const handler_cb_t>(std::move(callback))});
+    }
+
+    void MqttClient::On(const char *topic, mqtt_msgpack_handler_callback callback)
+    {
+        configASSERT(callback);
+
+        subscribeHandler(topic, mqtt_event_handler_t{.cb = std::make_shared<const handler_cb_t>(std::move(callback))});
     }
 
     eResult MqttClient::Publish(const char *topic, const BaoJson &msg)
     {
-        auto payload = msg.PrintRaw();
-        if (payload == nullptr)
+        auto payload = m_printPool.Print(msg.data(), topic);
+        if (!payload)
         {
             BAO_LOG_ERROR("could not print json");
             return eResult::INVALID_STATE;
         }
 
         BAO_LOG_INFO("publishing json to %s", topic);
-        return publish(topic, payload.get());
+        return publish(topic, payload.c_str(), payload.length());
+    }
+
+    eResult MqttClient::Publish(const char *topic, const BaoJsonWriter &msg)
+    {
+        if (not msg)
+        {
+            BAO_LOG_ERROR("json payload does not fit its buffer");
+            return eResult::OUT_OF_MEMORY;
+        }
+
+        BAO_LOG_INFO("publishing json to %s", topic);
+        return publish(topic, msg.c_str());
+    }
+
+    eResult MqttClient::Publish(const char *topic, const BaoMsgPackWriter &msg)
+    {
+        if (not msg)
+        {
+            BAO_LOG_ERROR("msgpack payload does not fit its buffer");
+            return eResult::OUT_OF_MEMORY;
+        }
+
+        BAO_LOG_INFO("publishing msgpack to %s", topic);
+        return publish(topic, reinterpret_cast<const char *>(msg.data()), msg.length());
     }
 
     eResult MqttClient::Publish(const char *topic, const char *msg)
@@ -86,6 +132,64 @@ namespace Baozi
         return publish(topic, msg);
     }
 
+    eResult MqttClient::PublishDelta(const char *topic, const BaoJson &msg)
+    {
+        configASSERT(cJSON_IsObject(msg.data()));
+
+        // m_deltaMutex is not held while publishing - esp-mqtt takes its lock to publish, and holds it while
+        // on_entry(STATE_CONNECTED) takes m_deltaMutex
+        std::optional<BaoJson> patch;
+        uint32_t generation;
+        uint32_t version = 0;
+        bool isSnapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_deltaMutex);
+            generation = m_deltaGeneration;
+
+            auto it = m_deltaTopics.find(topic);
+            isSnapshot = it == m_deltaTopics.end() || it->second.sinceSnapshot >= m_deltaSnapshotInterval;
+            if (it != m_deltaTopics.end())
+                version = it->second.version;
+
+            if (!isSnapshot)
+            {
+                patch = BaoJson::CreateMergePatch(it->second.lastPublished, msg);
+                if (!patch.has_value())
+                    return eResult::OUT_OF_MEMORY;
+
+                if (patch->IsEmpty())
+                    return eResult::SUCCESS;
+            }
+        }
+
+        // on failure the next delta is still computed against what subscribers last got
+        eResult result = isSnapshot ? Publish(topic, msg) : Publish(topic, patch.value());
+        if (result != eResult::SUCCESS)
+            return result;
+
+        BaoJson published = msg.Duplicate();
+
+        std::lock_guard<std::mutex> lock(m_deltaMutex);
+
+        // a reconnect in between starts over with snapshots anyway
+        if (generation != m_deltaGeneration)
+            return eResult::SUCCESS;
+
+        // another PublishDelta() on the topic got in between, subscribers may have applied the two in either order
+        auto it = m_deltaTopics.try_emplace(topic).first;
+        delta_topic_t &delta = it->second;
+        if (delta.version != version)
+        {
+            m_deltaTopics.erase(it);
+            return eResult::SUCCESS;
+        }
+
+        delta.lastPublished = std::move(published);
+        delta.sinceSnapshot = isSnapshot ? 0 : delta.sinceSnapshot + 1;
+        delta.version++;
+        return eResult::SUCCESS;
+    }
+
     eResult MqttClient::TryConnect(const MqttClient::Config &config)
     {
         if (IsInState<STATE_CONNECTED>())
@@ -101,6 +205,7 @@ namespace Baozi
         }
 
         m_onConnectCallback = config.onConnectCallback;
+        m_deltaSnapshotInterval = config.deltaSnapshotInterval;
         bool success = connect(config);
         if (!success)
         {
@@ -129,6 +234,13 @@ namespace Baozi
         BAO_LOG_INFO("entered %s", state.NAME);
         reSubscribeHandlers();
 
+        {
+            // subscribers may have missed deltas while we were away, start over with snapshots
+            std::lock_guard<std::mutex> lock(m_deltaMutex);
+            m_deltaTopics.clear();
+            m_deltaGeneration++;
+        }
+
         if (m_onConnectCallback)
             m_onConnectCallback();
     }
@@ -218,31 +330,103 @@ namespace Baozi
     return_state_t MqttClient::on_event(STATE_CONNECTED &state, EVENT_INCOMING_DATA &event)
     {
         BAO_LOG_DEBUG("%s got %s", state.NAME, event.NAME);
-        configASSERT(event.payload);
 
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string_view topic = event.Topic();
+        std::string_view raw = event.Payload();
 
-        bool found = false;
-        std::for_each(m_handlers.begin(), m_handlers.end(), [&event, &found](auto &handler)
-                      {
-        bool match = event.topic == handler.first ||
-            (handler.first.ends_with("#") && event.topic.starts_with(handler.first.substr(0, handler.first.size() - 1)));
-
-        if (!match)
-            return;
+        // handlers are called without m_mutex - they publish, which takes the esp-mqtt lock, while the esp-mqtt task
+        // holds that lock and takes m_mutex to subscribe or to drain inline. They may also call On()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &handler : m_handlers)
+            {
+                bool match = topic == handler.first ||
+                             (handler.first.ends_with("#") && topic.starts_with(std::string_view{handler.first}.substr(0, handler.first.size() - 1)));
+
+                if (match)
+                    m_matchedHandlers.push_back(handler.second.cb);
+            }
+        }
 
-        BAO_LOG_INFO("calling handler for topic %s", event.topic.c_str());
-        handler.second.cb(event.topic, event.payload);
-        found = true; });
+        // the payload is decoded lazily, once per encoding, for the first matching handler
+        std::optional<BaoJsonView> payload;
+        std::unique_ptr<BaoJsonToken[]> heapTokens; // tokens of a payload that does not fit m_payloadTokens
+        std::optional<std::optional<BaoMsgPackView>> msgpack;
+        for (auto &handler : m_matchedHandlers)
+        {
+            if (auto *cb = std::get_if<mqtt_msgpack_handler_callback>(handler.get()))
+            {
+                if (!msgpack.has_value())
+                    msgpack = BaoMsgPackView::Parse(raw);
+
+                if (!msgpack->has_value())
+                {
+                    BAO_LOG_WARNING("payload on %.*s is not msgpack, dropping it", (int)topic.size(), topic.data());
+                    continue;
+                }
+
+                BAO_LOG_INFO("calling msgpack handler for topic %.*s", (int)topic.size(), topic.data());
+                (*cb)(topic, msgpack->value());
+                continue;
+            }
+
+            if (!payload.has_value())
+                payload = event.message->json; // tokenized in the slot, unless it has more than its tokens
+
+            if (!payload.has_value())
+            {
+                payload = parsePayload(raw, heapTokens);
+                if (!payload.has_value())
+                {
+                    BAO_LOG_WARNING("payload on %.*s is not json", (int)topic.size(), topic.data());
+                    payload = BaoJsonView{raw};
+                }
+            }
+
+            BAO_LOG_INFO("calling handler for topic %.*s", (int)topic.size(), topic.data());
+            std::get<mqtt_handler_callback>(*handler)(topic, payload.value());
+        }
 
+        m_matchedHandlers.clear(); // keeps its capacity for the next message
         return std::nullopt;
     }
 
     //===============================================================================================
 
+    // tokenize into m_payloadTokens, and into heap tokens (doubled until they suffice) when the payload has more tokens
+    std::optional<BaoJsonView> MqttClient::parsePayload(std::string_view payload, std::unique_ptr<BaoJsonToken[]> &heapTokens)
+    {
+        BaoJsonParser parser{m_payloadTokens};
+        BaoJsonParser::eStatus status = parser.Parse(payload.data(), payload.size());
+
+        // every token starts at its own character, so the text length bounds the tokens needed
+        size_t maxTokens = MAX_PAYLOAD_TOKENS;
+        while (status == BaoJsonParser::eStatus::NO_MEMORY && maxTokens < payload.size())
+        {
+            maxTokens = std::min(maxTokens * 2, payload.size());
+            heapTokens = std::make_unique<BaoJsonToken[]>(maxTokens);
+
+            BAO_LOG_DEBUG("payload has more than %d tokens, tokenizing into %d heap tokens", (int)MAX_PAYLOAD_TOKENS, (int)maxTokens);
+            parser = BaoJsonParser{heapTokens.get(), maxTokens};
+            status = parser.Parse(payload.data(), payload.size());
+        }
+
+        if (status != BaoJsonParser::eStatus::COMPLETE)
+        {
+            return std::nullopt;
+        }
+
+        return parser.View(payload.data());
+    }
+
     eResult MqttClient::publish(const char *topic, const char *payload)
     {
-        int err = esp_mqtt_client_publish(m_client, topic, payload, strlen(payload), 0, false);
+        return publish(topic, payload, strlen(payload));
+    }
+
+    eResult MqttClient::publish(const char *topic, const char *payload, size_t length)
+    {
+        int err = esp_mqtt_client_publish(m_client, topic, payload, length, 0, false);
         if (err == -1)
         {
             BAO_LOG_ERROR("mqtt publish failed");
@@ -300,6 +484,15 @@ namespace Baozi
         return true;
     }
 
+    void MqttClient::subscribeHandler(const char *topic, mqtt_event_handler_t handler)
+    {
+        // esp-mqtt holds its lock while incoming data takes m_mutex, so subscribe (takes the esp-mqtt lock) before it
+        handler.isSubscribed = subscribe(topic);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_handlers.insert_or_assign(std::string{topic}, std::move(handler));
+    }
+
     bool MqttClient::subscribe(const char *topic)
     {
         if (not IsInState<STATE_CONNECTED>())
@@ -331,4 +524,11 @@ namespace Baozi
         return IsInState<STATE_CONNECTED>();
     }
 
+    size_t MqttClient::UnsubscribedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return std::count_if(m_handlers.begin(), m_handlers.end(), [](const auto &handler)
+                             { return !handler.second.isSubscribed; });
+    }
+
 } // namespace Baozi
@@ -7,7 +7,14 @@
 #include <map>
 #include <queue>
 #include <memory>
+#include <vector>
 #include "baozi_json.h"
+#include "baozi_json_writer.h"
+#include "baozi_json_print_pool.h"
+#include "baozi_json_view.h"
+#include "baozi_msgpack_writer.h"
+#include "baozi_msgpack_view.h"
+#include "baozi_mqtt_reassembly.h"
 #include "fsm_taskless.h"
 #include "baozi_result.h"
 #include "baozi_nvs.h"
@@ -15,7 +22,17 @@
 namespace Baozi
 {
 
-    using mqtt_handler_callback = std::function<void(const std::string &topic, const BaoJson &payload)>;
+    /*
+        handlers get a view over the payload tokens, valid only for the duration of the call.
+        a payload that is not json gets an empty view that still gives access to the text via payload.Raw()
+    */
+    using mqtt_handler_callback = std::function<void(std::string_view topic, const BaoJsonView &payload)>;
+
+    /*
+        handlers of binary topics (device to device, never read by Home Assistant) get a MessagePack view,
+        valid only for the duration of the call. payloads that are not valid MessagePack are dropped
+    */
+    using mqtt_msgpack_handler_callback = std::function<void(std::string_view topic, const BaoMsgPackView &payload)>;
 
     namespace MqttFSM
     {
@@ -74,8 +91,10 @@ namespace Baozi
         struct EVENT_INCOMING_DATA
         {
             static constexpr const char *NAME = "EVENT_INCOMING_DATA";
-            std::string topic;
-            BaoJson payload;
+            MqttHeldMessage message; // in its reassembler slot, released once the event is handled
+
+            std::string_view Topic() const { return message ? message->topic : std::string_view{}; }
+            std::string_view Payload() const { return message ? message->payload : std::string_view{}; }
         };
 
         using Events = std::variant<EVENT_BEFORE_CONNECT,
@@ -90,26 +109,43 @@ namespace Baozi
 
     } // namespace MqttFSM
 
-    class MqttClient : public FsmTaskless<MqttClient, MqttFSM::States, MqttFSM::Events>
+    // incoming messages are dispatched without waiting, the inbox absorbs bursts while another task drains it
+    class MqttClient : public FsmTaskless<MqttClient, MqttFSM::States, MqttFSM::Events, 16>
     {
     public:
+        static constexpr size_t MAX_PAYLOAD_TOKENS = 64; // larger payloads are tokenized into heap tokens
+
         struct Config
         {
-            const char *broker_ip;
-            const char *username;
-            const char *password;
-            const char *clientId; // leave empty to use mac address
+            const char *broker_ip{};
+            const char *username{};
+            const char *password{};
+            const char *clientId{}; // leave empty to use mac address
             int port = 1883;
-            std::pair<const char *, const char *> willTopicAndPayload;
-            std::function<void()> onConnectCallback;
+            std::pair<const char *, const char *> willTopicAndPayload{};
+            std::function<void()> onConnectCallback{};
+            uint32_t deltaSnapshotInterval = 10; // PublishDelta() sends the whole object every N messages
         };
 
         MqttClient();
         void On(const char *topic, mqtt_handler_callback callback);
+        void On(const char *topic, mqtt_msgpack_handler_callback callback);
         eResult Publish(const char *topic, const BaoJson &msg);
+        eResult Publish(const char *topic, const BaoJsonWriter &msg);
+        eResult Publish(const char *topic, const BaoMsgPackWriter &msg);
         eResult Publish(const char *topic, const char *msg);
+
+        /*
+            publishes only what changed since the last message on the topic, as an RFC 7386 merge patch,
+            and the whole object on the first message, every deltaSnapshotInterval messages and after a reconnect.
+            subscribers keep their copy up to date with BaoJson::ApplyMergePatch() on every message.
+            nothing is published if the object did not change
+        */
+        eResult PublishDelta(const char *topic, const BaoJson &msg);
         eResult TryConnect(const Config &config);
         bool IsConnected() const;
+        size_t UnsubscribedCount() const; // handlers not subscribed on the broker, 0 while connected unless a subscribe failed
+        BaoJsonPrintPool::Stats GetPrintStats() const { return m_printPool.GetStats(); }
 
         void on_entry(MqttFSM::STATE_DISABLED &);
         void on_entry(MqttFSM::STATE_CONNECTING &);
@@ -132,30 +168,51 @@ namespace Baozi
         return_state_t on_event(MqttFSM::STATE_CONNECTED &, MqttFSM::EVENT_INCOMING_DATA &);
 
         template <typename State, typename Event>
-        auto on_event(State &state, Event &event)
+        void on_unhandled(State &state, Event &event)
         {
             printf("unhandled event!: %s got %s\n", state.NAME, event.NAME);
-            return std::nullopt;
         }
 
     private:
+        using handler_cb_t = std::variant<mqtt_handler_callback, mqtt_msgpack_handler_callback>; // the topic's payload encoding
+
         struct mqtt_event_handler_t
         {
-            mqtt_handler_callback cb;
+            std::shared_ptr<const handler_cb_t> cb; // shared so incoming data can call it without holding m_mutex
             bool isSubscribed{};
         };
         using handlers_t = std::map<std::string, mqtt_event_handler_t>;
 
+        struct delta_topic_t
+        {
+            BaoJson lastPublished;
+            uint32_t sinceSnapshot{};
+            uint32_t version{}; // counts the messages published on the topic, 0 before the first
+        };
+
         esp_mqtt_client_handle_t m_client{};
         handlers_t m_handlers;
-        std::mutex m_mutex; // protects m_handlers... consider not using at all...
+        mutable std::mutex m_mutex; // protects m_handlers... consider not using at all...
         std::function<void()> m_onConnectCallback;
+        std::map<std::string, delta_topic_t> m_deltaTopics; // protected by m_deltaMutex
+        std::mutex m_deltaMutex;
+        uint32_t m_deltaGeneration{}; // counts reconnects, protected by m_deltaMutex
+        uint32_t m_deltaSnapshotInterval{10};
+        std::array<BaoJsonToken, MAX_PAYLOAD_TOKENS> m_payloadTokens; // only used by the task draining the inbox
+        std::vector<std::shared_ptr<const handler_cb_t>> m_matchedHandlers; // only used by the task draining the inbox
+        MqttReassembler m_reassembler; // fed from the esp-mqtt task, its messages are released by the task draining the inbox
+        BaoJsonPrintPool m_printPool;  // BaoJson payloads are printed into reusable buffers, sized per topic
 
         bool connect(const Config &config);
         bool subscribe(const char *topic);
         eResult publish(const char *topic, const char *payload);
+        eResult publish(const char *topic, const char *payload, size_t length);
+        void subscribeHandler(const char *topic, mqtt_event_handler_t handler);
         void reSubscribeHandlers();
 
+        void onData(const esp_mqtt_event_t &event);
+        std::optional<BaoJsonView> parsePayload(std::string_view payload, std::unique_ptr<BaoJsonToken[]> &heapTokens);
+
         static void mqttEventHandler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data);
     };
 
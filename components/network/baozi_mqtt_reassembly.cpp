@@ -0,0 +1,173 @@
+#include "baozi_mqtt_reassembly.h"
+#include "baozi_log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Baozi
+{
+
+    std::optional<MqttReassembler::message_t> MqttReassembler::Feed(const esp_mqtt_event_t &event)
+    {
+        size_t offset = static_cast<size_t>(event.current_data_offset);
+        size_t length = static_cast<size_t>(event.data_len);
+        size_t total = static_cast<size_t>(event.total_data_len);
+
+        slot_t *slot = nullptr;
+        if (offset == 0)
+        {
+            // only the first chunk carries the topic
+            if (total > MAX_PAYLOAD_SIZE || static_cast<size_t>(event.topic_len) > MAX_TOPIC_SIZE)
+            {
+                BAO_LOG_ERROR("dropping mqtt message of %u bytes, max is %u", (unsigned)total, (unsigned)MAX_PAYLOAD_SIZE);
+                m_stats.dropped++;
+                return std::nullopt;
+            }
+
+            slot = acquire();
+            if (slot == nullptr)
+            {
+                BAO_LOG_WARNING("every mqtt slot holds a message waiting to be handled, dropping msg_id %d", event.msg_id);
+                m_stats.dropped++;
+                return std::nullopt;
+            }
+
+            slot->inUse = true;
+            slot->msgId = event.msg_id;
+            slot->total = total;
+            slot->filled = 0;
+            slot->topicLength = event.topic_len;
+            memcpy(slot->topic.data(), event.topic, event.topic_len);
+            slot->parser->Reset();
+            slot->status = BaoJsonParser::eStatus::PARTIAL;
+        }
+        else
+        {
+            // chunks of a dropped message have no slot
+            slot = find(event.msg_id, offset);
+            if (slot == nullptr)
+                return std::nullopt;
+        }
+
+        if (offset + length > slot->total)
+        {
+            BAO_LOG_ERROR("mqtt chunk overflows its message, dropping it");
+            drop(*slot);
+            return std::nullopt;
+        }
+
+        memcpy(slot->buffer.get() + offset, event.data, length);
+        slot->filled += length;
+        slot->lastUsed = ++m_clock;
+        m_stats.peakInFlightBytes = std::max(m_stats.peakInFlightBytes, inFlightBytes());
+
+        bool isFinal = slot->filled == slot->total;
+        if (slot->status == BaoJsonParser::eStatus::PARTIAL || slot->status == BaoJsonParser::eStatus::COMPLETE)
+            slot->status = slot->parser->Parse(slot->buffer.get(), slot->filled, isFinal);
+
+        if (!isFinal)
+            return std::nullopt;
+
+        slot->inUse = false;
+        slot->isHeld.store(true, std::memory_order_relaxed);
+
+        message_t message{.topic = std::string_view{slot->topic.data(), slot->topicLength},
+                          .payload = std::string_view{slot->buffer.get(), slot->total},
+                          .json = std::nullopt,
+                          .tokens = nullptr,
+                          .tokenCount = 0,
+                          .slot = static_cast<size_t>(slot - m_slots.data())};
+
+        if (slot->status == BaoJsonParser::eStatus::COMPLETE)
+        {
+            message.json = slot->parser->View(slot->buffer.get());
+            message.tokens = slot->tokens.get();
+            message.tokenCount = slot->parser->TokenCount();
+        }
+
+        return message;
+    }
+
+    void MqttReassembler::Release(const message_t &message)
+    {
+        configASSERT(message.slot < SLOT_COUNT);
+        m_slots[message.slot].isHeld.store(false, std::memory_order_release); // after the handler's last read
+    }
+
+    void MqttReassembler::Reset()
+    {
+        for (auto &slot : m_slots)
+            slot.inUse = false;
+    }
+
+    //===============================================================================================
+
+    // a free slot, or the least recently fed one (a message that will never complete, e.g. after a reconnect),
+    // nullptr if every slot holds a complete message
+    MqttReassembler::slot_t *MqttReassembler::acquire()
+    {
+        slot_t *slot = nullptr;
+        for (auto &candidate : m_slots)
+        {
+            if (candidate.isHeld.load(std::memory_order_acquire))
+                continue;
+
+            if (!candidate.inUse)
+            {
+                slot = &candidate;
+                break;
+            }
+
+            if (slot == nullptr || candidate.lastUsed < slot->lastUsed)
+                slot = &candidate;
+        }
+
+        if (slot == nullptr)
+            return nullptr;
+
+        if (slot->inUse)
+        {
+            BAO_LOG_WARNING("no free mqtt reassembly slot, dropping msg_id %d", slot->msgId);
+            drop(*slot);
+        }
+
+        if (slot->buffer == nullptr)
+        {
+            slot->buffer = std::make_unique<char[]>(MAX_PAYLOAD_SIZE);
+            slot->tokens = std::make_unique<BaoJsonToken[]>(MAX_TOKENS);
+            slot->parser.emplace(slot->tokens.get(), MAX_TOKENS);
+            m_stats.allocatedBytes += MAX_PAYLOAD_SIZE + MAX_TOKENS * sizeof(BaoJsonToken);
+        }
+
+        return slot;
+    }
+
+    MqttReassembler::slot_t *MqttReassembler::find(int msgId, size_t offset)
+    {
+        for (auto &slot : m_slots)
+        {
+            if (slot.inUse && slot.msgId == msgId && slot.filled == offset)
+                return &slot;
+        }
+
+        return nullptr;
+    }
+
+    void MqttReassembler::drop(slot_t &slot)
+    {
+        slot.inUse = false;
+        m_stats.dropped++;
+    }
+
+    size_t MqttReassembler::inFlightBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto &slot : m_slots)
+        {
+            if (slot.inUse)
+                bytes += slot.filled;
+        }
+
+        return bytes;
+    }
+
+} // namespace Baozi
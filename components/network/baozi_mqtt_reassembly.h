@@ -0,0 +1,142 @@
+#ifndef BAOZI_MQTT_REASSEMBLY_H__
+#define BAOZI_MQTT_REASSEMBLY_H__
+
+#include "mqtt_client.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include "baozi_json_view.h"
+
+namespace Baozi
+{
+
+    /*
+        MqttReassembler puts messages that esp-mqtt delivers in several MQTT_EVENT_DATA chunks back together, and holds
+        messages delivered whole too, since esp-mqtt's buffer is only valid while its event handler runs.
+
+        Every message takes a slot from a small pool. A slot's payload buffer and tokens are allocated once,
+        capped at MAX_PAYLOAD_SIZE, and reused for every later message.
+        Chunks are copied straight into place and tokenized as they arrive (BaoJsonParser resumes where it stopped),
+        so a complete message is handed over with its json view ready, without another copy or parse.
+        A complete message keeps its slot until it is released, so it can wait in an inbox. When every slot is in use
+        the least recently fed in-flight message is dropped, a message arriving while every slot holds a complete one is.
+
+        NOTICE - Not thread safe, feed it from the mqtt event handler only. Release() may be called from any task
+        NOTICE - The returned message points into the slot, Release() it once handled
+    */
+    class MqttReassembler
+    {
+    public:
+        static constexpr size_t SLOT_COUNT = 4; // messages being fed or waiting to be handled
+        static constexpr size_t MAX_PAYLOAD_SIZE = 4096;
+        static constexpr size_t MAX_TOPIC_SIZE = 128;
+        static constexpr size_t MAX_TOKENS = 128;
+
+        struct message_t
+        {
+            std::string_view topic;
+            std::string_view payload;
+            std::optional<BaoJsonView> json; // std::nullopt if the payload is not json (or has too many tokens)
+            const BaoJsonToken *tokens;      // the tokens of json, nullptr if it is std::nullopt
+            size_t tokenCount;
+            size_t slot;
+        };
+
+        struct Stats
+        {
+            size_t allocatedBytes;    // buffers and tokens allocated by the pool
+            size_t peakInFlightBytes; // max payload bytes held at the same time
+            uint32_t dropped;         // messages that were too big, out of order, evicted or found no free slot
+        };
+
+        /**
+         * @brief feed a chunk of a fragmented message
+         *
+         * @param event - an MQTT_EVENT_DATA event where total_data_len > data_len
+         * @return std::optional<message_t> the complete message once its last chunk arrived, std::nullopt otherwise
+         */
+        std::optional<message_t> Feed(const esp_mqtt_event_t &event);
+
+        /**
+         * @brief return the slot of a complete message to the pool, from any task
+         */
+        void Release(const message_t &message);
+
+        /**
+         * @brief drop every in-flight message, e.g. on disconnect. Complete messages keep their slots until released
+         */
+        void Reset();
+
+        Stats GetStats() const { return m_stats; }
+
+    private:
+        struct slot_t
+        {
+            bool inUse{};                // being fed
+            std::atomic<bool> isHeld{}; // complete, until Release()
+            int msgId{};
+            uint32_t lastUsed{};
+            size_t total{};
+            size_t filled{};
+            std::array<char, MAX_TOPIC_SIZE> topic{};
+            size_t topicLength{};
+            std::unique_ptr<char[]> buffer;
+            std::unique_ptr<BaoJsonToken[]> tokens;
+            std::optional<BaoJsonParser> parser;
+            BaoJsonParser::eStatus status{};
+        };
+
+        std::array<slot_t, SLOT_COUNT> m_slots;
+        uint32_t m_clock{};
+        Stats m_stats{};
+
+        slot_t *acquire();
+        slot_t *find(int msgId, size_t offset);
+        void drop(slot_t &slot);
+        size_t inFlightBytes() const;
+    };
+
+    /*
+        MqttHeldMessage owns the slot of a complete message and releases it when destroyed, so the message can be moved
+        into an inbox and read by the task that drains it without being copied out of the slot
+    */
+    class MqttHeldMessage
+    {
+    public:
+        MqttHeldMessage() = default;
+        MqttHeldMessage(MqttReassembler &owner, const MqttReassembler::message_t &message) : m_owner(&owner), m_message(message) {}
+        MqttHeldMessage(MqttHeldMessage &&other) noexcept : m_owner(std::exchange(other.m_owner, nullptr)), m_message(other.m_message) {}
+        MqttHeldMessage &operator=(MqttHeldMessage &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                m_owner = std::exchange(other.m_owner, nullptr);
+                m_message = other.m_message;
+            }
+            return *this;
+        }
+        ~MqttHeldMessage() { release(); }
+
+        explicit operator bool() const { return m_owner != nullptr; }
+        const MqttReassembler::message_t &operator*() const { return m_message; }
+        const MqttReassembler::message_t *operator->() const { return &m_message; }
+
+    private:
+        MqttReassembler *m_owner{};
+        MqttReassembler::message_t m_message{};
+
+        void release()
+        {
+            if (m_owner != nullptr)
+                m_owner->Release(m_message);
+            m_owner = nullptr;
+        }
+    };
+
+} // namespace Baozi
+
+#endif
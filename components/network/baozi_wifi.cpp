@@ -60,7 +60,7 @@ namespace Baozi
         }
     }
 
-    Wifi::Wifi()
+    Wifi::Wifi(BaoTimerService &timers) : m_timers(timers)
     {
     }
 
@@ -175,23 +175,27 @@ namespace Baozi
     void Wifi::on_entry(STATE_Offline &)
     {
         BAO_LOG_INFO("wifi Offline\n");
+        stopConnectTimeout();
     }
 
     void Wifi::on_entry(STATE_AP &)
     {
         BAO_LOG_INFO("WIFI IS AP\n");
+        stopConnectTimeout();
     }
 
-    void Wifi::on_entry(STATE_Connecting &state)
+    void Wifi::on_entry(STATE_Connecting &)
     {
         BAO_LOG_INFO("WIFI IS TRYING TO CONNECT......\n");
         sta_start();
+        startConnectTimeout();
     }
 
     void Wifi::on_entry(STATE_Connected &)
     {
         BAO_LOG_INFO("WIFI CONNECTED\n");
         m_retry_count = 0;
+        stopConnectTimeout();
     }
 
     using return_state_t = std::optional<WifiFSM::States>;
@@ -204,7 +208,7 @@ namespace Baozi
         return STATE_AP{};
     }
 
-    return_state_t Wifi::on_event(STATE_Offline &, EVENT_StaConnect &event)
+    return_state_t Wifi::on_event(STATE_Offline &, EVENT_StaConnect &)
     {
         BAO_LOG_INFO("state offline got StaConnect event\n");
         return STATE_Connecting{};
@@ -223,7 +227,7 @@ namespace Baozi
         return STATE_Offline{};
     }
 
-    return_state_t Wifi::on_event(STATE_AP &, EVENT_StaConnect &event)
+    return_state_t Wifi::on_event(STATE_AP &, EVENT_StaConnect &)
     {
         BAO_LOG_INFO("state AP got StaConnect event\n");
         disconnect();
@@ -270,6 +274,29 @@ namespace Baozi
         return STATE_Connected{};
     }
 
+    return_state_t Wifi::on_event(STATE_Connecting &, EVENT_ConnectTimeout &event)
+    {
+        // the timer of an attempt that is over can still fire while it is being cancelled
+        if (event.attempt != m_connectAttempt)
+        {
+            BAO_LOG_DEBUG("ignoring the timeout of connect attempt %lu\n", (unsigned long)event.attempt);
+            return std::nullopt;
+        }
+
+        BAO_LOG_WARNING("state Connecting timed out after %lu ms\n", CONNECT_TIMEOUT.value());
+        m_retry_count++;
+
+        if (m_retry_count > MAX_RETRIES)
+        {
+            BAO_LOG_ERROR("WIFI RETRT COUNT EXCEEDED %d. RESETTING", MAX_RETRIES);
+            esp_restart();
+        }
+
+        sta_connect();
+        startConnectTimeout();
+        return std::nullopt;
+    }
+
     // ======================= Connected =======================
     return_state_t Wifi::on_event(STATE_Connected &, EVENT_LoseConnection &event)
     {
@@ -298,6 +325,20 @@ namespace Baozi
 
     // Private functions
 
+    void Wifi::startConnectTimeout()
+    {
+        m_timers.Cancel(m_connectTimeout);
+        m_connectAttempt++;
+        m_connectTimeout = m_timers.DispatchAfter(*this, CONNECT_TIMEOUT, EVENT_ConnectTimeout{.attempt = m_connectAttempt});
+    }
+
+    void Wifi::stopConnectTimeout()
+    {
+        m_timers.Cancel(m_connectTimeout);
+        m_connectAttempt++;
+        m_connectTimeout = BaoTimerWheel::INVALID_TIMER;
+    }
+
     bool Wifi::sta_start()
     {
         esp_err_t err = ESP_OK;
@@ -4,6 +4,7 @@
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "fsm_taskless.h"
+#include "baozi_timer_wheel.h"
 #include "esp_wifi.h"
 #include <variant>
 #include <string_view>
@@ -57,16 +58,21 @@ namespace Baozi
         struct EVENT_GotIP
         {
         };
-        using Events = std::variant<EVENT_APStart, EVENT_APStop, EVENT_Disconnect, EVENT_StaConnect, EVENT_StaStart, EVENT_StaConnected, EVENT_LoseConnection, EVENT_UserConnected, EVENT_GotIP>;
+        struct EVENT_ConnectTimeout
+        {
+            uint32_t attempt; // the connect attempt that timed out, stale once the attempt is over
+        };
+        using Events = std::variant<EVENT_APStart, EVENT_APStop, EVENT_Disconnect, EVENT_StaConnect, EVENT_StaStart, EVENT_StaConnected, EVENT_LoseConnection, EVENT_UserConnected, EVENT_GotIP, EVENT_ConnectTimeout>;
 
     } // namespace WifiFSM
 
     class Wifi : public FsmTaskless<Wifi, WifiFSM::States, WifiFSM::Events>
     {
+    public:
         static constexpr int MAX_RETRIES = 15;
+        static constexpr MilliSeconds CONNECT_TIMEOUT = 30000; // STATE_Connecting retries when no ip arrives in time
 
-    public:
-        Wifi();
+        explicit Wifi(BaoTimerService &timers = BaoTimerService::GetInstance());
         void Init();
         bool Connect(std::string_view ssid, std::string_view password);
         bool SwitchToAP();
@@ -94,16 +100,16 @@ namespace Baozi
         return_state_t on_event(WifiFSM::STATE_Connecting &, WifiFSM::EVENT_StaStart &);
         return_state_t on_event(WifiFSM::STATE_Connecting &, WifiFSM::EVENT_StaConnected &);
         return_state_t on_event(WifiFSM::STATE_Connecting &, WifiFSM::EVENT_GotIP &);
+        return_state_t on_event(WifiFSM::STATE_Connecting &, WifiFSM::EVENT_ConnectTimeout &);
         // Connected
         return_state_t on_event(WifiFSM::STATE_Connected &, WifiFSM::EVENT_LoseConnection &);
         return_state_t on_event(WifiFSM::STATE_Connected &, WifiFSM::EVENT_GotIP &);
         return_state_t on_event(WifiFSM::STATE_Connected &, WifiFSM::EVENT_Disconnect &);
         // Default
         template <typename State, typename Event>
-        return_state_t on_event(State &, Event &)
+        void on_unhandled(State &, Event &)
         {
             printf("default event on wifi event handler\n");
-            return std::nullopt;
         }
 
     private:
@@ -112,12 +118,17 @@ namespace Baozi
         bool sta_start();
         bool sta_connect();
         void init();
+        void startConnectTimeout();
+        void stopConnectTimeout();
 
         static constexpr char AP_SSID[] = "BAOZI_AP"; // TODO: make this configurable
 
         std::string m_ssid{};
         std::string m_password{};
         int m_retry_count = 0;
+        BaoTimerService &m_timers;
+        BaoTimerService::timer_id_t m_connectTimeout = BaoTimerWheel::INVALID_TIMER;
+        uint32_t m_connectAttempt = 0;
         esp_netif_t *ap_netif{};
         esp_netif_t *sta_netif{};
 
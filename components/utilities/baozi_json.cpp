@@ -1,4 +1,5 @@
 #include "baozi_json.h"
+#include <atomic>
 
 namespace Baozi {
 
@@ -11,7 +12,7 @@ BaoJson BaoJson::CreateArray() {
 }
 
 BaoJson BaoJson::Duplicate() const {
-    return BaoJson(cJSON_Duplicate(m_json.get(), true));
+    return Ref().Duplicate();
 }
 
 std::optional<BaoJson> BaoJson::CopyItem(const char *key) const {
@@ -30,7 +31,17 @@ std::optional<BaoJson> BaoJson::Parse(const char *jsonAsStr) {
     return std::nullopt;
 }
 
+std::optional<BaoJson> BaoJson::Parse(const char *json, size_t length) {
+    if (cJSON *parsed = cJSON_ParseWithLength(json, length); parsed != nullptr) {
+        auto rj = BaoJson{ parsed };
+        return std::optional<BaoJson>(std::move(rj));
+    }
+
+    return std::nullopt;
+}
+
 cJSON *BaoJson::data() {
+    invalidate();
     return m_json.get();
 }
 
@@ -38,12 +49,26 @@ const cJSON *BaoJson::data() const {
     return m_json.get();
 }
 
+BaoJsonRef BaoJson::Ref() {
+    invalidate();
+    return BaoJsonRef{ m_json.get() };
+}
+
+BaoJsonConstRef BaoJson::Ref() const {
+    return BaoJsonConstRef{ m_json.get() };
+}
+
+std::optional<BaoJsonRef> BaoJson::GetRef(const char *key) {
+    return Ref().GetRef(key);
+}
+
 BaoJson::json_ptr_t BaoJson::take() {
+    invalidate();
     return std::move(m_json);
 }
 
 std::unique_ptr<char, void (*)(void *)> BaoJson::PrintRaw() const {
-    return { cJSON_PrintUnformatted(m_json.get()), cJSON_free };
+    return Ref().PrintRaw();
 }
 
 BaoJson::operator bool() const {
@@ -55,34 +80,49 @@ bool BaoJson::IsEmpty() const {
 }
 
 void BaoJson::reset() {
+    invalidate();
     m_json.reset();
 }
 
+void BaoJson::BuildIndex() {
+    configASSERT(cJSON_IsObject(m_json.get()));
+    m_index = std::make_unique<BaoJsonIndex>(m_json.get());
+}
+
 bool BaoJson::HasItem(const char *key) const {
-    return cJSON_HasObjectItem(m_json.get(), key);
+    return findItem(key) != nullptr;
 }
 
 void BaoJson::AddValToArray(BaoJson &&val) {
-    configASSERT(cJSON_IsArray(m_json.get()));
-
-    configASSERT(cJSON_AddItemToArray(m_json.get(), val.take().release()) == true);
+    arrayRef().AddValToArray(std::move(val));
+    arrayResized(1);
 }
 
 std::optional<BaoJson> BaoJson::ArrayPopFront() {
-    configASSERT(cJSON_IsArray(data()));
-    cJSON *first = cJSON_DetachItemFromArray(data(), 0);
-    return first ? std::make_optional(BaoJson{ first }) : std::nullopt;
+    configASSERT(cJSON_IsArray(m_json.get()));
+    cJSON *first = m_json->child;
+    if (first == nullptr)
+        return std::nullopt;
+
+    arrayResized(-1);
+    return BaoJson{ cJSON_DetachItemViaPointer(m_json.get(), first) };
 }
 
 std::optional<BaoJson> BaoJson::ArrayPopBack() {
-    configASSERT(cJSON_IsArray(data()));
-    cJSON *last = cJSON_DetachItemFromArray(data(), cJSON_GetArraySize(data()) - 1);
-    return last ? std::make_optional(BaoJson{ last }) : std::nullopt;
+    configASSERT(cJSON_IsArray(m_json.get()));
+    cJSON *last = m_json->child != nullptr ? m_json->child->prev : nullptr;
+    if (last == nullptr)
+        return std::nullopt;
+
+    arrayResized(-1);
+    return BaoJson{ cJSON_DetachItemViaPointer(m_json.get(), last) };
 }
 
 int BaoJson::ArraySize() const {
-    configASSERT(cJSON_IsArray(data()));
-    return cJSON_GetArraySize(data());
+    if (m_arraySize < 0)
+        m_arraySize = Ref().ArraySize();
+
+    return m_arraySize;
 }
 
 bool BaoJson::IsArray() const {
@@ -92,9 +132,38 @@ bool BaoJson::IsArray() const {
 
 // =====================================================================
 
+const cJSON *BaoJson::findItem(const char *key) const {
+    if (m_index != nullptr)
+        return m_index->Find(key);
+
+    return cJSON_GetObjectItem(m_json.get(), key);
+}
+
+// the index and the array size describe the tree, drop them whenever the tree may change
+void BaoJson::invalidate() {
+    m_index.reset();
+    m_arraySize = -1;
+    m_generation = s_nextGeneration();
+}
+
+BaoJsonRef BaoJson::arrayRef() {
+    return BaoJsonRef{ m_json.get() };
+}
+
+void BaoJson::arrayResized(int delta) {
+    if (m_arraySize >= 0)
+        m_arraySize += delta;
+    m_generation = s_nextGeneration();
+}
+
 void BaoJson::s_jsonFree(void *json) {
     cJSON_Delete(static_cast<cJSON *>(json));
 }
 
+uint32_t BaoJson::s_nextGeneration() {
+    static std::atomic<uint32_t> s_generation{ 1 };
+    return s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
 
 }   // namespace Baozi
@@ -4,6 +4,9 @@
 #include <memory>
 #include "cJSON.h"
 #include "baozi_json_traits.h"
+#include "baozi_json_ref.h"
+#include "baozi_json_index.h"
+#include "baozi_result.h"
 #include "freertos/FreeRTOS.h"
 
 namespace Baozi {
@@ -29,6 +32,29 @@ class BaoJson
 
     static std::optional<BaoJson> Parse(const char *jsonAsStr);
 
+    // parse json text that is not NUL terminated, e.g. an mqtt payload (see BaoJsonView::Raw())
+    static std::optional<BaoJson> Parse(const char *json, size_t length);
+
+    /**
+     * @brief compute the RFC 7386 merge patch that turns 'from' into 'to'
+     * @brief NOTICE - keys are compared case sensitively, arrays and other non object values are replaced as a whole
+     * @brief NOTICE - a null value in 'to' means "remove the key", merge patches can not tell the two apart
+     *
+     * @example
+     *         // from {"a":1,"b":{"c":2,"d":3}} to {"a":1,"b":{"c":5},"e":[1]} gives {"b":{"d":null,"c":5},"e":[1]}
+     *         std::optional<BaoJson> patch = BaoJson::CreateMergePatch(lastPublished, current);
+     *
+     * @return std::optional<BaoJson> the patch, an empty object if nothing changed, std::nullopt if an allocation failed
+     */
+    static std::optional<BaoJson> CreateMergePatch(const BaoJson &from, const BaoJson &to);
+
+    /**
+     * @brief apply an RFC 7386 merge patch in place - patched keys keep their position, new keys are appended
+     *
+     * @return eResult SUCCESS, or OUT_OF_MEMORY if an allocation failed - the json is then only partly patched
+     */
+    eResult ApplyMergePatch(const BaoJson &patch);
+
     /*
         As the inner json is a unique pointer, copy constructor and assignment operator are deleted
         use ::Duplicate() instead if you need a copy
@@ -55,6 +81,21 @@ class BaoJson
     cJSON *data();
     const cJSON *data() const;
 
+    /**
+     * @brief return a borrowed reference to the inner cJSON, see BaoJsonRef / BaoJsonConstRef
+     * @brief NOTICE - the reference is valid as long as this BaoJson holds the same tree
+     */
+    BaoJsonRef Ref();
+    BaoJsonConstRef Ref() const;
+
+    /**
+     * @brief return a mutable reference to a nested object or array, nothing is copied or detached
+     *
+     * @param key - the key of the nested object or array
+     * @return std::optional<BaoJsonRef> the reference if the key exists and is an object or array, std::nullopt otherwise
+     */
+    std::optional<BaoJsonRef> GetRef(const char *key);
+
     /**
      * @brief take the inner cJSON, leaving theBaoJson object empty and invalid!!!
      * @brief NOTICE - Try to avoid this if possible
@@ -91,6 +132,22 @@ class BaoJson
      */
     void reset();
 
+    /**
+     * @brief build a hash index over the object's keys, so GetVal/HasItem lookups are O(1) instead of a linear walk
+     * @brief NOTICE - opt-in, pays off for objects with more than a dozen or so keys that are read many times
+     * @brief NOTICE - indexed lookups are case sensitive, not indexed ones are not (cJSON)
+     * @brief NOTICE - any non-const access (AddVal, Ref(), data(), GetRef...) drops the index, build it once the object is complete
+     */
+    void BuildIndex();
+
+    bool IsIndexed() const { return m_index != nullptr; }
+
+    /**
+     * @brief return a number that changes on every non-const access, unique across all BaoJson objects
+     * @brief NOTICE - tells cached lookups (see BaoJsonCachedPath) whether they still point into the same, unchanged tree
+     */
+    uint32_t Generation() const { return m_generation; }
+
     /**
      * @brief checks whether the json contains a property with the given key
      *
@@ -133,6 +190,16 @@ class BaoJson
     template <typename T>
     void AddVal(const char *key, T val);
 
+    /**
+     * @brief Adds a value with a key of static storage duration, the key is not copied nor freed by cJSON
+     * @brief NOTICE - see StaticKey in baozi_json_traits.h, KV{StaticKey, T} does the same in AddVals / the ctor
+     *
+     * @example
+     *         json.AddVal("state_topic"_key, state_topic());
+     */
+    template <typename T>
+    void AddVal(StaticKey key, T val);
+
     /**
      * @brief Adds values to the json object
      * @brief NOTICE - Every property must be a KV struct of a const char* key and a json serializable value
@@ -176,7 +243,11 @@ class BaoJson
      *           std::optional<const char*> = json.GetVal<const char*>("int"); // does not have value (wrong type)
      *           std::optional<int> = json.GetVal<int>("not_exists"); // does not have value (key does not exist)
      *           std::optional<Minute> = json.GetVal<Minute>("unit"); // has value, numbers would also work
-     *           std::optional<BaoJson> = json.GetVal<Minute>("other json"); // has value
+     *           std::optional<BaoJsonConstRef> = json.GetVal<BaoJsonConstRef>("other json"); // has value, borrowed
+     *           std::optional<BaoJson> = json.GetVal<BaoJson>("other json"); // has value, a deep copy
+     *
+     * @brief NOTICE - GetVal<BaoJson> deep copies the nested item and leaves this json untouched,
+     *                 use GetVal<BaoJsonConstRef> (or GetRef to modify it in place) to avoid the copy
      */
     template <typename T>
     std::optional<T> GetVal(const char *key) const;
@@ -251,6 +322,19 @@ class BaoJson
                                                          void>>
     void AddValsToArray(InputIt begin, InputIt end);
 
+    /**
+     * @brief Appends many numbers to the json array at once
+     * @brief NOTICE - the new nodes are linked to each other and attached to the tail in a single step,
+     *                 inside a BaoJsonArena they are also allocated back to back
+     *
+     * @param values - the numbers to append
+     * @example
+     *        float samples[100];
+     *        json.AppendNumbers(std::span<const float>{samples});
+     */
+    template <typename T>
+    void AppendNumbers(std::span<const T> values);
+
     /**
      * @brief Performs a function for each item in array of type T
      *
@@ -263,13 +347,16 @@ class BaoJson
      *      array.AddValsToArray(1, 2, 3, "hooray", BaoJson{});
      *      array.ArrayForEach<int>([](int i) { std::cout << i << std::endl; }); //prints 1, 2, 3
      *      array.ArrayForEach<const char *>([](const char *str) { std::cout << str << std::endl; }); //prints hooray
-     *      array.ArrayForEach<BaoJson>([](BaoJson json) { std::cout << json << std::endl; }); //prints { }
+     *      array.ArrayForEach<BaoJsonConstRef>([](BaoJsonConstRef json) { std::cout << json << std::endl; }); //prints { }
+     *
+     * @brief NOTICE - objects are passed as a borrowed BaoJsonConstRef, also for T = BaoJson
      */
     template <typename T, typename F>
     void ArrayForEach(F &&func) const;
 
     /**
      * @brief Pop a value from the front/back of the array
+     * @brief NOTICE - both are O(1), cJSON keeps the array's tail in child->prev
      *
      * @return std::optional<T> the json if array is not empty, std::nullopt otherwise
      * @example
@@ -283,6 +370,7 @@ class BaoJson
 
     /**
      * @brief Get size of array if an array
+     * @brief NOTICE - counted once and then kept up to date by the array functions, so O(1) after the first call
      *
      * @return size of array
      */
@@ -293,12 +381,24 @@ class BaoJson
     private:
 
     json_ptr_t m_json;
+    std::unique_ptr<BaoJsonIndex> m_index;
+    mutable int m_arraySize{ -1 }; // -1 until counted
+    uint32_t m_generation{ s_nextGeneration() };
+
+    const cJSON *findItem(const char *key) const;
+    void invalidate();
+
+    // array functions keep the cached size, unlike Ref() which drops it
+    BaoJsonRef arrayRef();
+    void arrayResized(int delta);
 
     static void s_jsonFree(void *json);
+    static uint32_t s_nextGeneration();
 };
 
 }   // namespace Baozi
 
 #include "baozi_json_inl.hpp"
+#include "baozi_json_ref_inl.hpp"
 
 #endif   // UTIL_CJSON_H__
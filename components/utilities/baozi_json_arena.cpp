@@ -0,0 +1,73 @@
+#include "baozi_json_arena.h"
+
+namespace Baozi {
+
+static constexpr size_t ARENA_ALIGNMENT = alignof(std::max_align_t);
+
+BaoJsonArena::BaoJsonArena(uint8_t *buffer, size_t size) : m_buffer(buffer),
+                                                          m_size(size),
+                                                          m_handler{ .allocate = s_allocate, .release = s_release, .context = this },
+                                                          m_scope(m_handler) {
+    configASSERT(m_buffer != nullptr);
+}
+
+BaoJsonArena::~BaoJsonArena() = default;
+
+void BaoJsonArena::Reset() {
+    m_used = 0;
+    m_last = 0;
+}
+
+BaoJsonArena::Stats BaoJsonArena::GetStats() {
+    return s_stats;
+}
+
+void BaoJsonArena::ResetStats() {
+    s_stats = {};
+}
+
+// =====================================================================
+
+void *BaoJsonArena::allocate(size_t size) {
+    size_t start = (reinterpret_cast<uintptr_t>(m_buffer) + m_used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    start -= reinterpret_cast<uintptr_t>(m_buffer);
+
+    if (start + size > m_size) {
+        s_stats.overflows++;
+        return nullptr;
+    }
+
+    m_last = start;
+    m_used = start + size;
+    if (m_used > s_stats.highWaterMark)
+        s_stats.highWaterMark = m_used;
+
+    return m_buffer + start;
+}
+
+// frees are no-ops, only the last allocation can be given back
+void BaoJsonArena::release(void *ptr) {
+    if (static_cast<uint8_t *>(ptr) == m_buffer + m_last)
+        m_used = m_last;
+}
+
+bool BaoJsonArena::owns(const void *ptr) const {
+    const uint8_t *p = static_cast<const uint8_t *>(ptr);
+    return p >= m_buffer && p < m_buffer + m_size;
+}
+
+// the stats are only touched by the task holding the hooks scope
+void *BaoJsonArena::s_allocate(void *context, size_t size) {
+    return static_cast<BaoJsonArena *>(context)->allocate(size);
+}
+
+bool BaoJsonArena::s_release(void *context, void *ptr) {
+    BaoJsonArena *arena = static_cast<BaoJsonArena *>(context);
+    if (!arena->owns(ptr))
+        return false;
+
+    arena->release(ptr);
+    return true;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,85 @@
+#ifndef UTIL_BAOZI_JSON_ARENA_H__
+#define UTIL_BAOZI_JSON_ARENA_H__
+
+#include <cstddef>
+#include <cstdint>
+#include "baozi_json_hooks.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonArena routes every cJSON allocation made by the creating task into a bump allocator over a
+    caller supplied (static or stack) buffer, for as long as the arena is alive.
+    Frees are no-ops (except for the last allocation which is rolled back), and everything is released at once
+    when the arena is reset or destroyed. When the buffer runs out, allocations fall back to the heap.
+    Allocations made by other tasks while the arena is alive always go to the heap.
+
+    NOTICE - Only one arena is active at a time, creating an arena waits until the arena of another task is destroyed.
+             Arenas do not nest on the same task
+    NOTICE - Every BaoJson / printed string created in the arena scope must be destroyed before the arena is,
+             declare the arena first so it is destroyed last
+
+    example:
+        static uint8_t buffer[1024];
+
+        BaoJsonArena arena{buffer};
+        BaoJson json{KV{"name", "baozi"}, KV{"state_topic", "baozi/state"}};
+        mqtt.Publish("baozi/config", json); // node, key, string and print allocations all come from buffer
+*/
+class BaoJsonArena
+{
+    public:
+    struct Stats
+    {
+        size_t highWaterMark;   // max bytes ever used by an arena
+        uint32_t overflows;     // allocations that did not fit and went to the heap
+    };
+
+    BaoJsonArena(uint8_t *buffer, size_t size);
+
+    template <size_t N>
+    explicit BaoJsonArena(uint8_t (&buffer)[N]) : BaoJsonArena(buffer, N) {}
+
+    ~BaoJsonArena();
+
+    BaoJsonArena(const BaoJsonArena &rhs) = delete;
+    BaoJsonArena &operator=(const BaoJsonArena &rhs) = delete;
+
+    /**
+     * @brief release everything allocated in the arena so far
+     * @brief NOTICE - no json allocated in this arena may be alive when calling this
+     */
+    void Reset();
+
+    /**
+     * @brief return the number of bytes currently used in the arena
+     */
+    size_t Used() const { return m_used; }
+
+    /**
+     * @brief return the high water mark and overflow counters of all arenas
+     */
+    static Stats GetStats();
+    static void ResetStats();
+
+    private:
+    uint8_t *m_buffer;
+    size_t m_size;
+    size_t m_used{};
+    size_t m_last{};
+    BaoJsonHooks::Handler m_handler;
+    BaoJsonHooks::Scope m_scope;   // last, the arena is set up before its first allocation
+
+    void *allocate(size_t size);
+    void release(void *ptr);
+    bool owns(const void *ptr) const;
+
+    static void *s_allocate(void *context, size_t size);
+    static bool s_release(void *context, void *ptr);
+
+    static inline Stats s_stats{};
+};
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_ARENA_H__
@@ -0,0 +1,95 @@
+#include "baozi_json_bench.h"
+#include <cstdlib>
+
+namespace Baozi {
+
+static size_t slotOf(const void *ptr) {
+    // allocations are at least 4 byte aligned, drop the low bits before mixing
+    uintptr_t bits = reinterpret_cast<uintptr_t>(ptr) >> 2;
+    return (bits * 2654435761u) & (BaoJsonBench::MAX_TRACKED - 1);
+}
+
+BaoJson BaoJsonBench::Report() const {
+    BaoJson results = BaoJson::CreateArray();
+    for (const auto &result : m_results)
+        results.AddValToArray(result.ToJson());
+
+    BaoJson report;
+    report.AddVal("results", std::move(results));
+    return report;
+}
+
+// =====================================================================
+
+void BaoJsonBench::beginCounting() {
+    static_assert((MAX_TRACKED & (MAX_TRACKED - 1)) == 0, "MAX_TRACKED must be a power of 2");
+
+    if (m_live == nullptr)
+        m_live = std::make_unique<allocation_t[]>(MAX_TRACKED);
+
+    for (size_t i = 0; i < MAX_TRACKED; i++)
+        m_live[i] = {};
+
+    m_allocations = 0;
+    m_liveBytes = 0;
+    m_peakBytes = 0;
+}
+
+// an allocation that does not fit in a full table is simply not tracked
+void BaoJsonBench::track(void *ptr, size_t size) {
+    for (size_t i = 0, slot = slotOf(ptr); i < MAX_TRACKED; i++, slot = (slot + 1) & (MAX_TRACKED - 1)) {
+        if (m_live[slot].ptr == nullptr) {
+            m_live[slot] = { ptr, size };
+            m_liveBytes += size;
+            if (m_liveBytes > m_peakBytes)
+                m_peakBytes = m_liveBytes;
+            return;
+        }
+    }
+}
+
+// frees of allocations made before counting started are not found and ignored
+void BaoJsonBench::untrack(void *ptr) {
+    size_t slot = slotOf(ptr);
+    size_t probes = 0;
+    while (m_live[slot].ptr != ptr) {
+        if (m_live[slot].ptr == nullptr || ++probes == MAX_TRACKED)
+            return;
+        slot = (slot + 1) & (MAX_TRACKED - 1);
+    }
+
+    m_liveBytes -= m_live[slot].size;
+    m_live[slot] = {};
+
+    // backward shift deletion, so lookups can keep stopping at the first empty slot
+    for (size_t next = (slot + 1) & (MAX_TRACKED - 1); m_live[next].ptr != nullptr; next = (next + 1) & (MAX_TRACKED - 1)) {
+        size_t home = slotOf(m_live[next].ptr);
+        bool canMove = ((next - home) & (MAX_TRACKED - 1)) >= ((next - slot) & (MAX_TRACKED - 1));
+        if (canMove) {
+            m_live[slot] = m_live[next];
+            m_live[next] = {};
+            slot = next;
+        }
+    }
+}
+
+void *BaoJsonBench::s_allocate(void *context, size_t size) {
+    void *ptr = malloc(size);
+    if (ptr != nullptr) {
+        BaoJsonBench *bench = static_cast<BaoJsonBench *>(context);
+        bench->m_allocations++;
+        bench->track(ptr, size);
+    }
+
+    return ptr;
+}
+
+// counted allocations came from the heap, they go back to it
+bool BaoJsonBench::s_release(void *context, void *ptr) {
+    if (ptr != nullptr)
+        static_cast<BaoJsonBench *>(context)->untrack(ptr);
+
+    return false;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,99 @@
+#ifndef UTIL_BAOZI_JSON_BENCH_H__
+#define UTIL_BAOZI_JSON_BENCH_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_fields.h"
+#include "baozi_json_hooks.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonBench measures json operations - time per op, cJSON allocations per op and the peak of cJSON heap
+    alive at once - and reports the results as json, so runs of different commits can be compared.
+    It runs on the device or on the IDF linux target, wherever esp_timer and cJSON are available.
+
+    Every Run() calls the op once to warm up (lazy buffers, pools), then times a loop of iterations,
+    then runs the loop again with cJSON allocation hooks installed to count allocations.
+
+    NOTICE - Only cJSON allocations are counted (nodes, keys, strings, prints), not std containers
+    NOTICE - Counts through BaoJsonHooks like BaoJsonArena allocates, the counted loop waits for arenas of other tasks
+             and must not create an arena itself
+    NOTICE - peakHeapBytes is a lower bound if more than MAX_TRACKED allocations are alive at once
+
+    example:
+        BaoJsonBench bench;
+        bench.Run("state_build_print", 1000, [] {
+            BaoJson json{KV{"temperature", 21.5}, KV{"humidity", 40}};
+            auto printed = json.PrintRaw();
+        });
+        printf("%s\n", bench.Report().PrintRaw().get()); // {"results":[{"name":"state_build_print","iterations":1000,...}]}
+*/
+class BaoJsonBench
+{
+    public:
+    static constexpr size_t MAX_TRACKED = 512;
+
+    struct Result
+    {
+        std::string name;
+        uint32_t iterations;
+        uint32_t nsPerOp;
+        float allocsPerOp;
+        uint32_t peakHeapBytes;
+
+        BAOZI_JSON_FIELDS(Result, name, iterations, nsPerOp, allocsPerOp, peakHeapBytes)
+    };
+
+    BaoJsonBench() = default;
+    BaoJsonBench(const BaoJsonBench &rhs) = delete;
+    BaoJsonBench &operator=(const BaoJsonBench &rhs) = delete;
+
+    /**
+     * @brief measure an operation and keep its result for the report
+     *
+     * @param name - name of the measured operation, e.g. "ha_discovery_print"
+     * @param iterations - number of times op is called in each loop
+     * @param op - the operation, a callable with no arguments. It should leave no json allocated behind
+     * @return the result, valid until the next Run()
+     */
+    template <typename F>
+    const Result &Run(const char *name, uint32_t iterations, F &&op);
+
+    /**
+     * @brief return the results of every Run() so far, as {"results":[{...}, ...]}
+     */
+    BaoJson Report() const;
+
+    const std::vector<Result> &Results() const { return m_results; }
+
+    private:
+    struct allocation_t
+    {
+        void *ptr;
+        size_t size;
+    };
+
+    std::vector<Result> m_results;
+    std::unique_ptr<allocation_t[]> m_live;   // open addressing table of the allocations alive in the counted loop
+    uint32_t m_allocations{};
+    size_t m_liveBytes{};
+    size_t m_peakBytes{};
+
+    void beginCounting();
+    void track(void *ptr, size_t size);
+    void untrack(void *ptr);
+
+    static void *s_allocate(void *context, size_t size);
+    static bool s_release(void *context, void *ptr);
+};
+
+}   // namespace Baozi
+
+#include "baozi_json_bench_inl.hpp"
+
+#endif   // UTIL_BAOZI_JSON_BENCH_H__
@@ -0,0 +1,40 @@
+#ifndef UTIL_BAOZI_JSON_BENCH_INL_H__
+#define UTIL_BAOZI_JSON_BENCH_INL_H__
+
+#include "esp_timer.h"
+
+namespace Baozi {
+
+template <typename F>
+const BaoJsonBench::Result &BaoJsonBench::Run(const char *name, uint32_t iterations, F &&op) {
+    configASSERT(name != nullptr);
+    configASSERT(iterations > 0);
+
+    op();
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++)
+        op();
+    int64_t elapsedUs = esp_timer_get_time() - start;
+
+    // counted separately, so the hooks do not add to the timing
+    beginCounting();
+    {
+        BaoJsonHooks::Handler handler{ .allocate = s_allocate, .release = s_release, .context = this };
+        BaoJsonHooks::Scope scope{ handler };
+        for (uint32_t i = 0; i < iterations; i++)
+            op();
+    }
+
+    Result result{ .name = name,
+                   .iterations = iterations,
+                   .nsPerOp = static_cast<uint32_t>(elapsedUs * 1000 / iterations),
+                   .allocsPerOp = static_cast<float>(m_allocations) / iterations,
+                   .peakHeapBytes = static_cast<uint32_t>(m_peakBytes) };
+
+    return m_results.emplace_back(std::move(result));
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_BENCH_INL_H__
@@ -0,0 +1,194 @@
+#ifndef UTIL_BAOZI_JSON_FIELDS_H__
+#define UTIL_BAOZI_JSON_FIELDS_H__
+
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include "baozi_json.h"
+#include "baozi_json_view.h"
+#include "baozi_json_writer.h"
+#include "baozi_result.h"
+
+/*
+    BAOZI_JSON_FIELDS declares the json fields of a struct, inside the struct, and generates:
+        - static constexpr auto JsonFields()          - a tuple of BaoJsonField {key, member pointer}, the key is the field name
+        - BaoJson ToJson() const                       - so the struct is json serializable everywhere (BaoJson, KV{}...)
+        - static BaoResult<Type> FromJson(BaoJsonView) - single pass decoder, see BaoJsonDecode
+
+    BaoJsonWriter writes such structs straight into its buffer (AddFields / as a nested value), without building a tree.
+    Fields can be of any type BaoJsonView can read, std::optional of it, or another BAOZI_JSON_FIELDS struct.
+
+    example:
+        struct LightCommand
+        {
+            bool state;
+            int brightness;
+            std::optional<std::string> effect;
+
+            BAOZI_JSON_FIELDS(LightCommand, state, brightness, effect)
+        };
+
+        auto command = LightCommand::FromJson(payload); // NOT_FOUND if state or brightness are missing
+        if (command)
+            apply(command.value());
+
+        char buffer[64];
+        BaoJsonWriter json{buffer};
+        json.AddFields(LightCommand{true, 80}); // {"state":true,"brightness":80,"effect":null}
+*/
+
+#define BAOZI_JSON_FIELD(Type, field) ::Baozi::BaoJsonField<Type, decltype(Type::field)>{ #field, &Type::field }
+
+#define BAOZI_JSON_FIELDS(Type, ...)                                                                   \
+    static constexpr auto JsonFields() { return std::make_tuple(BAOZI_FOR_EACH(BAOZI_JSON_FIELD, Type, __VA_ARGS__)); } \
+    ::Baozi::BaoJson ToJson() const { return ::Baozi::BaoJsonEncode(*this); }                         \
+    static ::Baozi::BaoResult<Type> FromJson(const ::Baozi::BaoJsonView &json) { return ::Baozi::BaoJsonDecode<Type>(json); }
+
+// BAOZI_FOR_EACH(macro, arg, a, b, c) expands to macro(arg, a), macro(arg, b), macro(arg, c)
+#define BAOZI_PARENS ()
+#define BAOZI_EXPAND(...) BAOZI_EXPAND4(BAOZI_EXPAND4(BAOZI_EXPAND4(BAOZI_EXPAND4(__VA_ARGS__))))
+#define BAOZI_EXPAND4(...) BAOZI_EXPAND3(BAOZI_EXPAND3(BAOZI_EXPAND3(BAOZI_EXPAND3(__VA_ARGS__))))
+#define BAOZI_EXPAND3(...) BAOZI_EXPAND2(BAOZI_EXPAND2(BAOZI_EXPAND2(BAOZI_EXPAND2(__VA_ARGS__))))
+#define BAOZI_EXPAND2(...) BAOZI_EXPAND1(BAOZI_EXPAND1(BAOZI_EXPAND1(BAOZI_EXPAND1(__VA_ARGS__))))
+#define BAOZI_EXPAND1(...) __VA_ARGS__
+
+#define BAOZI_FOR_EACH(macro, arg, ...) __VA_OPT__(BAOZI_EXPAND(BAOZI_FOR_EACH_HELPER(macro, arg, __VA_ARGS__)))
+#define BAOZI_FOR_EACH_HELPER(macro, arg, first, ...) \
+    macro(arg, first) __VA_OPT__(, BAOZI_FOR_EACH_AGAIN BAOZI_PARENS(macro, arg, __VA_ARGS__))
+#define BAOZI_FOR_EACH_AGAIN() BAOZI_FOR_EACH_HELPER
+
+namespace Baozi {
+
+template <typename S, typename M>
+struct BaoJsonField
+{
+    using member_t = M;
+
+    const char *key;
+    M S::*member;
+};
+
+/**
+ * @brief build a BaoJson from a BAOZI_JSON_FIELDS struct
+ * @brief NOTICE - prefer BaoJsonWriter::AddFields when the json is only printed, it does not allocate
+ */
+template <typename T>
+BaoJson BaoJsonEncode(const T &val) {
+    static_assert(hasJsonFields_v<T>, "type does not declare BAOZI_JSON_FIELDS");
+
+    BaoJson json;
+    std::apply([&](const auto &...fields) { (json.AddVal(fields.key, val.*fields.member), ...); }, T::JsonFields());
+    return json;
+}
+
+template <typename T>
+BaoResult<T> BaoJsonDecode(const BaoJsonView &json);
+
+namespace detail {
+
+    template <typename T>
+    struct is_optional : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_optional<std::optional<T>> : std::true_type
+    {
+    };
+
+    // returns false if the value is not of the member's type
+    template <typename M>
+    bool decodeJsonValue(const BaoJsonView &value, M &out) {
+        if constexpr (is_optional<M>::value) {
+            if (value.IsNull()) {
+                out.reset();
+                return true;
+            }
+
+            typename M::value_type inner{};
+            if (!decodeJsonValue(value, inner))
+                return false;
+
+            out = std::move(inner);
+            return true;
+        } else if constexpr (hasJsonFields_v<M>) {
+            auto decoded = BaoJsonDecode<M>(value);
+            if (!decoded)
+                return false;
+
+            out = std::move(decoded.value());
+            return true;
+        } else {
+            auto decoded = value.GetVal<M>();
+            if (!decoded.has_value())
+                return false;
+
+            out = std::move(decoded.value());
+            return true;
+        }
+    }
+
+    // decodes the value into the field named key, if there is one
+    template <typename T, typename Fields, size_t... Is>
+    void decodeJsonMember(const Fields &fields, std::string_view key, const BaoJsonView &value, T &out, uint32_t &found, bool &valid,
+                          std::index_sequence<Is...>) {
+        auto decodeField = [&](const auto &field, uint32_t bit) {
+            if (key != field.key)
+                return false;
+
+            valid = decodeJsonValue(value, out.*field.member) && valid;
+            found |= bit;
+            return true;
+        };
+
+        (decodeField(std::get<Is>(fields), 1u << Is) || ...);
+    }
+
+    template <typename Fields, size_t... Is>
+    constexpr uint32_t requiredJsonFields(const Fields &, std::index_sequence<Is...>) {
+        return ((is_optional<typename std::tuple_element_t<Is, Fields>::member_t>::value ? 0u : (1u << Is)) | ... | 0u);
+    }
+
+}   // namespace detail
+
+/**
+ * @brief decode a BAOZI_JSON_FIELDS struct from a json view, in a single pass over the object's tokens
+ * @brief NOTICE - unknown keys are skipped, std::optional fields may be missing or null
+ *
+ * @return BaoResult<T> the struct, NOT_FOUND if a required key is missing,
+ *                      INVALID_PARAMETER if the json is not an object or a value has the wrong type
+ */
+template <typename T>
+BaoResult<T> BaoJsonDecode(const BaoJsonView &json) {
+    static_assert(hasJsonFields_v<T>, "type does not declare BAOZI_JSON_FIELDS");
+
+    constexpr auto fields = T::JsonFields();
+    constexpr size_t count = std::tuple_size_v<decltype(fields)>;
+    static_assert(count <= 32, "too many json fields");
+
+    using indices_t = std::make_index_sequence<count>;
+    constexpr uint32_t required = detail::requiredJsonFields(fields, indices_t{});
+
+    if (!json.IsObject())
+        return BaoResult<T>::Error(eResult::INVALID_PARAMETER);
+
+    T out{};
+    uint32_t found = 0;
+    bool valid = true;
+    json.ObjectForEach([&](std::string_view key, const BaoJsonView &value) {
+        detail::decodeJsonMember(fields, key, value, out, found, valid, indices_t{});
+    });
+
+    if (!valid)
+        return BaoResult<T>::Error(eResult::INVALID_PARAMETER);
+
+    if ((found & required) != required)
+        return BaoResult<T>::Error(eResult::NOT_FOUND);
+
+    return BaoResult<T>::Ok(std::move(out));
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_FIELDS_H__
@@ -0,0 +1,226 @@
+#include "baozi_json_format.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Baozi {
+
+/*
+    The shortest round trip search works on decimals of the form digits * 10^exponent.
+    For every digit count, starting from one, the value is scaled to an integer and converted back.
+    As long as digits < 2^53 and |exponent| <= 22 both digits and 10^exponent are exact doubles, so the conversion back
+    is a single correctly rounded operation (Clinger's fast path), and the round trip check is exact.
+    Values outside of that range (very large, very small or needing 16-17 digits) continue the search with snprintf.
+*/
+
+static constexpr double MAX_EXACT_INTEGER = 9007199254740992.0;   // 2^53
+static constexpr int MAX_EXACT_POW10 = 22;
+static constexpr int MAX_FIXED_DECIMALS = 9;
+
+static constexpr double POW10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+struct decimal_t
+{
+    uint64_t digits;
+    int exponent;
+};
+
+static bool decimalToDouble(decimal_t decimal, double &out) {
+    if (decimal.digits > MAX_EXACT_INTEGER || decimal.exponent > MAX_EXACT_POW10 || decimal.exponent < -MAX_EXACT_POW10)
+        return false;
+
+    if (decimal.exponent >= 0)
+        out = static_cast<double>(decimal.digits) * POW10[decimal.exponent];
+    else
+        out = static_cast<double>(decimal.digits) / POW10[-decimal.exponent];
+
+    return true;
+}
+
+// the decimal reads back to val if it falls strictly between the midpoints to val's neighbours
+static bool roundTrips(float val, double decimal) {
+    double lower = (static_cast<double>(val) + std::nextafter(val, 0.0f)) / 2;
+    double upper = (static_cast<double>(val) + std::nextafter(val, std::numeric_limits<float>::infinity())) / 2;
+    return lower < decimal && decimal < upper;
+}
+
+static bool roundTrips(double val, double decimal) {
+    return val == decimal;
+}
+
+// val must be finite and positive. Returns 0 when out holds the shortest decimal, otherwise the first digit count
+// that is outside of the fast path - every shorter one was checked and does not round trip
+template <typename F>
+static int shortestDecimal(F val, decimal_t &out) {
+    static constexpr int MAX_DIGITS = std::is_same_v<F, float> ? 9 : 15;
+
+    int exp10 = static_cast<int>(std::floor(std::log10(static_cast<double>(val))));
+    for (int precision = 1; precision <= MAX_DIGITS; precision++) {
+        int scale = precision - 1 - exp10;
+        if (scale > MAX_EXACT_POW10 || scale < -MAX_EXACT_POW10)
+            return precision;
+
+        double scaled = scale >= 0 ? val * POW10[scale] : val / POW10[-scale];
+        decimal_t candidate{ static_cast<uint64_t>(std::llround(scaled)), -scale };
+
+        double back{};
+        if (!decimalToDouble(candidate, back))
+            return precision;
+
+        if (roundTrips(val, back)) {
+            while (candidate.digits != 0 && candidate.digits % 10 == 0) {
+                candidate.digits /= 10;
+                candidate.exponent++;
+            }
+
+            out = candidate;
+            return 0;
+        }
+    }
+
+    return MAX_DIGITS + 1;
+}
+
+// writes the decimal like %g does - positional for exponents in [-4, 15), scientific otherwise
+static size_t formatDecimal(decimal_t decimal, bool negative, char *out) {
+    char digits[20];
+    size_t count = std::to_chars(digits, digits + sizeof(digits), decimal.digits).ptr - digits;
+    int pointPosition = static_cast<int>(count) + decimal.exponent;   // digits before the decimal point
+    char *p = out;
+
+    if (negative)
+        *p++ = '-';
+
+    if (pointPosition > 15 || pointPosition < -3) {
+        *p++ = digits[0];
+        if (count > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, count - 1);
+            p += count - 1;
+        }
+
+        int exponent = pointPosition - 1;
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        if (exponent < 0)
+            exponent = -exponent;
+        if (exponent < 10)
+            *p++ = '0';
+        p = std::to_chars(p, out + JSON_NUMBER_BUFFER_SIZE, exponent).ptr;
+    } else if (decimal.exponent >= 0) {
+        memcpy(p, digits, count);
+        p += count;
+        memset(p, '0', decimal.exponent);
+        p += decimal.exponent;
+    } else if (pointPosition > 0) {
+        memcpy(p, digits, pointPosition);
+        p += pointPosition;
+        *p++ = '.';
+        memcpy(p, digits + pointPosition, count - pointPosition);
+        p += count - pointPosition;
+    } else {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -pointPosition);
+        p += -pointPosition;
+        memcpy(p, digits, count);
+        p += count;
+    }
+
+    return p - out;
+}
+
+static size_t formatNull(char *out) {
+    memcpy(out, "null", 4);
+    return 4;
+}
+
+// slow path for values outside of the fast path range, continues the search from the first unchecked digit count
+template <typename F>
+static size_t formatFallback(F val, int firstPrecision, char *out) {
+    static constexpr int MAX_DIGITS = std::is_same_v<F, float> ? 9 : 17;
+
+    int len = 0;
+    for (int precision = firstPrecision; precision <= MAX_DIGITS; precision++) {
+        len = snprintf(out, JSON_NUMBER_BUFFER_SIZE, "%1.*g", precision, static_cast<double>(val));
+        if (static_cast<F>(strtod(out, nullptr)) == val)
+            break;
+    }
+
+    return len;
+}
+
+template <typename F>
+static size_t formatShortest(F val, char *out) {
+    if (std::isnan(val) || std::isinf(val))
+        return formatNull(out);
+
+    if (std::fabs(val) < MAX_EXACT_INTEGER && val == std::trunc(val))
+        return FormatJsonInteger(static_cast<long long>(val), out);
+
+    decimal_t decimal{};
+    int precision = shortestDecimal(std::fabs(val), decimal);
+    if (precision == 0)
+        return formatDecimal(decimal, val < 0, out);
+
+    return formatFallback(val, precision, out);
+}
+
+// =====================================================================
+
+size_t FormatJsonInteger(long long val, char *out) {
+    return std::to_chars(out, out + JSON_NUMBER_BUFFER_SIZE, val).ptr - out;
+}
+
+size_t FormatJsonUnsigned(unsigned long long val, char *out) {
+    return std::to_chars(out, out + JSON_NUMBER_BUFFER_SIZE, val).ptr - out;
+}
+
+size_t FormatJsonNumber(double val, char *out) {
+    return formatShortest(val, out);
+}
+
+size_t FormatJsonNumber(float val, char *out) {
+    return formatShortest(val, out);
+}
+
+size_t FormatJsonFixed(double val, uint8_t decimals, char *out) {
+    if (std::isnan(val) || std::isinf(val))
+        return formatNull(out);
+
+    if (decimals > MAX_FIXED_DECIMALS)
+        decimals = MAX_FIXED_DECIMALS;
+
+    double scaled = std::round(std::fabs(val) * POW10[decimals]);
+    if (scaled >= MAX_EXACT_INTEGER)
+        return FormatJsonNumber(val, out);
+
+    if (scaled == 0)
+        return FormatJsonInteger(0, out);
+
+    decimal_t decimal{ static_cast<uint64_t>(scaled), -decimals };
+    while (decimal.exponent < 0 && decimal.digits % 10 == 0) {
+        decimal.digits /= 10;
+        decimal.exponent++;
+    }
+
+    return formatDecimal(decimal, val < 0, out);
+}
+
+double FloatToShortestDouble(float val) {
+    if (std::isnan(val) || std::isinf(val) || val == 0)
+        return val;
+
+    decimal_t decimal{};
+    double shortest{};
+    if (shortestDecimal(std::fabs(val), decimal) == 0 && decimalToDouble(decimal, shortest))
+        return val < 0 ? -shortest : shortest;
+
+    return val;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,48 @@
+#ifndef UTIL_BAOZI_JSON_FORMAT_H__
+#define UTIL_BAOZI_JSON_FORMAT_H__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Baozi {
+
+/*
+    Number formatting used by the json serializers (BaoJsonWriter, BaoJsonTemplate, BaoJson).
+    Every function writes the json representation of a number into out, without a NUL terminator,
+    and returns the number of characters written.
+    out must have room for at least JSON_NUMBER_BUFFER_SIZE characters.
+
+    Floating point numbers are written in their shortest round trip form - the fewest digits that read back
+    to the exact same value, so a float reading of 21.3 is written as 21.3 and not as 21.299999237060547.
+    nan and inf are written as null.
+*/
+
+static constexpr size_t JSON_NUMBER_BUFFER_SIZE = 26;
+
+// precision value meaning "shortest round trip" instead of a fixed number of decimals
+static constexpr int8_t JSON_PRECISION_SHORTEST = -1;
+
+size_t FormatJsonInteger(long long val, char *out);
+size_t FormatJsonUnsigned(unsigned long long val, char *out);
+
+// shortest representation that reads back to the same double
+size_t FormatJsonNumber(double val, char *out);
+
+// shortest representation that reads back to the same float
+size_t FormatJsonNumber(float val, char *out);
+
+// val rounded to at most decimals digits after the point, trailing zeros are dropped (21.50 -> 21.5)
+size_t FormatJsonFixed(double val, uint8_t decimals, char *out);
+
+/**
+ * @brief return the double closest to the shortest decimal form of a float
+ * @brief NOTICE - use this when handing floats to cJSON, which would otherwise print every digit of the widened float
+ *
+ * @example
+ *      FloatToShortestDouble(21.3f); // 21.3 rather than 21.299999237060547
+ */
+double FloatToShortestDouble(float val);
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_FORMAT_H__
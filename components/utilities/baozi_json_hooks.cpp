@@ -0,0 +1,60 @@
+#include "baozi_json_hooks.h"
+#include <cstdlib>
+#include <mutex>
+#include "cJSON.h"
+
+namespace Baozi {
+
+static std::mutex s_scopeMutex;
+
+// before app_main, while no task can be inside cJSON - installed by the first scope, the hooks would be written under
+// the cJSON calls of other tasks
+const bool BaoJsonHooks::s_installed = (install(), true);
+
+BaoJsonHooks::Scope::Scope(const Handler &handler) {
+    install();
+
+    configASSERT(s_owner.load() != xTaskGetCurrentTaskHandle());
+    s_scopeMutex.lock();
+
+    s_owner.store(xTaskGetCurrentTaskHandle());
+    s_handler.store(&handler);
+}
+
+BaoJsonHooks::Scope::~Scope() {
+    s_handler.store(nullptr);
+    s_owner.store(nullptr);
+
+    s_scopeMutex.unlock();
+}
+
+// =====================================================================
+
+void BaoJsonHooks::install() {
+    static const bool installed = [] {
+        cJSON_Hooks hooks{ .malloc_fn = s_malloc, .free_fn = s_free };
+        cJSON_InitHooks(&hooks);
+        return true;
+    }();
+    (void)installed;
+}
+
+void *BaoJsonHooks::s_malloc(size_t size) {
+    const Handler *handler = s_handler.load();
+    if (handler != nullptr && s_owner.load() == xTaskGetCurrentTaskHandle()) {
+        if (void *ptr = handler->allocate(handler->context, size); ptr != nullptr)
+            return ptr;
+    }
+
+    return malloc(size);
+}
+
+void BaoJsonHooks::s_free(void *ptr) {
+    const Handler *handler = s_handler.load();
+    if (handler != nullptr && s_owner.load() == xTaskGetCurrentTaskHandle() && handler->release(handler->context, ptr))
+        return;
+
+    free(ptr);
+}
+
+}   // namespace Baozi
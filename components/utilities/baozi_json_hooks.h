@@ -0,0 +1,55 @@
+#ifndef UTIL_BAOZI_JSON_HOOKS_H__
+#define UTIL_BAOZI_JSON_HOOKS_H__
+
+#include <atomic>
+#include <cstddef>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonHooks installs the cJSON malloc/free hooks once for good, and lets one scope at a time route the cJSON
+    allocations of its task to a handler (BaoJsonArena, BaoJsonBench). The hooks are never swapped afterwards,
+    so cJSON calls on other tasks are never caught half way through a swap - their allocations go to the heap.
+
+    A scope waits for the scope of another task to end, so arenas and benches of different tasks take turns.
+
+    NOTICE - Scopes do not nest, a second scope on the same task asserts
+    NOTICE - Only the allocations and frees of the scope's task reach the handler, memory handed out by a handler
+             must not be freed by another task
+*/
+class BaoJsonHooks
+{
+    public:
+    struct Handler
+    {
+        void *(*allocate)(void *context, size_t size);   // return nullptr to fall back to the heap
+        bool (*release)(void *context, void *ptr);        // return false to free ptr to the heap
+        void *context;
+    };
+
+    class Scope
+    {
+        public:
+        explicit Scope(const Handler &handler);
+        ~Scope();
+
+        Scope(const Scope &rhs) = delete;
+        Scope &operator=(const Scope &rhs) = delete;
+    };
+
+    private:
+    static void install();
+
+    static void *s_malloc(size_t size);
+    static void s_free(void *ptr);
+
+    static inline std::atomic<const Handler *> s_handler{};
+    static inline std::atomic<TaskHandle_t> s_owner{};
+    static const bool s_installed;
+};
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_HOOKS_H__
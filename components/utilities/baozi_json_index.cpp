@@ -0,0 +1,67 @@
+#include "baozi_json_index.h"
+#include <cstring>
+#include "freertos/FreeRTOS.h"
+
+namespace Baozi {
+
+BaoJsonIndex::BaoJsonIndex(const cJSON *object) {
+    configASSERT(cJSON_IsObject(object));
+
+    size_t count = 0;
+    for (const cJSON *item = object->child; item != nullptr; item = item->next)
+        count++;
+
+    // keep the load factor at or below 1/2 so probe sequences stay short
+    size_t capacity = 4;
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    m_entries = std::make_unique<entry_t[]>(capacity);
+    m_mask = capacity - 1;
+
+    for (const cJSON *item = object->child; item != nullptr; item = item->next) {
+        if (item->string == nullptr)
+            continue;
+
+        uint32_t hash = s_hash(item->string);
+        size_t slot = hash & m_mask;
+        bool duplicate = false;
+        while (m_entries[slot].item != nullptr) {
+            if (m_entries[slot].hash == hash && strcmp(m_entries[slot].item->string, item->string) == 0) {
+                duplicate = true;
+                break;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+
+        if (!duplicate) {
+            m_entries[slot] = { item, hash };
+            m_size++;
+        }
+    }
+}
+
+const cJSON *BaoJsonIndex::Find(const char *key) const {
+    configASSERT(key != nullptr);
+
+    uint32_t hash = s_hash(key);
+    for (size_t slot = hash & m_mask; m_entries[slot].item != nullptr; slot = (slot + 1) & m_mask) {
+        if (m_entries[slot].hash == hash && strcmp(m_entries[slot].item->string, key) == 0)
+            return m_entries[slot].item;
+    }
+
+    return nullptr;
+}
+
+// FNV-1a
+uint32_t BaoJsonIndex::s_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = key; *c != '\0'; c++) {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,46 @@
+#ifndef UTIL_BAOZI_JSON_INDEX_H__
+#define UTIL_BAOZI_JSON_INDEX_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "cJSON.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonIndex is an open addressing (linear probing) hash table over the keys of a single json object.
+    It is built once in O(n) and turns key lookups into O(1), instead of cJSON's linear walk over the siblings.
+
+    NOTICE - Lookups are case sensitive (cJSON_GetObjectItem is not), duplicate keys resolve to the first one like in cJSON
+    NOTICE - The index points into the object, it must be rebuilt whenever the object's keys change
+*/
+class BaoJsonIndex
+{
+    public:
+    explicit BaoJsonIndex(const cJSON *object);
+
+    /**
+     * @brief return the item with the given key, nullptr if the object has no such key
+     */
+    const cJSON *Find(const char *key) const;
+
+    size_t Size() const { return m_size; }
+
+    private:
+    struct entry_t
+    {
+        const cJSON *item;
+        uint32_t hash;
+    };
+
+    std::unique_ptr<entry_t[]> m_entries;
+    size_t m_mask{};
+    size_t m_size{};
+
+    static uint32_t s_hash(const char *key);
+};
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_INDEX_H__
@@ -0,0 +1,123 @@
+#include "baozi_json.h"
+
+namespace Baozi {
+
+// both from and to are objects, returns the (possibly empty) patch object, nullptr if an allocation failed
+static cJSON *createPatch(const cJSON *from, const cJSON *to) {
+    cJSON *patch = cJSON_CreateObject();
+    if (patch == nullptr)
+        return nullptr;
+
+    for (const cJSON *item = from->child; item != nullptr; item = item->next) {
+        if (cJSON_GetObjectItemCaseSensitive(to, item->string) != nullptr)
+            continue;
+
+        if (cJSON_AddNullToObject(patch, item->string) == nullptr) {
+            cJSON_Delete(patch);
+            return nullptr;
+        }
+    }
+
+    for (const cJSON *item = to->child; item != nullptr; item = item->next) {
+        const cJSON *old = cJSON_GetObjectItemCaseSensitive(from, item->string);
+
+        cJSON *change = nullptr;
+        if (cJSON_IsObject(old) && cJSON_IsObject(item)) {
+            change = createPatch(old, item);
+            if (change != nullptr && change->child == nullptr) {
+                cJSON_Delete(change);
+                continue;
+            }
+        } else if (old == nullptr || !cJSON_Compare(old, item, true)) {
+            change = cJSON_Duplicate(item, true);
+        } else {
+            continue;
+        }
+
+        if (change == nullptr || !cJSON_AddItemToObject(patch, item->string, change)) {
+            cJSON_Delete(change);
+            cJSON_Delete(patch);
+            return nullptr;
+        }
+    }
+
+    return patch;
+}
+
+static bool replaceOrAdd(cJSON *target, const cJSON *current, const char *key, cJSON *replacement) {
+    if (replacement == nullptr)
+        return false;
+
+    bool added = current != nullptr ? cJSON_ReplaceItemInObjectCaseSensitive(target, key, replacement)
+                                    : cJSON_AddItemToObject(target, key, replacement);
+    if (!added)
+        cJSON_Delete(replacement);
+
+    return added;
+}
+
+// both target and patch are objects, returns false if an allocation failed (target is then partly patched)
+static bool applyPatch(cJSON *target, const cJSON *patch) {
+    for (const cJSON *item = patch->child; item != nullptr; item = item->next) {
+        cJSON *current = cJSON_GetObjectItemCaseSensitive(target, item->string);
+
+        if (cJSON_IsNull(item)) {
+            if (current != nullptr)
+                cJSON_Delete(cJSON_DetachItemViaPointer(target, current));
+            continue;
+        }
+
+        if (!cJSON_IsObject(item)) {
+            if (!replaceOrAdd(target, current, item->string, cJSON_Duplicate(item, true)))
+                return false;
+            continue;
+        }
+
+        // a nested patch is merged into the existing object, or into an empty one (dropping its nulls)
+        if (!cJSON_IsObject(current)) {
+            cJSON *object = cJSON_CreateObject();
+            if (!replaceOrAdd(target, current, item->string, object))
+                return false;
+            current = object;
+        }
+
+        if (!applyPatch(current, item))
+            return false;
+    }
+
+    return true;
+}
+
+std::optional<BaoJson> BaoJson::CreateMergePatch(const BaoJson &from, const BaoJson &to) {
+    cJSON *patch = (!cJSON_IsObject(from.data()) || !cJSON_IsObject(to.data())) ? cJSON_Duplicate(to.data(), true)
+                                                                                 : createPatch(from.data(), to.data());
+    if (patch == nullptr)
+        return std::nullopt;
+
+    return BaoJson{ patch };
+}
+
+eResult BaoJson::ApplyMergePatch(const BaoJson &patch) {
+    invalidate();
+
+    if (!cJSON_IsObject(patch.data())) {
+        cJSON *replacement = cJSON_Duplicate(patch.data(), true);
+        if (replacement == nullptr)
+            return eResult::OUT_OF_MEMORY;
+
+        m_json.reset(replacement);
+        return eResult::SUCCESS;
+    }
+
+    if (!cJSON_IsObject(m_json.get())) {
+        cJSON *object = cJSON_CreateObject();
+        if (object == nullptr)
+            return eResult::OUT_OF_MEMORY;
+
+        m_json.reset(object);
+    }
+
+    return applyPatch(m_json.get(), patch.data()) ? eResult::SUCCESS : eResult::OUT_OF_MEMORY;
+}
+
+}   // namespace Baozi
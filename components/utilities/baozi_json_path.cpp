@@ -0,0 +1,59 @@
+#include "baozi_json_path.h"
+
+namespace Baozi {
+
+using eType = BaoJsonToken::eType;
+
+const cJSON *BaoJsonPath::Resolve(const cJSON *json) const {
+    const cJSON *node = json;
+    for (size_t i = 0; i < m_size && node != nullptr; i++) {
+        if (cJSON_IsObject(node))
+            node = cJSON_GetObjectItemCaseSensitive(node, Segment(i));
+        else if (cJSON_IsArray(node) && m_indices[i] != NOT_AN_INDEX)
+            node = cJSON_GetArrayItem(node, m_indices[i]);
+        else
+            return nullptr;
+    }
+
+    return node;
+}
+
+std::optional<BaoJsonView> BaoJsonPath::Resolve(const BaoJsonView &json) const {
+    if (!json)
+        return std::nullopt;
+
+    size_t index = json.m_index;
+    for (size_t i = 0; i < m_size; i++) {
+        const BaoJsonToken &token = json.m_tokens[index];
+
+        if (token.type == eType::OBJECT) {
+            auto value = BaoJsonView{ json.m_json, json.m_tokens, index }.findItem(Segment(i));
+            if (!value.has_value())
+                return std::nullopt;
+            index = value.value();
+        } else if (token.type == eType::ARRAY && m_indices[i] < token.size) {
+            index++;
+            for (uint16_t item = 0; item < m_indices[i]; item++)
+                index += json.m_tokens[index].skip;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    return BaoJsonView{ json.m_json, json.m_tokens, index };
+}
+
+// =====================================================================
+
+const cJSON *BaoJsonCachedPath::Resolve(const BaoJson &json) {
+    // generations are unique across every BaoJson, a matching one means the very same, unchanged tree
+    if (m_root != nullptr && json.data() == m_root && json.Generation() == m_generation)
+        return m_node;
+
+    m_root = json.data();
+    m_generation = json.Generation();
+    m_node = m_path.Resolve(m_root);
+    return m_node;
+}
+
+}   // namespace Baozi
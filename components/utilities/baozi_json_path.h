@@ -0,0 +1,136 @@
+#ifndef UTIL_BAOZI_JSON_PATH_H__
+#define UTIL_BAOZI_JSON_PATH_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include "baozi_json.h"
+#include "baozi_json_view.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonPath is a compiled RFC 6901 json pointer, e.g. "/light/color/r" or "/effects/0".
+    Literals are compiled at compile time ("..."_path, an invalid pointer fails compilation),
+    runtime strings with BaoJsonPath::Parse().
+
+    A path is evaluated against a BaoJson or a BaoJsonView by walking the nodes/tokens directly,
+    no intermediate BaoJson is created or copied on the way.
+    Keys are matched case sensitively, and a segment is used as an array index when the node is an array.
+
+    Use BaoJsonCachedPath to query the same BaoJson repeatedly, it remembers the resolved node.
+
+    example:
+        static constexpr auto RED = "/light/color/r"_path;
+
+        auto red = RED.GetVal<int>(json);      // json is a BaoJson
+        auto green = "/light/color/g"_path.GetVal<int>(payload);   // payload is a BaoJsonView
+*/
+class BaoJsonPath
+{
+    public:
+    static constexpr size_t MAX_LENGTH = 64;   // unescaped keys, including a terminator per segment
+    static constexpr size_t MAX_SEGMENTS = 8;
+    static constexpr uint16_t NOT_AN_INDEX = UINT16_MAX;
+
+    consteval BaoJsonPath(const char *pointer) {
+        if (!compile(pointer))
+            invalidJsonPointer();
+    }
+
+    /**
+     * @brief compile a json pointer at runtime
+     *
+     * @return std::optional<BaoJsonPath> the path, std::nullopt if the pointer is invalid or too long
+     */
+    static constexpr std::optional<BaoJsonPath> Parse(std::string_view pointer) {
+        BaoJsonPath path;
+        if (!path.compile(pointer))
+            return std::nullopt;
+
+        return path;
+    }
+
+    /**
+     * @brief Get the value the path points to, see BaoJson::GetVal / BaoJsonView::GetVal for the supported types
+     *
+     * @return std::optional<T> the value if the path exists and has the requested type, std::nullopt otherwise
+     */
+    template <typename T>
+    std::optional<T> GetVal(const BaoJson &json) const;
+
+    template <typename T>
+    std::optional<T> GetVal(const BaoJsonView &json) const;
+
+    /**
+     * @brief return the node the path points to, nullptr if there is none
+     */
+    const cJSON *Resolve(const cJSON *json) const;
+
+    std::optional<BaoJsonView> Resolve(const BaoJsonView &json) const;
+
+    /**
+     * @brief return the number of segments, 0 for the empty pointer "" (the whole document)
+     */
+    constexpr size_t Size() const { return m_size; }
+
+    /**
+     * @brief return a segment, unescaped (~1 is '/', ~0 is '~')
+     */
+    constexpr const char *Segment(size_t i) const { return &m_keys[m_offsets[i]]; }
+
+    private:
+    std::array<char, MAX_LENGTH> m_keys{};
+    std::array<uint8_t, MAX_SEGMENTS> m_offsets{};
+    std::array<uint16_t, MAX_SEGMENTS> m_indices{};   // the segment as an array index, NOT_AN_INDEX if it is not one
+    uint8_t m_size{};
+
+    constexpr BaoJsonPath() = default;
+
+    constexpr bool compile(std::string_view pointer);
+
+    // not constexpr - reaching it while compiling a literal fails compilation
+    static void invalidJsonPointer();
+};
+
+consteval BaoJsonPath operator""_path(const char *pointer, size_t) {
+    return BaoJsonPath{ pointer };
+}
+
+/*
+    BaoJsonCachedPath remembers the node a path resolved to, so repeated queries on the same, unchanged BaoJson
+    are O(1). Any non-const access to the BaoJson (AddVal, Ref(), data()...) invalidates the cached node.
+
+    NOTICE - Not thread safe, keep one per task
+    NOTICE - Changes made through a BaoJsonRef / cJSON* taken before the query are not noticed (see BaoJson::BuildIndex)
+
+    example:
+        static BaoJsonCachedPath red{"/light/color/r"_path};
+        auto value = red.GetVal<int>(state);
+*/
+class BaoJsonCachedPath
+{
+    public:
+    explicit BaoJsonCachedPath(const BaoJsonPath &path) : m_path(path) {}
+
+    template <typename T>
+    std::optional<T> GetVal(const BaoJson &json);
+
+    const cJSON *Resolve(const BaoJson &json);
+
+    const BaoJsonPath &Path() const { return m_path; }
+
+    private:
+    BaoJsonPath m_path;
+    const cJSON *m_root{};
+    uint32_t m_generation{};
+    const cJSON *m_node{};
+};
+
+}   // namespace Baozi
+
+#include "baozi_json_path_inl.hpp"
+
+#endif   // UTIL_BAOZI_JSON_PATH_H__
@@ -0,0 +1,87 @@
+#ifndef UTIL_BAOZI_JSON_PATH_INL_H__
+#define UTIL_BAOZI_JSON_PATH_INL_H__
+
+namespace Baozi {
+
+// "" is the whole document, otherwise every segment starts with '/' and ~ only escapes ~0 and ~1
+constexpr bool BaoJsonPath::compile(std::string_view pointer) {
+    m_size = 0;
+    if (pointer.empty())
+        return true;
+
+    if (pointer[0] != '/')
+        return false;
+
+    size_t length = 0;
+    size_t i = 1;
+    while (true) {
+        if (m_size == MAX_SEGMENTS)
+            return false;
+
+        m_offsets[m_size] = static_cast<uint8_t>(length);
+        size_t start = length;
+        uint32_t index = 0;
+        bool isIndex = true;
+
+        for (; i < pointer.size() && pointer[i] != '/'; i++) {
+            char c = pointer[i];
+            if (c == '~') {
+                if (i + 1 == pointer.size() || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+                    return false;
+                c = pointer[++i] == '0' ? '~' : '/';
+            }
+
+            isIndex = isIndex && c >= '0' && c <= '9' && index < NOT_AN_INDEX;
+            if (isIndex)
+                index = index * 10 + (c - '0');
+
+            if (length + 1 >= MAX_LENGTH)
+                return false;
+            m_keys[length++] = c;
+        }
+
+        // array indices have no leading zeros, "-" (past the end) can not be read
+        bool hasLeadingZero = length - start > 1 && m_keys[start] == '0';
+        isIndex = isIndex && length > start && !hasLeadingZero && index < NOT_AN_INDEX;
+        m_indices[m_size] = isIndex ? static_cast<uint16_t>(index) : NOT_AN_INDEX;
+
+        m_keys[length++] = '\0';
+        m_size++;
+
+        if (i == pointer.size())
+            return true;
+
+        i++;   // the next segment's '/'
+    }
+}
+
+template <typename T>
+std::optional<T> BaoJsonPath::GetVal(const BaoJson &json) const {
+    const cJSON *node = Resolve(json.data());
+    if (node == nullptr)
+        return std::nullopt;
+
+    return BaoJsonConstRef{ node }.GetVal<T>();
+}
+
+template <typename T>
+std::optional<T> BaoJsonPath::GetVal(const BaoJsonView &json) const {
+    auto node = Resolve(json);
+    if (!node.has_value())
+        return std::nullopt;
+
+    return node->GetVal<T>();
+}
+
+template <typename T>
+std::optional<T> BaoJsonCachedPath::GetVal(const BaoJson &json) {
+    const cJSON *node = Resolve(json);
+    if (node == nullptr)
+        return std::nullopt;
+
+    return BaoJsonConstRef{ node }.GetVal<T>();
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_PATH_INL_H__
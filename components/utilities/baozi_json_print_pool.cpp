@@ -0,0 +1,148 @@
+#include "baozi_json_print_pool.h"
+#include "freertos/FreeRTOS.h"
+#include <cstring>
+#include <utility>
+
+namespace Baozi {
+
+// ================== PRINTED ==================
+
+BaoJsonPrintPool::Printed::Printed(Printed &&rhs)
+    : m_pool(std::exchange(rhs.m_pool, nullptr)), m_str(std::exchange(rhs.m_str, nullptr)),
+      m_length(std::exchange(rhs.m_length, 0)), m_slot(rhs.m_slot) {}
+
+BaoJsonPrintPool::Printed &BaoJsonPrintPool::Printed::operator=(Printed &&rhs) {
+    if (this != &rhs) {
+        release();
+        m_pool = std::exchange(rhs.m_pool, nullptr);
+        m_str = std::exchange(rhs.m_str, nullptr);
+        m_length = std::exchange(rhs.m_length, 0);
+        m_slot = rhs.m_slot;
+    }
+
+    return *this;
+}
+
+BaoJsonPrintPool::Printed::~Printed() {
+    release();
+}
+
+void BaoJsonPrintPool::Printed::release() {
+    if (m_str == nullptr)
+        return;
+
+    if (m_pool != nullptr)
+        m_pool->release(m_slot);
+    else
+        cJSON_free(m_str);
+
+    m_str = nullptr;
+}
+
+// ================== POOL ==================
+
+BaoJsonPrintPool::Printed BaoJsonPrintPool::Print(const cJSON *json, const char *sizeKey) {
+    Printed printed;
+    if (json == nullptr)
+        return printed;   // an empty BaoJson, like PrintRaw() of it
+
+    uint32_t hash = s_hash(sizeKey);
+
+    slot_t *slot = nullptr;
+    size_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t expected = predict(hash);
+        if (expected > 0)
+            slot = acquire(expected + expected / 8 + PRINT_SLACK, index);   // leave room for the message to grow a bit
+    }
+
+    // cJSON_PrintPreallocated does not modify the item, it is just not declared const
+    if (slot != nullptr) {
+        size_t size = SIZE_CLASSES[index / BUFFERS_PER_CLASS];
+        if (cJSON_PrintPreallocated(const_cast<cJSON *>(json), slot->buffer.get(), size, false)) {
+            printed.m_pool = this;
+            printed.m_str = slot->buffer.get();
+            printed.m_length = strlen(printed.m_str);
+            printed.m_slot = index;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.hits++;
+            learn(hash, printed.m_length);
+            return printed;
+        }
+
+        release(index);
+    }
+
+    printed.m_str = cJSON_PrintUnformatted(json);
+    if (printed.m_str != nullptr)
+        printed.m_length = strlen(printed.m_str);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.misses++;
+    if (printed.m_str != nullptr)
+        learn(hash, printed.m_length);
+
+    return printed;
+}
+
+BaoJsonPrintPool::Stats BaoJsonPrintPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+// =====================================================================
+
+size_t BaoJsonPrintPool::predict(uint32_t hash) const {
+    const prediction_t &prediction = m_predictions[hash % PREDICTOR_SIZE];
+    return prediction.hash == hash ? prediction.length : 0;
+}
+
+void BaoJsonPrintPool::learn(uint32_t hash, size_t length) {
+    m_predictions[hash % PREDICTOR_SIZE] = { hash, static_cast<uint32_t>(length) };
+}
+
+// a free buffer of the smallest class that holds 'required' bytes, bigger classes are used when it is exhausted
+BaoJsonPrintPool::slot_t *BaoJsonPrintPool::acquire(size_t required, size_t &slotIndex) {
+    for (size_t sizeClass = 0; sizeClass < SIZE_CLASSES.size(); sizeClass++) {
+        if (SIZE_CLASSES[sizeClass] < required)
+            continue;
+
+        for (size_t i = sizeClass * BUFFERS_PER_CLASS; i < (sizeClass + 1) * BUFFERS_PER_CLASS; i++) {
+            slot_t &slot = m_slots[i];
+            if (slot.inUse)
+                continue;
+
+            if (slot.buffer == nullptr) {
+                slot.buffer = std::make_unique<char[]>(SIZE_CLASSES[sizeClass]);
+                m_stats.allocatedBytes += SIZE_CLASSES[sizeClass];
+            }
+
+            slot.inUse = true;
+            slotIndex = i;
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+void BaoJsonPrintPool::release(size_t slotIndex) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    configASSERT(m_slots[slotIndex].inUse);
+    m_slots[slotIndex].inUse = false;
+}
+
+// FNV-1a
+uint32_t BaoJsonPrintPool::s_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    for (const char *c = key; c != nullptr && *c != '\0'; c++) {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,120 @@
+#ifndef UTIL_BAOZI_JSON_PRINT_POOL_H__
+#define UTIL_BAOZI_JSON_PRINT_POOL_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "cJSON.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonPrintPool prints cJSON trees into a small pool of reusable buffers (cJSON_PrintPreallocated),
+    instead of a fresh, realloc grown string per print (cJSON_PrintUnformatted).
+
+    Buffers come in a few size classes. The class is picked by a predictor that remembers the last printed length
+    per key (e.g. the mqtt topic), so a stream of similar messages keeps landing in the same, right sized class.
+    When the prediction is too small, every buffer of the class is taken or the json is bigger than the largest class,
+    the json is printed on the heap instead and the predictor learns its length for the next time.
+    Buffers are allocated on first use, a steady stream of messages makes no heap allocation at all.
+
+    NOTICE - Thread safe, a printed buffer goes back to the pool when its Printed handle is destroyed
+
+    example:
+        auto payload = pool.Print(json.data(), topic);
+        if (payload)
+            esp_mqtt_client_publish(client, topic, payload.c_str(), payload.length(), 0, false);
+*/
+class BaoJsonPrintPool
+{
+    public:
+    static constexpr std::array<size_t, 4> SIZE_CLASSES = { 128, 256, 512, 1024 };
+    static constexpr size_t BUFFERS_PER_CLASS = 2;
+    static constexpr size_t PREDICTOR_SIZE = 16;
+
+    struct Stats
+    {
+        uint32_t hits;            // printed straight into a pooled buffer
+        uint32_t misses;          // printed on the heap - unknown or grown size, pool exhausted or too big
+        size_t allocatedBytes;    // pooled buffers allocated so far
+    };
+
+    /*
+        a printed json, either in a pooled buffer or on the heap. Move only, releases its buffer when destroyed
+    */
+    class Printed
+    {
+        public:
+        Printed() = default;
+        Printed(Printed &&rhs);
+        Printed &operator=(Printed &&rhs);
+        Printed(const Printed &) = delete;
+        Printed &operator=(const Printed &) = delete;
+        ~Printed();
+
+        operator bool() const { return m_str != nullptr; }
+        const char *c_str() const { return m_str; }
+        size_t length() const { return m_length; }
+
+        private:
+        friend class BaoJsonPrintPool;
+
+        BaoJsonPrintPool *m_pool{};   // nullptr for heap prints
+        char *m_str{};
+        size_t m_length{};
+        size_t m_slot{};
+
+        void release();
+    };
+
+    BaoJsonPrintPool() = default;
+    BaoJsonPrintPool(const BaoJsonPrintPool &) = delete;
+    BaoJsonPrintPool &operator=(const BaoJsonPrintPool &) = delete;
+
+    /**
+     * @brief print json unformatted
+     *
+     * @param json - the json to print
+     * @param sizeKey - messages sharing a key are expected to have similar sizes, e.g. the mqtt topic
+     * @return Printed - the printed json, empty if json is nullptr or printing failed
+     */
+    Printed Print(const cJSON *json, const char *sizeKey);
+
+    Stats GetStats() const;
+
+    private:
+    static constexpr size_t SLOT_COUNT = SIZE_CLASSES.size() * BUFFERS_PER_CLASS;
+
+    // cJSON_PrintPreallocated may need up to 5 bytes more than the printed length
+    static constexpr size_t PRINT_SLACK = 5;
+
+    struct slot_t
+    {
+        std::unique_ptr<char[]> buffer;
+        bool inUse{};
+    };
+
+    struct prediction_t
+    {
+        uint32_t hash;
+        uint32_t length;
+    };
+
+    mutable std::mutex m_mutex;
+    std::array<slot_t, SLOT_COUNT> m_slots{};
+    std::array<prediction_t, PREDICTOR_SIZE> m_predictions{};   // direct mapped by key hash, collisions overwrite
+    Stats m_stats{};
+
+    size_t predict(uint32_t hash) const;
+    void learn(uint32_t hash, size_t length);
+    slot_t *acquire(size_t required, size_t &slotIndex);
+    void release(size_t slotIndex);
+
+    static uint32_t s_hash(const char *key);
+};
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_PRINT_POOL_H__
@@ -0,0 +1,72 @@
+#include "baozi_json_ref.h"
+
+namespace Baozi {
+
+// ================== CONST REF ==================
+
+bool BaoJsonConstRef::IsEmpty() const {
+    return m_json == nullptr || m_json->child == nullptr;
+}
+
+bool BaoJsonConstRef::IsObject() const {
+    return cJSON_IsObject(m_json);
+}
+
+bool BaoJsonConstRef::IsArray() const {
+    return cJSON_IsArray(m_json);
+}
+
+std::unique_ptr<char, void (*)(void *)> BaoJsonConstRef::PrintRaw() const {
+    return { cJSON_PrintUnformatted(m_json), cJSON_free };
+}
+
+BaoJson BaoJsonConstRef::Duplicate() const {
+    return BaoJson(cJSON_Duplicate(m_json, true));
+}
+
+bool BaoJsonConstRef::HasItem(const char *key) const {
+    return cJSON_HasObjectItem(m_json, key);
+}
+
+int BaoJsonConstRef::ArraySize() const {
+    configASSERT(cJSON_IsArray(m_json));
+    return cJSON_GetArraySize(m_json);
+}
+
+bool BaoJsonConstRef::isContainerOrNull() const {
+    return cJSON_IsObject(m_json) || cJSON_IsArray(m_json) || cJSON_IsNull(m_json);
+}
+
+// ================== REF ==================
+
+std::optional<BaoJsonRef> BaoJsonRef::GetRef(const char *key) const {
+    cJSON *item = cJSON_GetObjectItem(data(), key);
+    if (!cJSON_IsObject(item) && !cJSON_IsArray(item))
+        return std::nullopt;
+
+    return BaoJsonRef{ item };
+}
+
+// appends an already linked chain of items, cJSON keeps the array's tail in child->prev
+void BaoJsonRef::spliceToArray(cJSON *head, cJSON *tail) const {
+    cJSON *array = data();
+    tail->next = nullptr;
+
+    if (array->child == nullptr) {
+        array->child = head;
+    } else {
+        cJSON *last = array->child->prev;
+        last->next = head;
+        head->prev = last;
+    }
+
+    array->child->prev = tail;
+}
+
+void BaoJsonRef::AddValToArray(BaoJson &&val) const {
+    configASSERT(cJSON_IsArray(m_json));
+
+    configASSERT(cJSON_AddItemToArray(data(), val.take().release()) == true);
+}
+
+}   // namespace Baozi
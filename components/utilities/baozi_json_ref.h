@@ -0,0 +1,174 @@
+#ifndef UTIL_BAOZI_JSON_REF_H__
+#define UTIL_BAOZI_JSON_REF_H__
+
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include "cJSON.h"
+#include "baozi_json_traits.h"
+#include "freertos/FreeRTOS.h"
+
+namespace Baozi {
+
+class BaoJsonRef;
+
+/*
+    BaoJsonConstRef is a borrowed, read only reference to a json item inside a tree owned by a BaoJson.
+    It is a plain pointer - creating, copying and reading through it never allocates, copies or detaches anything.
+    The owning BaoJson must outlive the reference, and items must not be removed while referenced.
+
+    Nested objects and arrays are returned as references into the same tree.
+
+    example:
+        BaoJson json = ...;
+        auto light = json.GetVal<BaoJsonConstRef>("light"); // no copy
+        if (light)
+            light->ArrayForEach<BaoJsonConstRef>([](BaoJsonConstRef effect) { ... });
+*/
+class BaoJsonConstRef
+{
+    public:
+    BaoJsonConstRef() = default;
+    explicit BaoJsonConstRef(const cJSON *json) : m_json(json) {}
+
+    const cJSON *data() const { return m_json; }
+
+    /**
+     * @brief return true if the reference points to an item
+     */
+    operator bool() const { return m_json != nullptr; }
+
+    /**
+     * @brief return true if the referenced item is empty or null
+     */
+    bool IsEmpty() const;
+
+    bool IsObject() const;
+    bool IsArray() const;
+
+    /**
+     * @brief return the referenced item as a string, see BaoJson::PrintRaw
+     */
+    std::unique_ptr<char, void (*)(void *)> PrintRaw() const;
+
+    /**
+     * @brief deep copy the referenced item into an owning BaoJson
+     */
+    BaoJson Duplicate() const;
+
+    bool HasItem(const char *key) const;
+
+    template <typename... Ts>
+    bool HasEitherItems(Ts... keys) const {
+        return (HasItem(keys) || ...);
+    }
+
+    template <typename... Ts>
+    bool HasAllItems(Ts... keys) const {
+        return (HasItem(keys) && ...);
+    }
+
+    /**
+     * @brief Get a value from the json object by key, see BaoJson::GetVal
+     * @brief NOTICE - BaoJsonConstRef borrows the nested item, BaoJson returns an owning deep copy of it
+     */
+    template <typename T>
+    std::optional<T> GetVal(const char *key) const;
+
+    template <typename T>
+    std::optional<T> GetVal() const;
+
+    /**
+     * @brief Performs a function for each item of type T in the array, see BaoJson::ArrayForEach
+     * @brief NOTICE - objects are passed as BaoJsonConstRef (for both T = BaoJsonConstRef and T = BaoJson)
+     */
+    template <typename T, typename F>
+    void ArrayForEach(F &&func) const;
+
+    int ArraySize() const;
+
+    protected:
+    const cJSON *m_json{};
+
+    bool isContainerOrNull() const;
+};
+
+/*
+    BaoJsonRef is a borrowed, mutable reference to a json item inside a tree owned by a BaoJson.
+    It adds the BaoJson write API, so nested objects can be filled in place.
+
+    example:
+        BaoJson json{KV{"device", BaoJson{}}};
+        json.GetRef("device")->AddVals(KV{"name", "baozi"}, KV{"sw_version", "1.0"});
+*/
+class BaoJsonRef : public BaoJsonConstRef
+{
+    public:
+    BaoJsonRef() = default;
+    explicit BaoJsonRef(cJSON *json) : BaoJsonConstRef(json) {}
+
+    // a BaoJsonRef is only created from a mutable item, so casting the constness back is safe
+    cJSON *data() const { return const_cast<cJSON *>(m_json); }
+
+    /**
+     * @brief Get a mutable reference to a nested object or array
+     */
+    std::optional<BaoJsonRef> GetRef(const char *key) const;
+
+    /**
+     * @brief see BaoJson::AddVal
+     */
+    template <typename T>
+    void AddVal(const char *key, T val) const;
+
+    /**
+     * @brief see BaoJson::AddVal(StaticKey, T)
+     */
+    template <typename T>
+    void AddVal(StaticKey key, T val) const;
+
+    /**
+     * @brief see BaoJson::AddVals
+     */
+    template <typename... Ts>
+    void AddVals(Ts... vals) const;
+
+    template <typename T>
+    void AddValueOrNull(const char *key, std::optional<T> optionalVal) const;
+
+    template <typename T>
+    void AddValueOrDefault(const char *key, std::optional<T> optionalVal, T defaultVal) const;
+
+    template <typename T>
+    void AddValToArray(T val) const;
+
+    void AddValToArray(BaoJson &&val) const;
+
+    /**
+     * @brief see BaoJson::AppendNumbers
+     */
+    template <typename T>
+    void AppendNumbers(std::span<const T> values) const;
+
+    template <typename... Ts>
+    void AddValsToArray(Ts &&...vals) const;
+
+    template <class InputIt, typename = std::enable_if_t<std::is_base_of_v<std::input_iterator_tag,
+                                                                           typename std::iterator_traits<InputIt>::iterator_category>,
+                                                         void>>
+    void AddValsToArray(InputIt begin, InputIt end) const;
+
+    private:
+    template <typename T>
+    void addKeyValue(KV<T> kv) const;
+
+    void spliceToArray(cJSON *head, cJSON *tail) const;
+};
+
+}   // namespace Baozi
+
+// BaoJsonRef templates need the complete BaoJson, baozi_json.h includes baozi_json_ref_inl.hpp
+#include "baozi_json.h"
+
+#endif   // UTIL_BAOZI_JSON_REF_H__
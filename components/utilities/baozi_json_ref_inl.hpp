@@ -0,0 +1,220 @@
+#ifndef UTIL_BAOZI_JSON_REF_INL_H__
+#define UTIL_BAOZI_JSON_REF_INL_H__
+
+#include "baozi_json_traits.h"
+#include "baozi_json_format.h"
+
+namespace Baozi {
+
+// ================== CONST REF ==================
+
+template <typename T>
+std::optional<T> BaoJsonConstRef::GetVal(const char *key) const {
+    static_assert(is_json_deserializable_v<T> || std::is_same_v<T, BaoJsonConstRef>, "Type is not JSON deserializable");
+
+    const cJSON *item = cJSON_GetObjectItem(m_json, key);
+    if (item == nullptr) {
+        return std::nullopt;
+    }
+
+    return BaoJsonConstRef{ item }.GetVal<T>();
+}
+
+template <typename T>
+std::optional<T> BaoJsonConstRef::GetVal() const {
+    static_assert(is_json_deserializable_v<T> || std::is_same_v<T, BaoJsonConstRef>, "Type is not JSON deserializable");
+
+    if (m_json == nullptr) {
+        return std::nullopt;
+    }
+
+    if constexpr (std::is_same_v<T, bool>)
+        return cJSON_IsBool(m_json) ? std::optional{ (bool)cJSON_IsTrue(m_json) } : std::nullopt;
+    else if constexpr (std::is_arithmetic_v<T>)
+        return cJSON_IsNumber(m_json) ? std::optional{ cJSON_GetNumberValue(m_json) } : std::nullopt;
+    else if constexpr (std::is_same_v<T, const char *>)
+        return cJSON_IsString(m_json) ? std::optional{ cJSON_GetStringValue(m_json) } : std::nullopt;
+    else if constexpr (std::is_same_v<T, BaoJsonConstRef>)
+        return isContainerOrNull() ? std::optional{ *this } : std::nullopt;
+    else if constexpr (std::is_same_v<T, BaoJson>)
+        return isContainerOrNull() ? std::optional{ Duplicate() } : std::nullopt;
+    else if constexpr (hasValue_v<T>)
+        return cJSON_IsNumber(m_json) ? std::optional{ T(cJSON_GetNumberValue(m_json)) } : std::nullopt;
+    else if constexpr (HasCStr_v<T>)
+        return cJSON_IsString(m_json) ? std::optional{ T{ cJSON_GetStringValue(m_json) } } : std::nullopt;
+    else
+        return std::nullopt;
+}
+
+template <typename T, typename F>
+void BaoJsonConstRef::ArrayForEach(F &&func) const {
+    configASSERT(cJSON_IsArray(m_json));
+    static_assert(is_json_deserializable_v<T> || std::is_same_v<T, BaoJsonConstRef> || std::is_same_v<T, const cJSON *>,
+                  "Type is not JSON deserializable");
+
+    if (m_json == nullptr) {
+        return;
+    }
+
+    const cJSON *item = m_json->child;
+    while (item != nullptr) {
+        if constexpr (std::is_same_v<T, bool>) {
+            if (cJSON_IsBool(item))
+                func(cJSON_IsTrue(item));
+        } else if constexpr (std::is_same_v<BaoJsonConstRef, T> || std::is_same_v<BaoJson, T>) {
+            if (cJSON_IsObject(item))
+                func(BaoJsonConstRef{ item });
+        } else if constexpr (std::is_same_v<const cJSON *, T>) {
+            if (cJSON_IsObject(item))
+                func(item);
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (cJSON_IsNumber(item))
+                func(cJSON_GetNumberValue(item));
+        } else if constexpr (std::is_same_v<T, const char *>) {
+            if (cJSON_IsString(item))
+                func(cJSON_GetStringValue(item));
+        } else if constexpr (hasValue_v<T>) {
+            if (cJSON_IsNumber(item))
+                func(T{ cJSON_GetNumberValue(item) });
+        } else if constexpr (HasCStr_v<T>) {
+            if (cJSON_IsString(item))
+                func(T{ cJSON_GetStringValue(item) });
+        }
+
+        item = item->next;
+    }
+}
+
+// ================== REF ==================
+
+template <typename T>
+void BaoJsonRef::AddVal(const char *key, T val) const {
+    static_assert(is_json_serializable_v<T>, "type is not json serializable");
+
+    if constexpr (std::is_same_v<T, bool>) {
+        configASSERT(cJSON_AddBoolToObject(data(), key, val) != nullptr);
+    } else if constexpr (std::is_same_v<T, float>) {
+        configASSERT(cJSON_AddNumberToObject(data(), key, FloatToShortestDouble(val)) != nullptr);
+    } else if constexpr (std::is_integral_v<T> || std::is_same_v<T, double>) {
+        configASSERT(cJSON_AddNumberToObject(data(), key, val) != nullptr);
+    } else if constexpr (std::is_same_v<T, const char *>) {
+        configASSERT(cJSON_AddStringToObject(data(), key, val) != nullptr);
+    } else if constexpr (std::is_same_v<T, char *>) {
+        configASSERT(cJSON_AddStringToObject(data(), key, val) != nullptr);
+    } else if constexpr (std::is_same_v<T, cJSON *>) {
+        cJSON_AddItemToObject(data(), key, val);
+    } else if constexpr (HasCStr_v<T>) {
+        configASSERT(cJSON_AddStringToObject(data(), key, val.c_str()) != nullptr);
+    } else if constexpr (is_json_optional<T>::value) {
+        AddValueOrNull(key, val);
+    } else if constexpr (hasValue_v<T>) {
+        configASSERT(cJSON_AddNumberToObject(data(), key, val.value()) != nullptr);
+    } else if constexpr (hasToJson_v<T>) {
+        AddVal(key, val.ToJson().take().release());
+    } else if constexpr (std::is_same_v<T, BaoJson>) {
+        AddVal(key, val.take().release());
+    } else {
+        static_assert(always_false<T>, "Could not deduce type");
+    }
+}
+
+template <typename T>
+void BaoJsonRef::AddVal(StaticKey key, T val) const {
+    static_assert(is_json_serializable_v<T>, "type is not json serializable");
+
+    // build the value node alone, then attach it with the key as a constant string
+    cJSON *item = BaoJson{ std::move(val) }.take().release();
+    configASSERT(cJSON_AddItemToObjectCS(data(), key.c_str(), item) == true);
+}
+
+template <typename... Ts>
+void BaoJsonRef::AddVals(Ts... vals) const {
+    static_assert((is_valid_key_value_v<Ts> && ...), "invalid key value");
+    (addKeyValue(std::move(vals)), ...);
+}
+
+template <typename T>
+void BaoJsonRef::addKeyValue(KV<T> kv) const {
+    if (kv.m_isStaticKey)
+        AddVal(StaticKey::Unchecked(kv.m_key), std::move(kv.m_val));
+    else
+        AddVal(kv.m_key, std::move(kv.m_val));
+}
+
+template <typename T>
+void BaoJsonRef::AddValueOrNull(const char *key, std::optional<T> optionalVal) const {
+    static_assert(is_json_deserializable_v<T>, "Type is not JSON deserializable");
+
+    if (!optionalVal.has_value()) {
+        configASSERT(cJSON_AddNullToObject(data(), key) != nullptr);
+    } else {
+        AddVal(key, optionalVal.value());
+    }
+}
+
+template <typename T>
+void BaoJsonRef::AddValueOrDefault(const char *key, std::optional<T> optionalVal, T defaultVal) const {
+    static_assert(is_json_deserializable_v<T>, "Type is not JSON deserializable");
+
+    if (!optionalVal.has_value()) {
+        AddVal(key, defaultVal);
+    } else {
+        AddVal(key, optionalVal.value());
+    }
+}
+
+template <typename T>
+void BaoJsonRef::AddValToArray(T val) const {
+    configASSERT(cJSON_IsArray(m_json));
+
+    auto item = BaoJson(val);
+    configASSERT(cJSON_AddItemToArray(data(), item.take().release()) == true);
+}
+
+template <typename T>
+void BaoJsonRef::AppendNumbers(std::span<const T> values) const {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "only numbers can be appended in bulk");
+    configASSERT(cJSON_IsArray(m_json));
+
+    if (values.empty())
+        return;
+
+    // link the new nodes to each other first, then splice the whole chain after the tail in one step
+    cJSON *head = nullptr;
+    cJSON *tail = nullptr;
+    for (T value : values) {
+        cJSON *item = nullptr;
+        if constexpr (std::is_same_v<T, float>)
+            item = cJSON_CreateNumber(FloatToShortestDouble(value));
+        else
+            item = cJSON_CreateNumber(value);
+        configASSERT(item != nullptr);
+
+        if (head == nullptr) {
+            head = item;
+        } else {
+            tail->next = item;
+            item->prev = tail;
+        }
+        tail = item;
+    }
+
+    spliceToArray(head, tail);
+}
+
+template <typename... Ts>
+void BaoJsonRef::AddValsToArray(Ts &&...vals) const {
+    (AddValToArray(std::forward<Ts>(vals)), ...);
+}
+
+// //AddVals from iterators
+template <class InputIt, typename>
+void BaoJsonRef::AddValsToArray(InputIt begin, InputIt end) const {
+    for (auto it = begin; it != end; ++it) {
+        AddValToArray(*it);
+    }
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_REF_INL_H__
@@ -0,0 +1,109 @@
+#ifndef UTIL_BAOZI_JSON_TEMPLATE_H__
+#define UTIL_BAOZI_JSON_TEMPLATE_H__
+
+#include <cstddef>
+#include <cstring>
+#include "freertos/FreeRTOS.h"
+#include "baozi_json_format.h"
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+/*
+    helper trait to check if a type can be rendered by BaoJsonTemplate (numbers, booleans and units with value())
+*/
+template <typename T>
+inline constexpr bool is_json_template_value_v = std::is_arithmetic_v<T> || (hasValue_v<T> && !is_json_optional<T>::value);
+
+/*
+    BaoJsonTemplate pre-renders a single key json object at compile time, so only the value is formatted at runtime.
+    N is the capacity of the rendered prefix ({"key":), a key that does not fit fails compilation when the template is constexpr.
+
+    example:
+        static constexpr BaoJsonTemplate<32> TEMPERATURE{"temperature"}; // {"temperature": is built at compile time
+
+        char payload[64];
+        TEMPERATURE.Render(payload, sizeof(payload), 21.5); // payload = {"temperature":21.5}
+*/
+template <size_t N>
+class BaoJsonTemplate
+{
+    public:
+    constexpr explicit BaoJsonTemplate(const char *key) {
+        append('{');
+        append('"');
+        for (const char *c = key; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\')
+                append('\\');
+            else if (static_cast<unsigned char>(*c) < 0x20)
+                s_invalidKey();
+
+            append(*c);
+        }
+        append('"');
+        append(':');
+    }
+
+    /**
+     * @brief render the template with the given value into buffer
+     *
+     * @param buffer - the buffer to render into, NUL terminated on success
+     * @param size - size of the buffer, must fit the prefix and the longest number (JSON_NUMBER_BUFFER_SIZE + 1)
+     * @param value - a number, boolean or unit with value()
+     * @param precision - decimals to round floating point values to, JSON_PRECISION_SHORTEST for the shortest round trip form
+     * @return size_t length of the rendered json, 0 if the buffer is too small
+     */
+    template <typename T>
+    size_t Render(char *buffer, size_t size, T value, int8_t precision = JSON_PRECISION_SHORTEST) const {
+        static_assert(is_json_template_value_v<T>, "type can not be rendered by a json template");
+
+        if (size < m_length + JSON_NUMBER_BUFFER_SIZE + 1)
+            return 0;
+
+        memcpy(buffer, m_prefix, m_length);
+        size_t length = m_length + renderValue(buffer + m_length, value, precision);
+        buffer[length++] = '}';
+        buffer[length] = '\0';
+
+        return length;
+    }
+
+    private:
+    char m_prefix[N]{};
+    size_t m_length{};
+
+    constexpr void append(char c) {
+        if (m_length >= N) {
+            s_invalidKey();
+            return;
+        }
+
+        m_prefix[m_length++] = c;
+    }
+
+    template <typename T>
+    static size_t renderValue(char *out, T value, int8_t precision) {
+        if constexpr (std::is_same_v<T, bool>) {
+            memcpy(out, value ? "true" : "false", value ? 4 : 5);
+            return value ? 4 : 5;
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            return FormatJsonInteger(value, out);
+        } else if constexpr (std::is_integral_v<T>) {
+            return FormatJsonUnsigned(value, out);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (precision != JSON_PRECISION_SHORTEST)
+                return FormatJsonFixed(value, precision, out);
+
+            return FormatJsonNumber(value, out);
+        } else {
+            return renderValue(out, value.value(), precision);
+        }
+    }
+
+    // not constexpr on purpose - reaching it while rendering at compile time fails the build
+    static void s_invalidKey() { configASSERT(false); }
+};
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_TEMPLATE_H__
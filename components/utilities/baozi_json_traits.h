@@ -57,6 +57,17 @@ namespace Baozi
     template <typename T>
     inline constexpr bool hasToJson_v = HasToJson<T>::value;
 
+    // =================== HAS JSON FIELDS =================
+
+    /*
+        helper trait to check if a type declares its json fields with BAOZI_JSON_FIELDS (see baozi_json_fields.h)
+    */
+    template <class T>
+    using has_json_fields = decltype(T::JsonFields());
+
+    template <typename T>
+    inline constexpr bool hasJsonFields_v = std::experimental::is_detected_v<has_json_fields, T>;
+
     // =================== IS JSON DESERIALIZABLE =================
 
     /*
@@ -123,13 +134,49 @@ namespace Baozi
                      KV{"optional with null", std::optional<int>(std::nullopt)},
                      KV{"boolean", true}};
     */
+    /*
+        StaticKey marks a key with static storage duration (a string literal or a static constexpr string).
+        Such keys are attached to cJSON nodes as constant strings (cJSON_AddItemToObjectCS), so they are never
+        duplicated on add nor freed on delete.
+        The constructor is consteval - passing a runtime pointer fails compilation, use StaticKey::Unchecked()
+        for runtime pointers that are known to point to static strings.
+            example:
+                  json.AddVal("name"_key, m_name);
+                  json.AddVals(KV{"name"_key, m_name}, KV{StaticKey{s_state_name}, state});
+    */
+    class StaticKey
+    {
+    public:
+        consteval StaticKey(const char *key) : m_key(key) {}
+
+        static constexpr StaticKey Unchecked(const char *key) { return StaticKey{key, unchecked_t{}}; }
+
+        constexpr const char *c_str() const { return m_key; }
+
+    private:
+        struct unchecked_t
+        {
+        };
+
+        constexpr StaticKey(const char *key, unchecked_t) : m_key(key) {}
+
+        const char *m_key;
+    };
+
+    consteval StaticKey operator""_key(const char *key, size_t)
+    {
+        return StaticKey{key};
+    }
+
     template <typename T>
     struct KV
     {
         KV(const char *key, T value) : m_key(key), m_val(value) {}
+        KV(StaticKey key, T value) : m_key(key.c_str()), m_val(value), m_isStaticKey(true) {}
 
         const char *m_key;
         T m_val;
+        bool m_isStaticKey{false};
     };
 
     /*
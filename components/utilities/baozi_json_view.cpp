@@ -0,0 +1,455 @@
+#include "baozi_json_view.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace Baozi {
+
+using eType = BaoJsonToken::eType;
+using eStatus = BaoJsonParser::eStatus;
+
+static constexpr size_t MAX_NUMBER_LENGTH = 64;
+
+static bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool isDelimiter(char c) {
+    return isWhitespace(c) || c == ',' || c == ']' || c == '}' || c == ':';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int hexValue(char c) {
+    if (isDigit(c))
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool isNumber(const char *begin, const char *end) {
+    const char *p = begin;
+    if (p < end && *p == '-')
+        p++;
+
+    if (p == end || !isDigit(*p))
+        return false;
+    if (*p++ == '0' && p < end && isDigit(*p))
+        return false;
+    while (p < end && isDigit(*p))
+        p++;
+
+    if (p < end && *p == '.') {
+        if (++p == end || !isDigit(*p))
+            return false;
+        while (p < end && isDigit(*p))
+            p++;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        if (++p < end && (*p == '+' || *p == '-'))
+            p++;
+        if (p == end || !isDigit(*p))
+            return false;
+        while (p < end && isDigit(*p))
+            p++;
+    }
+
+    return p == end;
+}
+
+static bool isLiteral(const char *begin, const char *end, const char *literal) {
+    size_t len = strlen(literal);
+    return static_cast<size_t>(end - begin) == len && memcmp(begin, literal, len) == 0;
+}
+
+static void appendUtf8(std::string &out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+static uint32_t readHex4(const char *p) {
+    return (hexValue(p[0]) << 12) | (hexValue(p[1]) << 8) | (hexValue(p[2]) << 4) | hexValue(p[3]);
+}
+
+// ================== PARSER ==================
+
+BaoJsonParser::BaoJsonParser(BaoJsonToken *tokens, size_t maxTokens) : m_tokens(tokens), m_maxTokens(maxTokens) {
+    configASSERT(m_tokens != nullptr);
+    configASSERT(m_maxTokens > 0 && m_maxTokens <= UINT16_MAX);
+}
+
+void BaoJsonParser::Reset() {
+    m_pos = 0;
+    m_next = 0;
+    m_super = -1;
+    m_depth = 0;
+    m_expect = eExpect::VALUE;
+}
+
+BaoJsonView BaoJsonParser::View(const char *json) const {
+    configASSERT(m_expect == eExpect::DONE);
+    return BaoJsonView{ json, m_tokens };
+}
+
+eStatus BaoJsonParser::Parse(const char *json, size_t length, bool isFinal) {
+    for (; m_pos < length; m_pos++) {
+        char c = json[m_pos];
+        eStatus status = eStatus::COMPLETE;
+
+        if (isWhitespace(c))
+            continue;
+
+        if (m_expect == eExpect::DONE)
+            return eStatus::INVALID;
+
+        switch (c) {
+        case '{':
+        case '[':
+            status = openContainer(c == '{' ? eType::OBJECT : eType::ARRAY);
+            break;
+        case '}':
+        case ']':
+            status = closeContainer(c == '}' ? eType::OBJECT : eType::ARRAY);
+            break;
+        case '"':
+            status = parseString(json, length);
+            break;
+        case ':':
+            if (m_expect != eExpect::COLON)
+                return eStatus::INVALID;
+            m_expect = eExpect::VALUE;
+            break;
+        case ',':
+            if (m_expect != eExpect::COMMA_OR_END)
+                return eStatus::INVALID;
+            m_expect = m_tokens[m_super].type == eType::OBJECT ? eExpect::KEY : eExpect::VALUE;
+            break;
+        default:
+            status = parsePrimitive(json, length, isFinal);
+            break;
+        }
+
+        if (status == eStatus::PARTIAL)
+            return isFinal ? eStatus::INVALID : eStatus::PARTIAL;
+
+        if (status != eStatus::COMPLETE)
+            return status;
+    }
+
+    if (m_expect == eExpect::DONE)
+        return eStatus::COMPLETE;
+
+    return isFinal ? eStatus::INVALID : eStatus::PARTIAL;
+}
+
+BaoJsonToken *BaoJsonParser::allocToken(eType type, size_t start) {
+    if (m_next >= m_maxTokens)
+        return nullptr;
+
+    BaoJsonToken *token = &m_tokens[m_next++];
+    *token = { type, static_cast<int32_t>(start), -1, 0, 1 };
+    return token;
+}
+
+bool BaoJsonParser::isExpectingValue() const {
+    return m_expect == eExpect::VALUE || m_expect == eExpect::VALUE_OR_END;
+}
+
+bool BaoJsonParser::isExpectingKey() const {
+    return m_expect == eExpect::KEY || m_expect == eExpect::KEY_OR_END;
+}
+
+// a value was added to the current container (or is the whole json)
+void BaoJsonParser::valueAdded() {
+    if (m_depth == 0) {
+        m_expect = eExpect::DONE;
+        return;
+    }
+
+    if (m_tokens[m_super].type == eType::ARRAY)
+        m_tokens[m_super].size++;
+
+    m_expect = eExpect::COMMA_OR_END;
+}
+
+eStatus BaoJsonParser::openContainer(eType type) {
+    if (!isExpectingValue())
+        return eStatus::INVALID;
+
+    if (allocToken(type, m_pos) == nullptr)
+        return eStatus::NO_MEMORY;
+
+    m_super = static_cast<int>(m_next) - 1;
+    m_depth++;
+    m_expect = type == eType::OBJECT ? eExpect::KEY_OR_END : eExpect::VALUE_OR_END;
+    return eStatus::COMPLETE;
+}
+
+eStatus BaoJsonParser::closeContainer(eType type) {
+    if (m_super < 0 || m_tokens[m_super].type != type)
+        return eStatus::INVALID;
+
+    bool canClose = m_expect == eExpect::COMMA_OR_END ||
+                    (type == eType::OBJECT ? m_expect == eExpect::KEY_OR_END : m_expect == eExpect::VALUE_OR_END);
+    if (!canClose)
+        return eStatus::INVALID;
+
+    BaoJsonToken &container = m_tokens[m_super];
+    container.end = static_cast<int32_t>(m_pos) + 1;
+    container.skip = static_cast<uint16_t>(m_next - m_super);
+
+    // the enclosing container is the closest one still open
+    int super = m_super - 1;
+    while (super >= 0 && m_tokens[super].end != -1)
+        super--;
+
+    m_super = super;
+    m_depth--;
+    valueAdded();
+    return eStatus::COMPLETE;
+}
+
+eStatus BaoJsonParser::parseString(const char *json, size_t length) {
+    bool isKey = isExpectingKey();
+    if (!isKey && !isExpectingValue())
+        return eStatus::INVALID;
+
+    size_t start = m_pos;
+    for (size_t pos = start + 1; pos < length; pos++) {
+        unsigned char c = static_cast<unsigned char>(json[pos]);
+
+        if (c == '"') {
+            BaoJsonToken *token = allocToken(eType::STRING, start + 1);
+            if (token == nullptr)
+                return eStatus::NO_MEMORY;
+
+            token->end = static_cast<int32_t>(pos);
+            m_pos = pos;
+
+            if (isKey) {
+                m_tokens[m_super].size++;
+                m_expect = eExpect::COLON;
+            } else {
+                valueAdded();
+            }
+            return eStatus::COMPLETE;
+        }
+
+        if (c < 0x20)
+            return eStatus::INVALID;
+
+        if (c != '\\')
+            continue;
+
+        if (++pos >= length)
+            break;
+
+        switch (json[pos]) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't': break;
+        case 'u':
+            for (int i = 0; i < 4; i++) {
+                if (++pos >= length)
+                    return eStatus::PARTIAL;
+                if (hexValue(json[pos]) < 0)
+                    return eStatus::INVALID;
+            }
+            break;
+        default: return eStatus::INVALID;
+        }
+    }
+
+    // the string is cut, it will be parsed again from its opening quote
+    m_pos = start;
+    return eStatus::PARTIAL;
+}
+
+eStatus BaoJsonParser::parsePrimitive(const char *json, size_t length, bool isFinal) {
+    if (!isExpectingValue())
+        return eStatus::INVALID;
+
+    size_t start = m_pos;
+    size_t pos = start;
+    while (pos < length && !isDelimiter(json[pos]))
+        pos++;
+
+    // a number at the end of the text might continue in the next chunk
+    if (pos == length && !isFinal)
+        return eStatus::PARTIAL;
+
+    const char *begin = json + start;
+    const char *end = json + pos;
+    if (!isLiteral(begin, end, "true") && !isLiteral(begin, end, "false") && !isLiteral(begin, end, "null") && !isNumber(begin, end))
+        return eStatus::INVALID;
+
+    BaoJsonToken *token = allocToken(eType::PRIMITIVE, start);
+    if (token == nullptr)
+        return eStatus::NO_MEMORY;
+
+    token->end = static_cast<int32_t>(pos);
+    m_pos = pos - 1;
+    valueAdded();
+    return eStatus::COMPLETE;
+}
+
+// ================== VIEW ==================
+
+BaoJsonView::BaoJsonView(const char *json, const BaoJsonToken *tokens, size_t index) : m_json(json), m_tokens(tokens), m_index(index) {
+    configASSERT(m_json != nullptr);
+    configASSERT(m_tokens != nullptr);
+}
+
+std::optional<BaoJsonView> BaoJsonView::Parse(const char *json, size_t length, BaoJsonToken *tokens, size_t maxTokens) {
+    BaoJsonParser parser{ tokens, maxTokens };
+    if (parser.Parse(json, length) != BaoJsonParser::eStatus::COMPLETE)
+        return std::nullopt;
+
+    return parser.View(json);
+}
+
+bool BaoJsonView::IsObject() const {
+    return m_tokens != nullptr && token().type == eType::OBJECT;
+}
+
+bool BaoJsonView::IsArray() const {
+    return m_tokens != nullptr && token().type == eType::ARRAY;
+}
+
+bool BaoJsonView::IsNull() const {
+    return m_tokens != nullptr && token().type == eType::PRIMITIVE && Raw() == "null";
+}
+
+bool BaoJsonView::IsEmpty() const {
+    return m_tokens == nullptr || ((IsObject() || IsArray()) && token().size == 0);
+}
+
+std::string_view BaoJsonView::Raw() const {
+    if (m_tokens == nullptr)
+        return m_raw;
+
+    return std::string_view{ m_json + token().start, static_cast<size_t>(token().end - token().start) };
+}
+
+bool BaoJsonView::HasItem(const char *key) const {
+    return findItem(key).has_value();
+}
+
+int BaoJsonView::ArraySize() const {
+    configASSERT(IsArray());
+    return token().size;
+}
+
+std::optional<size_t> BaoJsonView::findItem(const char *key) const {
+    configASSERT(key != nullptr);
+
+    if (!IsObject())
+        return std::nullopt;
+
+    std::string_view wanted{ key };
+    size_t index = m_index + 1;
+    for (uint16_t i = 0; i < token().size; i++) {
+        size_t value = index + 1;
+        if (BaoJsonView{ m_json, m_tokens, index }.Raw() == wanted)
+            return value;
+
+        index = value + m_tokens[value].skip;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<double> BaoJsonView::getNumber() const {
+    if (token().type != eType::PRIMITIVE)
+        return std::nullopt;
+
+    std::string_view raw = Raw();
+    if (raw.empty() || !(raw[0] == '-' || isDigit(raw[0])) || raw.size() >= MAX_NUMBER_LENGTH)
+        return std::nullopt;
+
+    // the text is not NUL terminated, strtod needs a terminated copy
+    char number[MAX_NUMBER_LENGTH];
+    memcpy(number, raw.data(), raw.size());
+    number[raw.size()] = '\0';
+    return strtod(number, nullptr);
+}
+
+std::optional<bool> BaoJsonView::getBool() const {
+    if (token().type != eType::PRIMITIVE)
+        return std::nullopt;
+
+    std::string_view raw = Raw();
+    if (raw == "true")
+        return true;
+    if (raw == "false")
+        return false;
+
+    return std::nullopt;
+}
+
+std::string BaoJsonView::unescape() const {
+    std::string_view raw = Raw();
+    std::string out;
+    out.reserve(raw.size());
+
+    for (size_t i = 0; i < raw.size(); i++) {
+        if (raw[i] != '\\') {
+            out += raw[i];
+            continue;
+        }
+
+        // escapes were validated by the parser
+        switch (raw[++i]) {
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t codepoint = readHex4(&raw[i + 1]);
+            i += 4;
+
+            bool isHighSurrogate = codepoint >= 0xD800 && codepoint <= 0xDBFF;
+            if (isHighSurrogate && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                uint32_t low = readHex4(&raw[i + 3]);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+
+            appendUtf8(out, codepoint);
+            break;
+        }
+        default: out += raw[i]; break;
+        }
+    }
+
+    return out;
+}
+
+}   // namespace Baozi
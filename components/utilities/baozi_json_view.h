@@ -0,0 +1,233 @@
+#ifndef UTIL_BAOZI_JSON_VIEW_H__
+#define UTIL_BAOZI_JSON_VIEW_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "freertos/FreeRTOS.h"
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+class BaoJsonView;
+
+/*
+    A token of a tokenized json text - an object, array, string or primitive (number, true, false, null).
+    start/end are offsets into the json text (strings exclude their quotes),
+    size is the number of direct children (keys for objects, items for arrays)
+    and skip is the number of tokens in the subtree including this one, so the next sibling is at index + skip.
+*/
+struct BaoJsonToken
+{
+    enum class eType : uint8_t
+    {
+        UNDEFINED,
+        OBJECT,
+        ARRAY,
+        STRING,
+        PRIMITIVE,
+    };
+
+    eType type;
+    int32_t start;
+    int32_t end;
+    uint16_t size;
+    uint16_t skip;
+};
+
+/*
+    BaoJsonParser tokenizes json text in place into a fixed, caller supplied token array (jsmn style).
+    It never allocates and never copies the text.
+
+    Parsing can be resumed - if Parse() returns PARTIAL, call it again with the same text extended by the next chunk,
+    and parsing continues from where it stopped.
+*/
+class BaoJsonParser
+{
+    public:
+    enum class eStatus
+    {
+        COMPLETE,    // a whole json value was tokenized
+        PARTIAL,     // the text ended in the middle of a value, feed more text
+        NO_MEMORY,   // not enough tokens
+        INVALID,     // not json
+    };
+
+    BaoJsonParser(BaoJsonToken *tokens, size_t maxTokens);
+
+    template <size_t N>
+    explicit BaoJsonParser(std::array<BaoJsonToken, N> &tokens) : BaoJsonParser(tokens.data(), N) {}
+
+    /**
+     * @brief tokenize json text, continuing from the last call
+     *
+     * @param json - the json text, does not have to be NUL terminated
+     * @param length - length of the text available so far
+     * @param isFinal - false if more text may follow (a number at the end of the text might be cut)
+     * @return eStatus
+     */
+    eStatus Parse(const char *json, size_t length, bool isFinal = true);
+
+    /**
+     * @brief return a view over the tokenized json, only valid after Parse() returned COMPLETE
+     */
+    BaoJsonView View(const char *json) const;
+
+    size_t TokenCount() const { return m_next; }
+
+    void Reset();
+
+    private:
+    enum class eExpect : uint8_t
+    {
+        VALUE,
+        VALUE_OR_END,   // first item of an array
+        KEY,
+        KEY_OR_END,   // first key of an object
+        COLON,
+        COMMA_OR_END,
+        DONE,   // the top level value is complete
+    };
+
+    BaoJsonToken *m_tokens;
+    size_t m_maxTokens;
+    size_t m_pos{};
+    size_t m_next{};
+    int m_super{ -1 };   // innermost open container
+    int m_depth{};
+    eExpect m_expect{ eExpect::VALUE };
+
+    BaoJsonToken *allocToken(BaoJsonToken::eType type, size_t start);
+    bool isExpectingValue() const;
+    bool isExpectingKey() const;
+    void valueAdded();
+
+    eStatus openContainer(BaoJsonToken::eType type);
+    eStatus closeContainer(BaoJsonToken::eType type);
+    eStatus parseString(const char *json, size_t length);
+    eStatus parsePrimitive(const char *json, size_t length, bool isFinal);
+};
+
+/*
+    BaoJsonView is a read only, non allocating view over tokenized json text.
+    It offers the same reading API as BaoJson (GetVal<T>, HasItem, ArrayForEach...), and nested objects/arrays are
+    returned as views into the same tokens.
+    The text and the tokens must outlive the view.
+
+    NOTICE - Strings are not NUL terminated, read them as std::string_view (raw, escapes are kept)
+             or as std::string (unescaped, allocates)
+    NOTICE - Key lookup is case sensitive and compares the raw key text
+
+    example:
+        std::array<BaoJsonToken, 32> tokens;
+        auto json = BaoJsonView::Parse(data, dataLen, tokens);
+        if (json && json->HasItem("brightness"))
+            setBrightness(json->GetVal<int>("brightness").value());
+
+        if (auto effects = json->GetVal<BaoJsonView>("effects"))
+            effects->ArrayForEach<std::string_view>([](std::string_view effect) { ... });
+*/
+class BaoJsonView
+{
+    public:
+    // an empty view, holding no json
+    BaoJsonView() = default;
+
+    // a view over text that could not be tokenized, it only gives access to Raw()
+    explicit BaoJsonView(std::string_view raw) : m_raw(raw) {}
+
+    BaoJsonView(const char *json, const BaoJsonToken *tokens, size_t index = 0);
+
+    /**
+     * @brief tokenize a complete json text into tokens and return a view over it
+     *
+     * @return std::optional<BaoJsonView> the view if the text is valid json and the tokens sufficed, std::nullopt otherwise
+     */
+    static std::optional<BaoJsonView> Parse(const char *json, size_t length, BaoJsonToken *tokens, size_t maxTokens);
+
+    template <size_t N>
+    static std::optional<BaoJsonView> Parse(std::string_view json, std::array<BaoJsonToken, N> &tokens) {
+        return Parse(json.data(), json.size(), tokens.data(), N);
+    }
+
+    /**
+     * @brief return true if the view holds tokenized json
+     */
+    operator bool() const { return m_tokens != nullptr; }
+
+    bool IsObject() const;
+    bool IsArray() const;
+    bool IsNull() const;
+
+    /**
+     * @brief return true if the view is an empty object/array or holds no json
+     */
+    bool IsEmpty() const;
+
+    /**
+     * @brief return the raw text of the viewed value (strings without their quotes)
+     */
+    std::string_view Raw() const;
+
+    bool HasItem(const char *key) const;
+
+    template <typename... Ts>
+    bool HasEitherItems(Ts... keys) const {
+        return (HasItem(keys) || ...);
+    }
+
+    template <typename... Ts>
+    bool HasAllItems(Ts... keys) const {
+        return (HasItem(keys) && ...);
+    }
+
+    /**
+     * @brief Get a value from the json object by key, see BaoJson::GetVal
+     * @brief NOTICE - supported types are bool, numbers, units with value(), std::string_view, std::string and BaoJsonView
+     */
+    template <typename T>
+    std::optional<T> GetVal(const char *key) const;
+
+    template <typename T>
+    std::optional<T> GetVal() const;
+
+    /**
+     * @brief Performs a function for each item of type T in the array, see BaoJson::ArrayForEach
+     */
+    template <typename T, typename F>
+    void ArrayForEach(F &&func) const;
+
+    int ArraySize() const;
+
+    /**
+     * @brief Performs a function for each key-value of the object, in one pass over the tokens
+     *
+     * @tparam F a functor or a function that takes (std::string_view key, const BaoJsonView &value)
+     * @param func the function to perform
+     */
+    template <typename F>
+    void ObjectForEach(F &&func) const;
+
+    private:
+    friend class BaoJsonPath;
+
+    std::string_view m_raw{};
+    const char *m_json{};
+    const BaoJsonToken *m_tokens{};
+    size_t m_index{};
+
+    const BaoJsonToken &token() const { return m_tokens[m_index]; }
+    std::optional<size_t> findItem(const char *key) const;
+    std::optional<double> getNumber() const;
+    std::optional<bool> getBool() const;
+    std::string unescape() const;
+};
+
+}   // namespace Baozi
+
+#include "baozi_json_view_inl.hpp"
+
+#endif   // UTIL_BAOZI_JSON_VIEW_H__
@@ -0,0 +1,94 @@
+#ifndef UTIL_BAOZI_JSON_VIEW_INL_H__
+#define UTIL_BAOZI_JSON_VIEW_INL_H__
+
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+/*
+    helper trait to check if a type can be read from a BaoJsonView
+*/
+template <typename T>
+inline constexpr bool is_json_view_readable_v = std::is_arithmetic_v<T> || hasValue_v<T> || HasCStr_v<T> ||
+                                                std::is_same_v<T, std::string_view> || std::is_same_v<T, BaoJsonView>;
+
+template <typename T>
+std::optional<T> BaoJsonView::GetVal(const char *key) const {
+    static_assert(!std::is_same_v<T, const char *>, "view strings are not NUL terminated, use std::string_view or std::string");
+    static_assert(is_json_view_readable_v<T>, "Type can not be read from a json view");
+
+    auto index = findItem(key);
+    if (!index.has_value())
+        return std::nullopt;
+
+    return BaoJsonView{ m_json, m_tokens, index.value() }.GetVal<T>();
+}
+
+template <typename T>
+std::optional<T> BaoJsonView::GetVal() const {
+    static_assert(!std::is_same_v<T, const char *>, "view strings are not NUL terminated, use std::string_view or std::string");
+    static_assert(is_json_view_readable_v<T>, "Type can not be read from a json view");
+
+    if (m_tokens == nullptr)
+        return std::nullopt;
+
+    if constexpr (std::is_same_v<T, bool>) {
+        return getBool();
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        auto number = getNumber();
+        return number.has_value() ? std::optional{ static_cast<T>(number.value()) } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        return token().type == BaoJsonToken::eType::STRING ? std::optional{ Raw() } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, BaoJsonView>) {
+        return (IsObject() || IsArray()) ? std::optional{ *this } : std::nullopt;
+    } else if constexpr (hasValue_v<T>) {
+        auto number = getNumber();
+        return number.has_value() ? std::optional{ T(number.value()) } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return token().type == BaoJsonToken::eType::STRING ? std::optional{ unescape() } : std::nullopt;
+    } else {
+        return token().type == BaoJsonToken::eType::STRING ? std::optional{ T{ unescape().c_str() } } : std::nullopt;
+    }
+}
+
+template <typename T, typename F>
+void BaoJsonView::ArrayForEach(F &&func) const {
+    static_assert(is_json_view_readable_v<T>, "Type can not be read from a json view");
+
+    if (m_tokens == nullptr)
+        return;
+
+    configASSERT(IsArray());
+
+    size_t index = m_index + 1;
+    for (uint16_t i = 0; i < token().size; i++) {
+        BaoJsonView item{ m_json, m_tokens, index };
+        index += m_tokens[index].skip;
+
+        if constexpr (std::is_same_v<T, BaoJsonView>) {
+            if (item.IsObject())
+                func(item);
+        } else {
+            auto value = item.GetVal<T>();
+            if (value.has_value())
+                func(value.value());
+        }
+    }
+}
+
+template <typename F>
+void BaoJsonView::ObjectForEach(F &&func) const {
+    if (!IsObject())
+        return;
+
+    size_t index = m_index + 1;
+    for (uint16_t i = 0; i < token().size; i++) {
+        size_t value = index + 1;
+        func(BaoJsonView{ m_json, m_tokens, index }.Raw(), BaoJsonView{ m_json, m_tokens, value });
+        index = value + m_tokens[value].skip;
+    }
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_VIEW_INL_H__
@@ -0,0 +1,156 @@
+#include "baozi_json_writer.h"
+#include "baozi_json_format.h"
+#include <cstring>
+
+namespace Baozi {
+
+BaoJsonWriter::BaoJsonWriter(char *buffer, size_t size) : m_buffer(buffer), m_size(size) {
+    configASSERT(m_buffer != nullptr);
+    configASSERT(m_size >= sizeof("{}"));
+
+    Reset();
+}
+
+void BaoJsonWriter::Reset() {
+    m_buffer[0] = '{';
+    m_length = 1;
+    m_isEmpty = true;
+    m_overflow = false;
+    close();
+}
+
+// ================== MEMBERS ==================
+
+void BaoJsonWriter::beginMember(const char *key) {
+    configASSERT(key != nullptr);
+
+    if (!m_isEmpty)
+        writeRaw(",", 1);
+
+    writeString(key);
+    writeRaw(":", 1);
+}
+
+void BaoJsonWriter::endMember(size_t rollback) {
+    if (m_overflow)
+        m_length = rollback;
+    else
+        m_isEmpty = false;
+
+    close();
+}
+
+// ================== VALUES ==================
+
+void BaoJsonWriter::writeRaw(const char *str, size_t len) {
+    if (m_overflow || len > capacity()) {
+        m_overflow = true;
+        return;
+    }
+
+    memcpy(m_buffer + m_length, str, len);
+    m_length += len;
+}
+
+void BaoJsonWriter::writeString(const char *str) {
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    if (str == nullptr) {
+        writeNull();
+        return;
+    }
+
+    writeRaw("\"", 1);
+
+    const char *run = str;
+    for (const char *c = str; *c != '\0'; c++) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch >= 0x20 && ch != '"' && ch != '\\')
+            continue;
+
+        writeRaw(run, c - run);
+        run = c + 1;
+
+        switch (ch) {
+        case '"': writeRaw("\\\"", 2); break;
+        case '\\': writeRaw("\\\\", 2); break;
+        case '\b': writeRaw("\\b", 2); break;
+        case '\f': writeRaw("\\f", 2); break;
+        case '\n': writeRaw("\\n", 2); break;
+        case '\r': writeRaw("\\r", 2); break;
+        case '\t': writeRaw("\\t", 2); break;
+        default: {
+            char escaped[] = { '\\', 'u', '0', '0', HEX[ch >> 4], HEX[ch & 0xF] };
+            writeRaw(escaped, sizeof(escaped));
+            break;
+        }
+        }
+    }
+
+    writeRaw(run, strlen(run));
+    writeRaw("\"", 1);
+}
+
+void BaoJsonWriter::writeInteger(long long val) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    writeRaw(number, FormatJsonInteger(val, number));
+}
+
+void BaoJsonWriter::writeUnsigned(unsigned long long val) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    writeRaw(number, FormatJsonUnsigned(val, number));
+}
+
+void BaoJsonWriter::writeNumber(double val) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    writeRaw(number, FormatJsonNumber(val, number));
+}
+
+void BaoJsonWriter::writeNumber(float val) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    writeRaw(number, FormatJsonNumber(val, number));
+}
+
+void BaoJsonWriter::writeBool(bool val) {
+    if (val)
+        writeRaw("true", 4);
+    else
+        writeRaw("false", 5);
+}
+
+void BaoJsonWriter::writeNull() {
+    writeRaw("null", 4);
+}
+
+void BaoJsonWriter::writeJson(const cJSON *json) {
+    if (json == nullptr) {
+        writeNull();
+        return;
+    }
+
+    if (m_overflow)
+        return;
+
+    // cJSON writes its own NUL terminator, which must fit before our closing brace
+    // cJSON_PrintPreallocated does not modify the item, it is just not declared const
+    if (!cJSON_PrintPreallocated(const_cast<cJSON *>(json), m_buffer + m_length, capacity() + 1, false)) {
+        m_overflow = true;
+        return;
+    }
+
+    m_length += strlen(m_buffer + m_length);
+}
+
+// =====================================================================
+
+// free space for content, leaving room for the closing brace and the NUL terminator
+size_t BaoJsonWriter::capacity() const {
+    return m_size - m_length - 2;
+}
+
+void BaoJsonWriter::close() {
+    m_buffer[m_length] = '}';
+    m_buffer[m_length + 1] = '\0';
+}
+
+}   // namespace Baozi
@@ -0,0 +1,120 @@
+#ifndef UTIL_BAOZI_JSON_WRITER_H__
+#define UTIL_BAOZI_JSON_WRITER_H__
+
+#include <cstddef>
+#include "baozi_json.h"
+
+namespace Baozi {
+
+/*
+    BaoJsonWriter serializes key-values straight into a caller supplied buffer.
+    It accepts the same KV{} packs and json serializable types as BaoJson (see baozi_json_traits.h),
+    but never creates cJSON nodes and never touches the heap for plain values.
+    Numbers are written in their shortest round trip form (see baozi_json_format.h).
+
+    The buffer always holds a valid, NUL terminated json object, so it can be published at any point.
+    If a value does not fit, it is dropped, the object is left as it was and the writer becomes invalid.
+
+    example:
+        char buffer[64];
+        BaoJsonWriter json{buffer};
+        json.AddVals(KV{"temperature", 21.5}, KV{"unit", "C"});
+        printf("%s", json.c_str()); // prints {"temperature":21.5,"unit":"C"}
+*/
+class BaoJsonWriter
+{
+    public:
+    BaoJsonWriter(char *buffer, size_t size);
+
+    template <size_t N>
+    explicit BaoJsonWriter(char (&buffer)[N]) : BaoJsonWriter(buffer, N) {}
+
+    BaoJsonWriter(const BaoJsonWriter &rhs) = delete;
+    BaoJsonWriter &operator=(const BaoJsonWriter &rhs) = delete;
+
+    /**
+     * @brief Writes a value of any json serializable type to the json object
+     * @brief NOTICE - BaoJson values, ToJson() types and cJSON* are printed with cJSON into the remaining buffer
+     * @brief NOTICE - cJSON* values are owned by the writer (like in BaoJson::AddVal) and are deleted after printing
+     *
+     * @param key - key to add
+     * @param val - val to add of any json serializable type
+     */
+    template <typename T>
+    void AddVal(const char *key, T val);
+
+    /**
+     * @brief Writes values to the json object
+     * @brief NOTICE - Every property must be a KV struct of a const char* key and a json serializable value
+     *
+     * @example
+     *         json.AddVals(KV{"int", 5}, KV{"const char*", "hello"}, KV{"boolean", true});
+     */
+    template <typename... Ts>
+    void AddVals(Ts... vals);
+
+    /**
+     * @brief Writes every field of a BAOZI_JSON_FIELDS struct as a member of the json object
+     * @brief NOTICE - see baozi_json_fields.h, nested BAOZI_JSON_FIELDS structs are written as nested objects
+     *
+     * @example
+     *         json.AddFields(config); // {"interval":5,"enabled":true}
+     */
+    template <typename T>
+    void AddFields(const T &val);
+
+    /**
+     * @brief return the serialized json object
+     */
+    const char *c_str() const { return m_buffer; }
+
+    /**
+     * @brief return the length of the serialized json object (without the NUL terminator)
+     */
+    size_t length() const { return m_length + 1; }
+
+    /**
+     * @brief return true if every value written so far fit in the buffer
+     */
+    operator bool() const { return !m_overflow; }
+
+    /**
+     * @brief clear the writer back to an empty json object
+     */
+    void Reset();
+
+    private:
+    char *m_buffer;
+    size_t m_size;
+    size_t m_length{}; // up to the closing brace, which is rewritten after every member
+    bool m_isEmpty{true};
+    bool m_overflow{false};
+
+    template <typename T>
+    void writeValue(const T &val);
+
+    template <typename T>
+    void writeFields(const T &val);
+
+    void beginMember(const char *key);
+    void endMember(size_t rollback);
+
+    void writeRaw(const char *str, size_t len);
+    void writeString(const char *str);
+    void writeInteger(long long val);
+    void writeUnsigned(unsigned long long val);
+    void writeNumber(double val);
+    void writeNumber(float val);
+    void writeBool(bool val);
+    void writeNull();
+    void writeJson(const cJSON *json);
+
+    size_t capacity() const;
+    void close();
+};
+
+}   // namespace Baozi
+
+#include "baozi_json_writer_inl.hpp"
+
+#endif   // UTIL_BAOZI_JSON_WRITER_H__
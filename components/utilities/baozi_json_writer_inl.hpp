@@ -0,0 +1,92 @@
+#ifndef UTIL_BAOZI_JSON_WRITER_INL_H__
+#define UTIL_BAOZI_JSON_WRITER_INL_H__
+
+#include <tuple>
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+template <typename T>
+void BaoJsonWriter::AddVal(const char *key, T val) {
+    static_assert(is_json_serializable_v<T>, "type is not json serializable");
+
+    if (m_overflow) {
+        if constexpr (std::is_same_v<T, cJSON *>)
+            cJSON_Delete(val);
+        return;
+    }
+
+    size_t rollback = m_length;
+    beginMember(key);
+    writeValue(val);
+    endMember(rollback);
+}
+
+template <typename... Ts>
+void BaoJsonWriter::AddVals(Ts... vals) {
+    static_assert((is_valid_key_value_v<Ts> && ...), "invalid key value");
+    (AddVal(vals.m_key, std::move(vals.m_val)), ...);
+}
+
+template <typename T>
+void BaoJsonWriter::AddFields(const T &val) {
+    static_assert(hasJsonFields_v<T>, "type does not declare BAOZI_JSON_FIELDS");
+
+    std::apply([&](const auto &...fields) { (AddVal(fields.key, val.*fields.member), ...); }, T::JsonFields());
+}
+
+// writes a nested object straight into the buffer, an overflow is rolled back by the enclosing member
+template <typename T>
+void BaoJsonWriter::writeFields(const T &val) {
+    bool wasEmpty = m_isEmpty;
+    m_isEmpty = true;
+    writeRaw("{", 1);
+
+    std::apply(
+        [&](const auto &...fields) {
+            ((beginMember(fields.key), writeValue(val.*fields.member), m_isEmpty = false), ...);
+        },
+        T::JsonFields());
+
+    writeRaw("}", 1);
+    m_isEmpty = wasEmpty;
+}
+
+template <typename T>
+void BaoJsonWriter::writeValue(const T &val) {
+    if constexpr (std::is_same_v<T, bool>) {
+        writeBool(val);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        writeInteger(val);
+    } else if constexpr (std::is_integral_v<T>) {
+        writeUnsigned(val);
+    } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        writeNumber(val);
+    } else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+        writeString(val);
+    } else if constexpr (std::is_same_v<T, cJSON *>) {
+        writeJson(val);
+        cJSON_Delete(val);
+    } else if constexpr (HasCStr_v<T>) {
+        writeString(val.c_str());
+    } else if constexpr (is_json_optional<T>::value) {
+        if (val.has_value())
+            writeValue(val.value());
+        else
+            writeNull();
+    } else if constexpr (hasValue_v<T>) {
+        writeValue(val.value());
+    } else if constexpr (hasJsonFields_v<T>) {
+        writeFields(val);
+    } else if constexpr (hasToJson_v<T>) {
+        writeValue(val.ToJson());
+    } else if constexpr (std::is_same_v<T, BaoJson>) {
+        writeJson(val.data());
+    } else {
+        static_assert(always_false<T>, "Could not deduce type");
+    }
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_JSON_WRITER_INL_H__
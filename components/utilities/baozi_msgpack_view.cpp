@@ -0,0 +1,218 @@
+#include "baozi_msgpack_view.h"
+#include <cstring>
+
+namespace Baozi {
+
+static uint64_t readBigEndian(const uint8_t *data, size_t bytes) {
+    uint64_t val = 0;
+    for (size_t i = 0; i < bytes; i++)
+        val = (val << 8) | data[i];
+
+    return val;
+}
+
+// ================== DECODING ==================
+
+bool BaoMsgPackView::readHeader(const uint8_t *data, size_t available, header_t &header) {
+    if (available == 0)
+        return false;
+
+    uint8_t type = data[0];
+    header.size = 1;
+    header.length = 0;
+    header.u = 0;
+
+    // the fixed size encodings carry their value or length in the type byte
+    if (type <= 0x7f) {
+        header.type = eType::UINT;
+        header.u = type;
+        return true;
+    }
+    if (type >= 0xe0) {
+        header.type = eType::INT;
+        header.i = static_cast<int8_t>(type);
+        return true;
+    }
+    if (type <= 0x9f) {
+        header.type = type <= 0x8f ? eType::MAP : eType::ARRAY;
+        header.length = type & 0x0f;
+        return true;
+    }
+    if (type <= 0xbf) {
+        header.type = eType::STR;
+        header.length = type & 0x1f;
+        return true;
+    }
+
+    // the others are followed by 'bytes' bytes of big endian length or value
+    size_t bytes = 0;
+    switch (type) {
+    case 0xc0: header.type = eType::NIL; return true;
+    case 0xc2:
+    case 0xc3:
+        header.type = eType::BOOL;
+        header.b = type == 0xc3;
+        return true;
+    case 0xc4: case 0xc5: case 0xc6: header.type = eType::BIN; bytes = 1 << (type - 0xc4); break;
+    case 0xc7: case 0xc8: case 0xc9: header.type = eType::EXT; bytes = 1 << (type - 0xc7); break;
+    case 0xca: header.type = eType::FLOAT; bytes = 4; break;
+    case 0xcb: header.type = eType::FLOAT; bytes = 8; break;
+    case 0xcc: case 0xcd: case 0xce: case 0xcf: header.type = eType::UINT; bytes = 1 << (type - 0xcc); break;
+    case 0xd0: case 0xd1: case 0xd2: case 0xd3: header.type = eType::INT; bytes = 1 << (type - 0xd0); break;
+    case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+        // fixext - a type byte and 1 to 16 bytes of data
+        header.type = eType::EXT;
+        header.size = 2;
+        header.length = 1 << (type - 0xd4);
+        return available >= header.size;
+    case 0xd9: case 0xda: case 0xdb: header.type = eType::STR; bytes = 1 << (type - 0xd9); break;
+    case 0xdc: case 0xdd: header.type = eType::ARRAY; bytes = 2 << (type - 0xdc); break;
+    case 0xde: case 0xdf: header.type = eType::MAP; bytes = 2 << (type - 0xde); break;
+    default: return false;   // 0xc1 is never used
+    }
+
+    header.size += bytes;
+    if (header.type == eType::EXT)
+        header.size++;   // the ext type byte
+
+    if (available < header.size)
+        return false;
+
+    uint64_t val = readBigEndian(data + 1, bytes);
+    switch (header.type) {
+    case eType::UINT: header.u = val; break;
+    case eType::INT:
+        // sign extend from 'bytes' bytes
+        header.i = bytes == 8 ? static_cast<int64_t>(val) : static_cast<int64_t>(val << (64 - 8 * bytes)) >> (64 - 8 * bytes);
+        break;
+    case eType::FLOAT:
+        if (bytes == 4) {
+            float f;
+            uint32_t bits = static_cast<uint32_t>(val);
+            memcpy(&f, &bits, sizeof(f));
+            header.d = f;
+        } else {
+            memcpy(&header.d, &val, sizeof(header.d));
+        }
+        break;
+    default: header.length = static_cast<uint32_t>(val); break;
+    }
+
+    return true;
+}
+
+// returns the end of the value at data, which must have been validated by Parse()
+const uint8_t *BaoMsgPackView::skip(const uint8_t *data) {
+    // values left to skip, containers add their children instead of recursing
+    uint64_t pending = 1;
+    while (pending > 0) {
+        header_t header;
+        readHeader(data, SIZE_MAX, header);
+        pending--;
+        data += header.size;
+
+        if (header.type == eType::STR || header.type == eType::BIN || header.type == eType::EXT)
+            data += header.length;
+        else if (header.type == eType::ARRAY)
+            pending += header.length;
+        else if (header.type == eType::MAP)
+            pending += 2ull * header.length;
+    }
+
+    return data;
+}
+
+std::optional<BaoMsgPackView> BaoMsgPackView::Parse(const uint8_t *data, size_t length) {
+    if (data == nullptr)
+        return std::nullopt;
+
+    // every value takes at least one byte, so a bogus count fails when the buffer runs out
+    size_t pos = 0;
+    uint64_t pending = 1;
+    while (pending > 0) {
+        header_t header;
+        if (!readHeader(data + pos, length - pos, header))
+            return std::nullopt;
+
+        pending--;
+        pos += header.size;
+
+        if (header.type == eType::STR || header.type == eType::BIN || header.type == eType::EXT) {
+            if (header.length > length - pos)
+                return std::nullopt;
+            pos += header.length;
+        } else if (header.type == eType::ARRAY) {
+            pending += header.length;
+        } else if (header.type == eType::MAP) {
+            pending += 2ull * header.length;
+        }
+    }
+
+    if (pos != length)
+        return std::nullopt;
+
+    return BaoMsgPackView{ data };
+}
+
+// ================== ACCESS ==================
+
+BaoMsgPackView::header_t BaoMsgPackView::header() const {
+    header_t header;
+    readHeader(m_data, SIZE_MAX, header);
+    return header;
+}
+
+std::string_view BaoMsgPackView::string() const {
+    header_t str = header();
+    return { reinterpret_cast<const char *>(m_data + str.size), str.length };
+}
+
+bool BaoMsgPackView::IsObject() const {
+    return m_data != nullptr && header().type == eType::MAP;
+}
+
+bool BaoMsgPackView::IsArray() const {
+    return m_data != nullptr && header().type == eType::ARRAY;
+}
+
+bool BaoMsgPackView::IsNull() const {
+    return m_data != nullptr && header().type == eType::NIL;
+}
+
+bool BaoMsgPackView::IsEmpty() const {
+    if (!IsObject() && !IsArray())
+        return true;
+
+    return header().length == 0;
+}
+
+int BaoMsgPackView::ArraySize() const {
+    configASSERT(IsArray());
+    return static_cast<int>(header().length);
+}
+
+bool BaoMsgPackView::HasItem(const char *key) const {
+    return findItem(key).has_value();
+}
+
+// the first value whose key matches, compared byte by byte
+std::optional<BaoMsgPackView> BaoMsgPackView::findItem(const char *key) const {
+    if (!IsObject() || key == nullptr)
+        return std::nullopt;
+
+    std::string_view name{ key };
+    header_t map = header();
+    const uint8_t *next = m_data + map.size;
+    for (uint32_t i = 0; i < map.length; i++) {
+        BaoMsgPackView item{ next };
+        const uint8_t *value = skip(next);
+        next = skip(value);
+
+        if (item.header().type == eType::STR && item.string() == name)
+            return BaoMsgPackView{ value };
+    }
+
+    return std::nullopt;
+}
+
+}   // namespace Baozi
@@ -0,0 +1,145 @@
+#ifndef UTIL_BAOZI_MSGPACK_VIEW_H__
+#define UTIL_BAOZI_MSGPACK_VIEW_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "freertos/FreeRTOS.h"
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+/*
+    BaoMsgPackView is a read only, non allocating view over a MessagePack buffer (see BaoMsgPackWriter).
+    It offers the same reading API as BaoJsonView (GetVal<T>, HasItem, ArrayForEach, ObjectForEach...),
+    and nested maps/arrays are returned as views into the same buffer.
+
+    Parse() validates the whole buffer once, so later reads never run past its end.
+    There are no tokens - lookups walk the encoded values, which is cheap as every value carries its own length.
+    The buffer must outlive the view.
+
+    NOTICE - Strings are not NUL terminated, read them as std::string_view or as std::string (allocates)
+    NOTICE - Only string keys can be looked up, other keys are skipped
+
+    example:
+        auto msg = BaoMsgPackView::Parse(data, dataLen);
+        if (msg && msg->HasItem("brightness"))
+            setBrightness(msg->GetVal<int>("brightness").value());
+*/
+class BaoMsgPackView
+{
+    public:
+    // an empty view, holding no value
+    BaoMsgPackView() = default;
+
+    /**
+     * @brief validate a complete MessagePack buffer holding exactly one value and return a view over it
+     *
+     * @return std::optional<BaoMsgPackView> the view if the buffer is valid, std::nullopt otherwise
+     */
+    static std::optional<BaoMsgPackView> Parse(const uint8_t *data, size_t length);
+
+    static std::optional<BaoMsgPackView> Parse(std::string_view data) {
+        return Parse(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    }
+
+    /**
+     * @brief return true if the view holds a value
+     */
+    operator bool() const { return m_data != nullptr; }
+
+    bool IsObject() const;
+    bool IsArray() const;
+    bool IsNull() const;
+
+    /**
+     * @brief return true if the view is an empty map/array or holds no value
+     */
+    bool IsEmpty() const;
+
+    bool HasItem(const char *key) const;
+
+    template <typename... Ts>
+    bool HasEitherItems(Ts... keys) const {
+        return (HasItem(keys) || ...);
+    }
+
+    template <typename... Ts>
+    bool HasAllItems(Ts... keys) const {
+        return (HasItem(keys) && ...);
+    }
+
+    /**
+     * @brief Get a value from the map by key, see BaoJson::GetVal
+     * @brief NOTICE - supported types are bool, numbers, units with value(), std::string_view, std::string and BaoMsgPackView
+     */
+    template <typename T>
+    std::optional<T> GetVal(const char *key) const;
+
+    template <typename T>
+    std::optional<T> GetVal() const;
+
+    /**
+     * @brief Performs a function for each item of type T in the array, see BaoJson::ArrayForEach
+     */
+    template <typename T, typename F>
+    void ArrayForEach(F &&func) const;
+
+    int ArraySize() const;
+
+    /**
+     * @brief Performs a function for each key-value of the map, in one pass over the buffer
+     *
+     * @tparam F a functor or a function that takes (std::string_view key, const BaoMsgPackView &value)
+     * @param func the function to perform
+     */
+    template <typename F>
+    void ObjectForEach(F &&func) const;
+
+    private:
+    enum class eType : uint8_t
+    {
+        NIL,
+        BOOL,
+        UINT,
+        INT,
+        FLOAT,
+        STR,
+        BIN,
+        ARRAY,
+        MAP,
+        EXT,
+    };
+
+    struct header_t
+    {
+        eType type;
+        size_t size;       // bytes of the header itself
+        uint32_t length;   // bytes of str/bin/ext data, or items of an array / key-values of a map
+        union {
+            bool b;
+            uint64_t u;
+            int64_t i;
+            double d;
+        };
+    };
+
+    const uint8_t *m_data{};
+
+    explicit BaoMsgPackView(const uint8_t *data) : m_data(data) {}
+
+    header_t header() const;
+    std::string_view string() const;
+    std::optional<BaoMsgPackView> findItem(const char *key) const;
+
+    static bool readHeader(const uint8_t *data, size_t available, header_t &header);
+    static const uint8_t *skip(const uint8_t *data);
+};
+
+}   // namespace Baozi
+
+#include "baozi_msgpack_view_inl.hpp"
+
+#endif   // UTIL_BAOZI_MSGPACK_VIEW_H__
@@ -0,0 +1,109 @@
+#ifndef UTIL_BAOZI_MSGPACK_VIEW_INL_H__
+#define UTIL_BAOZI_MSGPACK_VIEW_INL_H__
+
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+/*
+    helper trait to check if a type can be read from a BaoMsgPackView
+*/
+template <typename T>
+inline constexpr bool is_msgpack_view_readable_v = std::is_arithmetic_v<T> || hasValue_v<T> || HasCStr_v<T> ||
+                                                   std::is_same_v<T, std::string_view> || std::is_same_v<T, BaoMsgPackView>;
+
+template <typename T>
+std::optional<T> BaoMsgPackView::GetVal(const char *key) const {
+    static_assert(!std::is_same_v<T, const char *>, "view strings are not NUL terminated, use std::string_view or std::string");
+    static_assert(is_msgpack_view_readable_v<T>, "Type can not be read from a msgpack view");
+
+    auto item = findItem(key);
+    if (!item.has_value())
+        return std::nullopt;
+
+    return item->GetVal<T>();
+}
+
+template <typename T>
+std::optional<T> BaoMsgPackView::GetVal() const {
+    static_assert(!std::is_same_v<T, const char *>, "view strings are not NUL terminated, use std::string_view or std::string");
+    static_assert(is_msgpack_view_readable_v<T>, "Type can not be read from a msgpack view");
+
+    if (m_data == nullptr)
+        return std::nullopt;
+
+    header_t value = header();
+    if constexpr (std::is_same_v<T, bool>) {
+        return value.type == eType::BOOL ? std::optional{ value.b } : std::nullopt;
+    } else if constexpr (std::is_arithmetic_v<T> || hasValue_v<T>) {
+        using number_t = std::conditional_t<std::is_arithmetic_v<T>, T, double>;
+        std::optional<number_t> number;
+        if (value.type == eType::UINT)
+            number = static_cast<number_t>(value.u);
+        else if (value.type == eType::INT)
+            number = static_cast<number_t>(value.i);
+        else if (value.type == eType::FLOAT)
+            number = static_cast<number_t>(value.d);
+
+        if constexpr (std::is_arithmetic_v<T>)
+            return number;
+        else
+            return number.has_value() ? std::optional{ T(number.value()) } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        return value.type == eType::STR ? std::optional{ string() } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, BaoMsgPackView>) {
+        return (IsObject() || IsArray()) ? std::optional{ *this } : std::nullopt;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return value.type == eType::STR ? std::optional{ std::string{ string() } } : std::nullopt;
+    } else {
+        return value.type == eType::STR ? std::optional{ T{ std::string{ string() }.c_str() } } : std::nullopt;
+    }
+}
+
+template <typename T, typename F>
+void BaoMsgPackView::ArrayForEach(F &&func) const {
+    static_assert(is_msgpack_view_readable_v<T>, "Type can not be read from a msgpack view");
+
+    if (m_data == nullptr)
+        return;
+
+    configASSERT(IsArray());
+
+    header_t array = header();
+    const uint8_t *next = m_data + array.size;
+    for (uint32_t i = 0; i < array.length; i++) {
+        BaoMsgPackView item{ next };
+        next = skip(next);
+
+        if constexpr (std::is_same_v<T, BaoMsgPackView>) {
+            if (item.IsObject())
+                func(item);
+        } else {
+            auto value = item.GetVal<T>();
+            if (value.has_value())
+                func(value.value());
+        }
+    }
+}
+
+template <typename F>
+void BaoMsgPackView::ObjectForEach(F &&func) const {
+    if (!IsObject())
+        return;
+
+    header_t map = header();
+    const uint8_t *next = m_data + map.size;
+    for (uint32_t i = 0; i < map.length; i++) {
+        BaoMsgPackView key{ next };
+        BaoMsgPackView value{ skip(next) };
+        next = skip(value.m_data);
+
+        auto name = key.GetVal<std::string_view>();
+        if (name.has_value())
+            func(name.value(), value);
+    }
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_MSGPACK_VIEW_INL_H__
@@ -0,0 +1,240 @@
+#include "baozi_msgpack_writer.h"
+#include <cmath>
+#include <cstring>
+
+namespace Baozi {
+
+// MessagePack type bytes, see https://github.com/msgpack/msgpack/blob/master/spec.md
+static constexpr uint8_t MP_FIXMAP = 0x80;
+static constexpr uint8_t MP_FIXARRAY = 0x90;
+static constexpr uint8_t MP_FIXSTR = 0xa0;
+static constexpr uint8_t MP_NIL = 0xc0;
+static constexpr uint8_t MP_FALSE = 0xc2;
+static constexpr uint8_t MP_TRUE = 0xc3;
+static constexpr uint8_t MP_FLOAT32 = 0xca;
+static constexpr uint8_t MP_FLOAT64 = 0xcb;
+static constexpr uint8_t MP_UINT8 = 0xcc;
+static constexpr uint8_t MP_UINT16 = 0xcd;
+static constexpr uint8_t MP_UINT32 = 0xce;
+static constexpr uint8_t MP_UINT64 = 0xcf;
+static constexpr uint8_t MP_INT8 = 0xd0;
+static constexpr uint8_t MP_INT16 = 0xd1;
+static constexpr uint8_t MP_INT32 = 0xd2;
+static constexpr uint8_t MP_INT64 = 0xd3;
+static constexpr uint8_t MP_STR8 = 0xd9;
+static constexpr uint8_t MP_STR16 = 0xda;
+static constexpr uint8_t MP_STR32 = 0xdb;
+static constexpr uint8_t MP_ARRAY16 = 0xdc;
+static constexpr uint8_t MP_ARRAY32 = 0xdd;
+static constexpr uint8_t MP_MAP16 = 0xde;
+static constexpr uint8_t MP_MAP32 = 0xdf;
+
+BaoMsgPackWriter::BaoMsgPackWriter(uint8_t *buffer, size_t size) : m_buffer(buffer), m_size(size) {
+    configASSERT(m_buffer != nullptr);
+    configASSERT(m_size >= 1);
+
+    Reset();
+}
+
+void BaoMsgPackWriter::Reset() {
+    m_length = 1;
+    m_headerSize = 1;
+    m_count = 0;
+    m_overflow = false;
+    writeHeader();
+}
+
+// ================== MEMBERS ==================
+
+void BaoMsgPackWriter::endMember(size_t rollback) {
+    if (!m_overflow && m_count == FIXMAP_MAX && m_headerSize == 1)
+        growHeader();
+
+    if (m_overflow) {
+        m_length = rollback;
+        return;
+    }
+
+    configASSERT(m_count < UINT16_MAX);
+    m_count++;
+    writeHeader();
+}
+
+// switches the top level header from fixmap to map16, moving the members 2 bytes further
+void BaoMsgPackWriter::growHeader() {
+    if (capacity() < 2) {
+        m_overflow = true;
+        return;
+    }
+
+    memmove(m_buffer + 3, m_buffer + 1, m_length - 1);
+    m_length += 2;
+    m_headerSize = 3;
+}
+
+void BaoMsgPackWriter::writeHeader() {
+    if (m_headerSize == 1) {
+        m_buffer[0] = MP_FIXMAP | m_count;
+        return;
+    }
+
+    m_buffer[0] = MP_MAP16;
+    m_buffer[1] = m_count >> 8;
+    m_buffer[2] = m_count & 0xFF;
+}
+
+// ================== VALUES ==================
+
+void BaoMsgPackWriter::writeRaw(const uint8_t *data, size_t len) {
+    if (m_overflow || len > capacity()) {
+        m_overflow = true;
+        return;
+    }
+
+    memcpy(m_buffer + m_length, data, len);
+    m_length += len;
+}
+
+void BaoMsgPackWriter::writeByte(uint8_t byte) {
+    writeRaw(&byte, 1);
+}
+
+// a type byte followed by a big endian value of 'bytes' bytes
+void BaoMsgPackWriter::writeTyped(uint8_t type, uint64_t val, size_t bytes) {
+    uint8_t encoded[9] = { type };
+    for (size_t i = 0; i < bytes; i++)
+        encoded[bytes - i] = static_cast<uint8_t>(val >> (8 * i));
+
+    writeRaw(encoded, bytes + 1);
+}
+
+void BaoMsgPackWriter::writeString(const char *str) {
+    if (str == nullptr) {
+        writeNull();
+        return;
+    }
+
+    size_t len = strlen(str);
+    if (len < 32)
+        writeByte(MP_FIXSTR | len);
+    else if (len <= UINT8_MAX)
+        writeTyped(MP_STR8, len, 1);
+    else if (len <= UINT16_MAX)
+        writeTyped(MP_STR16, len, 2);
+    else
+        writeTyped(MP_STR32, len, 4);
+
+    writeRaw(reinterpret_cast<const uint8_t *>(str), len);
+}
+
+void BaoMsgPackWriter::writeInteger(long long val) {
+    if (val >= 0)
+        writeUnsigned(val);
+    else if (val >= -32)
+        writeByte(static_cast<uint8_t>(val));   // negative fixint
+    else if (val >= INT8_MIN)
+        writeTyped(MP_INT8, val, 1);
+    else if (val >= INT16_MIN)
+        writeTyped(MP_INT16, val, 2);
+    else if (val >= INT32_MIN)
+        writeTyped(MP_INT32, val, 4);
+    else
+        writeTyped(MP_INT64, val, 8);
+}
+
+void BaoMsgPackWriter::writeUnsigned(unsigned long long val) {
+    if (val < 128)
+        writeByte(val);   // positive fixint
+    else if (val <= UINT8_MAX)
+        writeTyped(MP_UINT8, val, 1);
+    else if (val <= UINT16_MAX)
+        writeTyped(MP_UINT16, val, 2);
+    else if (val <= UINT32_MAX)
+        writeTyped(MP_UINT32, val, 4);
+    else
+        writeTyped(MP_UINT64, val, 8);
+}
+
+// integral values are written as integers, like the json writer prints 21.0 as 21
+void BaoMsgPackWriter::writeNumber(double val) {
+    static constexpr double INT64_LIMIT = 9223372036854775808.0;   // 2^63
+
+    if (std::trunc(val) == val && val >= -INT64_LIMIT && val < INT64_LIMIT) {
+        writeInteger(static_cast<long long>(val));
+        return;
+    }
+
+    float narrow = static_cast<float>(val);
+    if (static_cast<double>(narrow) == val) {
+        writeNumber(narrow);
+        return;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    writeTyped(MP_FLOAT64, bits, 8);
+}
+
+void BaoMsgPackWriter::writeNumber(float val) {
+    static constexpr float INT64_LIMIT = 9223372036854775808.0f;   // 2^63
+
+    if (std::trunc(val) == val && val >= -INT64_LIMIT && val < INT64_LIMIT) {
+        writeInteger(static_cast<long long>(val));
+        return;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    writeTyped(MP_FLOAT32, bits, 4);
+}
+
+void BaoMsgPackWriter::writeBool(bool val) {
+    writeByte(val ? MP_TRUE : MP_FALSE);
+}
+
+void BaoMsgPackWriter::writeNull() {
+    writeByte(MP_NIL);
+}
+
+void BaoMsgPackWriter::writeMapHeader(size_t count) {
+    if (count <= FIXMAP_MAX)
+        writeByte(MP_FIXMAP | count);
+    else if (count <= UINT16_MAX)
+        writeTyped(MP_MAP16, count, 2);
+    else
+        writeTyped(MP_MAP32, count, 4);
+}
+
+void BaoMsgPackWriter::writeArrayHeader(size_t count) {
+    if (count < 16)
+        writeByte(MP_FIXARRAY | count);
+    else if (count <= UINT16_MAX)
+        writeTyped(MP_ARRAY16, count, 2);
+    else
+        writeTyped(MP_ARRAY32, count, 4);
+}
+
+// converts a cJSON tree node by node, nesting depth is bounded by cJSON's own parse limit
+void BaoMsgPackWriter::writeJson(const cJSON *json) {
+    if (json == nullptr || cJSON_IsNull(json) || cJSON_IsInvalid(json)) {
+        writeNull();
+    } else if (cJSON_IsBool(json)) {
+        writeBool(cJSON_IsTrue(json));
+    } else if (cJSON_IsNumber(json)) {
+        writeNumber(json->valuedouble);
+    } else if (cJSON_IsString(json) || cJSON_IsRaw(json)) {
+        writeString(json->valuestring);
+    } else if (cJSON_IsArray(json)) {
+        writeArrayHeader(cJSON_GetArraySize(json));
+        for (const cJSON *item = json->child; item != nullptr && !m_overflow; item = item->next)
+            writeJson(item);
+    } else if (cJSON_IsObject(json)) {
+        writeMapHeader(cJSON_GetArraySize(json));
+        for (const cJSON *item = json->child; item != nullptr && !m_overflow; item = item->next) {
+            writeString(item->string);
+            writeJson(item);
+        }
+    }
+}
+
+}   // namespace Baozi
@@ -0,0 +1,126 @@
+#ifndef UTIL_BAOZI_MSGPACK_WRITER_H__
+#define UTIL_BAOZI_MSGPACK_WRITER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include "baozi_json.h"
+
+namespace Baozi {
+
+/*
+    BaoMsgPackWriter serializes key-values as a MessagePack map straight into a caller supplied buffer.
+    It is the binary twin of BaoJsonWriter - it accepts the same KV{} packs, json serializable types and
+    BAOZI_JSON_FIELDS structs, for topics that are only read by our own devices and services.
+
+    Integers use their smallest encoding, floating point values that are integral are written as integers
+    and doubles that fit a float losslessly are written as float32.
+
+    The buffer always holds a valid MessagePack map, so it can be published at any point.
+    If a value does not fit, it is dropped, the map is left as it was and the writer becomes invalid.
+
+    example:
+        uint8_t buffer[64];
+        BaoMsgPackWriter msg{buffer};
+        msg.AddVals(KV{"temperature", 21.5}, KV{"unit", "C"});
+        client.Publish(topic, msg); // 25 bytes, {"temperature":21.5,"unit":"C"} is 31 bytes of json
+*/
+class BaoMsgPackWriter
+{
+    public:
+    BaoMsgPackWriter(uint8_t *buffer, size_t size);
+
+    template <size_t N>
+    explicit BaoMsgPackWriter(uint8_t (&buffer)[N]) : BaoMsgPackWriter(buffer, N) {}
+
+    BaoMsgPackWriter(const BaoMsgPackWriter &rhs) = delete;
+    BaoMsgPackWriter &operator=(const BaoMsgPackWriter &rhs) = delete;
+
+    /**
+     * @brief Writes a value of any json serializable type to the map, see BaoJsonWriter::AddVal
+     * @brief NOTICE - BaoJson values, ToJson() types and cJSON* are converted node by node, nothing is printed
+     * @brief NOTICE - cJSON* values are owned by the writer (like in BaoJson::AddVal) and are deleted after writing
+     *
+     * @param key - key to add
+     * @param val - val to add of any json serializable type
+     */
+    template <typename T>
+    void AddVal(const char *key, T val);
+
+    /**
+     * @brief Writes values to the map
+     * @brief NOTICE - Every property must be a KV struct of a const char* key and a json serializable value
+     *
+     * @example
+     *         msg.AddVals(KV{"int", 5}, KV{"const char*", "hello"}, KV{"boolean", true});
+     */
+    template <typename... Ts>
+    void AddVals(Ts... vals);
+
+    /**
+     * @brief Writes every field of a BAOZI_JSON_FIELDS struct as a member of the map, see baozi_json_fields.h
+     */
+    template <typename T>
+    void AddFields(const T &val);
+
+    /**
+     * @brief return the serialized map
+     */
+    const uint8_t *data() const { return m_buffer; }
+
+    /**
+     * @brief return the length of the serialized map in bytes
+     */
+    size_t length() const { return m_length; }
+
+    /**
+     * @brief return true if every value written so far fit in the buffer
+     */
+    operator bool() const { return !m_overflow; }
+
+    /**
+     * @brief clear the writer back to an empty map
+     */
+    void Reset();
+
+    private:
+    static constexpr size_t FIXMAP_MAX = 15;
+
+    uint8_t *m_buffer;
+    size_t m_size;
+    size_t m_length{};
+    size_t m_headerSize{};   // the top level map header is a fixmap until it holds more than FIXMAP_MAX members
+    uint16_t m_count{};
+    bool m_overflow{false};
+
+    template <typename T>
+    void writeValue(const T &val);
+
+    template <typename T>
+    void writeFields(const T &val);
+
+    void endMember(size_t rollback);
+    void growHeader();
+    void writeHeader();
+
+    void writeRaw(const uint8_t *data, size_t len);
+    void writeByte(uint8_t byte);
+    void writeTyped(uint8_t type, uint64_t val, size_t bytes);
+    void writeString(const char *str);
+    void writeInteger(long long val);
+    void writeUnsigned(unsigned long long val);
+    void writeNumber(double val);
+    void writeNumber(float val);
+    void writeBool(bool val);
+    void writeNull();
+    void writeMapHeader(size_t count);
+    void writeArrayHeader(size_t count);
+    void writeJson(const cJSON *json);
+
+    size_t capacity() const { return m_size - m_length; }
+};
+
+}   // namespace Baozi
+
+#include "baozi_msgpack_writer_inl.hpp"
+
+#endif   // UTIL_BAOZI_MSGPACK_WRITER_H__
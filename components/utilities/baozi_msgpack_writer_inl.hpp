@@ -0,0 +1,85 @@
+#ifndef UTIL_BAOZI_MSGPACK_WRITER_INL_H__
+#define UTIL_BAOZI_MSGPACK_WRITER_INL_H__
+
+#include <tuple>
+#include "baozi_json_traits.h"
+
+namespace Baozi {
+
+template <typename T>
+void BaoMsgPackWriter::AddVal(const char *key, T val) {
+    static_assert(is_json_serializable_v<T>, "type is not json serializable");
+    configASSERT(key != nullptr);
+
+    if (m_overflow) {
+        if constexpr (std::is_same_v<T, cJSON *>)
+            cJSON_Delete(val);
+        return;
+    }
+
+    size_t rollback = m_length;
+    writeString(key);
+    writeValue(val);
+    endMember(rollback);
+}
+
+template <typename... Ts>
+void BaoMsgPackWriter::AddVals(Ts... vals) {
+    static_assert((is_valid_key_value_v<Ts> && ...), "invalid key value");
+    (AddVal(vals.m_key, std::move(vals.m_val)), ...);
+}
+
+template <typename T>
+void BaoMsgPackWriter::AddFields(const T &val) {
+    static_assert(hasJsonFields_v<T>, "type does not declare BAOZI_JSON_FIELDS");
+
+    std::apply([&](const auto &...fields) { (AddVal(fields.key, val.*fields.member), ...); }, T::JsonFields());
+}
+
+// the field count is known at compile time, so the nested map header is exact
+template <typename T>
+void BaoMsgPackWriter::writeFields(const T &val) {
+    constexpr auto fields = T::JsonFields();
+    writeMapHeader(std::tuple_size_v<decltype(fields)>);
+
+    std::apply([&](const auto &...field) { ((writeString(field.key), writeValue(val.*field.member)), ...); }, fields);
+}
+
+template <typename T>
+void BaoMsgPackWriter::writeValue(const T &val) {
+    if constexpr (std::is_same_v<T, bool>) {
+        writeBool(val);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        writeInteger(val);
+    } else if constexpr (std::is_integral_v<T>) {
+        writeUnsigned(val);
+    } else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+        writeNumber(val);
+    } else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>) {
+        writeString(val);
+    } else if constexpr (std::is_same_v<T, cJSON *>) {
+        writeJson(val);
+        cJSON_Delete(val);
+    } else if constexpr (HasCStr_v<T>) {
+        writeString(val.c_str());
+    } else if constexpr (is_json_optional<T>::value) {
+        if (val.has_value())
+            writeValue(val.value());
+        else
+            writeNull();
+    } else if constexpr (hasValue_v<T>) {
+        writeValue(val.value());
+    } else if constexpr (hasJsonFields_v<T>) {
+        writeFields(val);
+    } else if constexpr (hasToJson_v<T>) {
+        writeValue(val.ToJson());
+    } else if constexpr (std::is_same_v<T, BaoJson>) {
+        writeJson(val.data());
+    } else {
+        static_assert(always_false<T>, "Could not deduce type");
+    }
+}
+
+}   // namespace Baozi
+
+#endif   // UTIL_BAOZI_MSGPACK_WRITER_INL_H__
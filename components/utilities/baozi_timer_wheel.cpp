@@ -0,0 +1,303 @@
+#include "baozi_timer_wheel.h"
+#include <algorithm>
+
+namespace Baozi
+{
+
+    BaoTimerWheel::BaoTimerWheel(size_t maxTimers)
+        : m_links(std::make_unique<link_t[]>(FIRST_TIMER + maxTimers)),
+          m_timers(std::make_unique<timer_entry_t[]>(maxTimers)),
+          m_maxTimers(maxTimers)
+    {
+        configASSERT(FIRST_TIMER + maxTimers < NO_TIMER);
+
+        for (uint16_t sentinel = 0; sentinel < FIRST_TIMER; sentinel++)
+        {
+            m_links[sentinel] = {sentinel, sentinel};
+        }
+
+        for (size_t i = maxTimers; i > 0; i--)
+        {
+            uint16_t link = FIRST_TIMER + i - 1;
+            m_links[link].next = m_freeList;
+            m_freeList = link;
+        }
+    }
+
+    BaoTimerWheel::timer_id_t BaoTimerWheel::Schedule(uint32_t ticks, callback_t &&callback)
+    {
+        if (m_freeList == NO_TIMER)
+        {
+            return INVALID_TIMER;
+        }
+
+        uint16_t link = m_freeList;
+        m_freeList = m_links[link].next;
+
+        timer_entry_t &timer = m_timers[link - FIRST_TIMER];
+        timer.expires = m_now + std::max<uint32_t>(ticks, 1);
+        timer.callback = std::move(callback);
+        insert(link);
+        m_pending++;
+
+        return (static_cast<timer_id_t>(timer.generation) << 16) | link;
+    }
+
+    bool BaoTimerWheel::Cancel(timer_id_t id)
+    {
+        if (find(id) == nullptr)
+        {
+            return false;
+        }
+
+        uint16_t link = static_cast<uint16_t>(id);
+        unlink(link);
+        release(link);
+        return true;
+    }
+
+    bool BaoTimerWheel::IsPending(timer_id_t id) const
+    {
+        return const_cast<BaoTimerWheel *>(this)->find(id) != nullptr;
+    }
+
+    void BaoTimerWheel::Tick()
+    {
+        m_now++;
+
+        // every SLOTS ticks the next slot of the level above moves down, and so on up the levels
+        for (uint32_t level = 1; level < LEVELS; level++)
+        {
+            if ((m_now & ((1u << (SLOT_BITS * level)) - 1)) != 0)
+            {
+                break;
+            }
+
+            cascade(level);
+        }
+
+        // the current slot of level 0 holds exactly the timers due now
+        uint16_t sentinel = m_now & (SLOTS - 1);
+        while (m_links[sentinel].next != sentinel)
+        {
+            uint16_t link = m_links[sentinel].next;
+            unlink(link);
+            linkBefore(EXPIRED_LIST, link);
+        }
+    }
+
+    std::optional<BaoTimerWheel::callback_t> BaoTimerWheel::PopExpired()
+    {
+        uint16_t link = m_links[EXPIRED_LIST].next;
+        if (link == EXPIRED_LIST)
+        {
+            return std::nullopt;
+        }
+
+        unlink(link);
+        callback_t callback = std::move(m_timers[link - FIRST_TIMER].callback);
+        release(link);
+        return callback;
+    }
+
+    void BaoTimerWheel::Advance(uint32_t ticks)
+    {
+        for (uint32_t i = 0; i < ticks; i++)
+        {
+            Tick();
+            while (auto callback = PopExpired())
+            {
+                (*callback)();
+            }
+        }
+    }
+
+    //===============================================================================================
+
+    BaoTimerWheel::timer_entry_t *BaoTimerWheel::find(timer_id_t id)
+    {
+        uint16_t link = static_cast<uint16_t>(id);
+        if (link < FIRST_TIMER || link >= FIRST_TIMER + m_maxTimers)
+        {
+            return nullptr;
+        }
+
+        // released timers move to the next generation, so a stale id never matches
+        timer_entry_t &timer = m_timers[link - FIRST_TIMER];
+        return timer.generation == static_cast<uint16_t>(id >> 16) ? &timer : nullptr;
+    }
+
+    // a timer goes to the lowest level whose span covers its delay, in the slot of its expiry at that level
+    void BaoTimerWheel::insert(uint16_t link)
+    {
+        const timer_entry_t &timer = m_timers[link - FIRST_TIMER];
+        uint32_t delta = std::min(timer.expires - m_now, MAX_TICKS);
+        uint32_t expires = m_now + delta;
+
+        uint32_t level = 0;
+        while (level + 1 < LEVELS && delta >= (1u << (SLOT_BITS * (level + 1))))
+        {
+            level++;
+        }
+
+        uint32_t slot = (expires >> (SLOT_BITS * level)) & (SLOTS - 1);
+        linkBefore(level * SLOTS + slot, link);
+    }
+
+    void BaoTimerWheel::linkBefore(uint16_t sentinel, uint16_t link)
+    {
+        uint16_t last = m_links[sentinel].prev;
+        m_links[link] = {last, sentinel};
+        m_links[last].next = link;
+        m_links[sentinel].prev = link;
+    }
+
+    void BaoTimerWheel::unlink(uint16_t link)
+    {
+        m_links[m_links[link].prev].next = m_links[link].next;
+        m_links[m_links[link].next].prev = m_links[link].prev;
+    }
+
+    void BaoTimerWheel::release(uint16_t link)
+    {
+        timer_entry_t &timer = m_timers[link - FIRST_TIMER];
+        timer.callback = nullptr;
+        timer.generation++;
+
+        m_links[link].next = m_freeList;
+        m_freeList = link;
+        m_pending--;
+    }
+
+    // re-insert the timers of the current slot of level, they are all due within the span of the levels below
+    void BaoTimerWheel::cascade(uint32_t level)
+    {
+        uint16_t sentinel = level * SLOTS + ((m_now >> (SLOT_BITS * level)) & (SLOTS - 1));
+        uint16_t link = m_links[sentinel].next;
+        m_links[sentinel] = {sentinel, sentinel};
+
+        while (link != sentinel)
+        {
+            uint16_t next = m_links[link].next;
+            insert(link);
+            link = next;
+        }
+    }
+
+    //===============================================================================================
+
+    BaoTimerService &BaoTimerService::GetInstance()
+    {
+        // never destroyed, the esp_timer task may still be ticking it while the statics are destroyed
+        static BaoTimerService &instance = *new BaoTimerService{eClock::ESP_TIMER};
+        return instance;
+    }
+
+    BaoTimerService::BaoTimerService(eClock clock) : m_clock(clock)
+    {
+        if (m_clock == eClock::MANUAL)
+        {
+            return;
+        }
+
+        esp_timer_create_args_t args{
+            .callback = s_onTick,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "bao_timers",
+            .skip_unhandled_events = true,
+        };
+
+        configASSERT(esp_timer_create(&args, &m_timer) == ESP_OK);
+    }
+
+    BaoTimerService::timer_id_t BaoTimerService::Schedule(MilliSeconds delay, BaoTimerWheel::callback_t &&callback)
+    {
+        uint32_t ticks = (delay.value() + TICK.value() - 1) / TICK.value();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        timer_id_t id = m_wheel.Schedule(ticks, std::move(callback));
+        if (id == BaoTimerWheel::INVALID_TIMER)
+        {
+            return id;
+        }
+
+        // the esp_timer only runs while timers are pending
+        if (!m_isTicking)
+        {
+            m_lastTickUs = nowUs();
+            if (m_clock == eClock::ESP_TIMER)
+            {
+                configASSERT(esp_timer_start_periodic(m_timer, TICK_US) == ESP_OK);
+            }
+            m_isTicking = true;
+        }
+
+        return id;
+    }
+
+    bool BaoTimerService::Cancel(timer_id_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_wheel.Cancel(id);
+    }
+
+    void BaoTimerService::Advance(MilliSeconds elapsed)
+    {
+        configASSERT(m_clock == eClock::MANUAL);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_manualUs += static_cast<int64_t>(elapsed.value()) * 1000;
+            if (!m_isTicking)
+            {
+                return;
+            }
+        }
+
+        tick();
+    }
+
+    int64_t BaoTimerService::nowUs() const
+    {
+        return m_clock == eClock::MANUAL ? m_manualUs : esp_timer_get_time();
+    }
+
+    void BaoTimerService::tick()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        // advance by the time that really passed, a late or skipped esp_timer callback does not slow the wheel down
+        int64_t now = nowUs();
+        uint32_t ticks = static_cast<uint32_t>((now - m_lastTickUs) / TICK_US);
+        m_lastTickUs += static_cast<int64_t>(ticks) * TICK_US;
+
+        for (uint32_t i = 0; i < ticks; i++)
+        {
+            m_wheel.Tick();
+
+            // callbacks run unlocked, they may schedule or cancel timers
+            while (auto callback = m_wheel.PopExpired())
+            {
+                lock.unlock();
+                (*callback)();
+                lock.lock();
+            }
+        }
+
+        if (m_isTicking && m_wheel.PendingCount() == 0)
+        {
+            if (m_clock == eClock::ESP_TIMER)
+            {
+                esp_timer_stop(m_timer);
+            }
+            m_isTicking = false;
+        }
+    }
+
+    void BaoTimerService::s_onTick(void *arg)
+    {
+        reinterpret_cast<BaoTimerService *>(arg)->tick();
+    }
+
+} // namespace Baozi
@@ -0,0 +1,188 @@
+#ifndef BAOZI_TIMER_WHEEL_H__
+#define BAOZI_TIMER_WHEEL_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include "esp_timer.h"
+#include "baozi_time_units.h"
+
+namespace Baozi
+{
+
+    /*
+        BaoTimerWheel is a hierarchical timer wheel - LEVELS wheels of SLOTS slots, each level SLOTS times coarser
+        than the one below. Schedule() and Cancel() are O(1), and a tick costs O(1) plus the timers that expire or
+        move down a level on it.
+        Timers are taken from a pool allocated once, and identified by a timer_id_t that turns stale once the timer
+        fired or was cancelled, so cancelling an old id is always safe.
+
+        The wheel has no clock and no lock - whoever owns it calls Advance() (see BaoTimerService).
+
+        example:
+            BaoTimerWheel wheel{16};
+            auto id = wheel.Schedule(5, []() { printf("5 ticks later\n"); });
+            wheel.Advance(5); // prints
+    */
+    class BaoTimerWheel
+    {
+    public:
+        using timer_id_t = uint32_t;
+        using callback_t = std::function<void()>;
+
+        static constexpr timer_id_t INVALID_TIMER = 0;
+        static constexpr uint32_t SLOT_BITS = 6;
+        static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+        static constexpr uint32_t LEVELS = 4;
+        static constexpr uint32_t MAX_TICKS = (1u << (SLOT_BITS * LEVELS)) - 1; // longer delays are re-queued until due
+
+        explicit BaoTimerWheel(size_t maxTimers);
+
+        /**
+         * @brief call callback after the given number of ticks (at least 1)
+         *
+         * @return timer_id_t the timer, INVALID_TIMER if all timers are in use
+         */
+        timer_id_t Schedule(uint32_t ticks, callback_t &&callback);
+
+        /**
+         * @brief cancel a pending timer
+         *
+         * @return true if the timer was pending, false if it already fired, was cancelled or is INVALID_TIMER
+         */
+        bool Cancel(timer_id_t id);
+
+        bool IsPending(timer_id_t id) const;
+
+        /**
+         * @brief advance the wheel by one tick, the timers due now can be taken with PopExpired()
+         */
+        void Tick();
+
+        /**
+         * @brief take the callback of the next expired timer, the timer is released before it is returned
+         */
+        std::optional<callback_t> PopExpired();
+
+        /**
+         * @brief advance by ticks, calling the expired callbacks on the way
+         */
+        void Advance(uint32_t ticks);
+
+        uint32_t Now() const { return m_now; }
+        size_t PendingCount() const { return m_pending; }
+
+    private:
+        static constexpr uint16_t EXPIRED_LIST = LEVELS * SLOTS; // sentinel of the expired timers
+        static constexpr uint16_t FIRST_TIMER = EXPIRED_LIST + 1; // links before it are the slot sentinels
+        static constexpr uint16_t NO_TIMER = UINT16_MAX;
+
+        // circular doubly linked list links, sentinels and timers share the index space so unlinking needs no head
+        struct link_t
+        {
+            uint16_t prev;
+            uint16_t next;
+        };
+
+        struct timer_entry_t
+        {
+            uint32_t expires;
+            uint16_t generation;
+            callback_t callback;
+        };
+
+        std::unique_ptr<link_t[]> m_links;
+        std::unique_ptr<timer_entry_t[]> m_timers;
+        size_t m_maxTimers;
+        uint16_t m_freeList{NO_TIMER}; // free timers chained through link_t::next
+        size_t m_pending{};
+        uint32_t m_now{};
+
+        timer_entry_t *find(timer_id_t id);
+        void insert(uint16_t link);
+        void linkBefore(uint16_t sentinel, uint16_t link);
+        void unlink(uint16_t link);
+        void release(uint16_t link);
+        void cascade(uint32_t level);
+    };
+
+    /*
+        BaoTimerService runs a BaoTimerWheel from one periodic esp_timer, ticking every TICK while any timer is pending.
+        Callbacks run on the esp_timer task, keep them short - dispatching an event to an fsm is the intended use.
+        Schedule()/Cancel() may be called from any task, including from a callback.
+        A service with the MANUAL clock has no esp_timer, its owner moves time forward with Advance() - e.g. a host
+        test that drives an fsm under a virtual clock, with the service passed to the fsm instead of GetInstance().
+
+        NOTICE - Cancel() does not stop a callback that already started running, an event it dispatches may still arrive
+                 after Cancel() returned. Fsms tag such events with a ticket and ignore the stale ones
+
+        example:
+            // STATE_Connecting gives up after 30 seconds
+            m_timeout = BaoTimerService::GetInstance().DispatchAfter(*this, 30_sec, EVENT_ConnectTimeout{});
+            ...
+            BaoTimerService::GetInstance().Cancel(m_timeout); // connected in time
+    */
+    class BaoTimerService
+    {
+    public:
+        using timer_id_t = BaoTimerWheel::timer_id_t;
+
+        static constexpr MilliSeconds TICK = 10;
+        static constexpr size_t MAX_TIMERS = 32;
+        static constexpr int64_t TICK_US = static_cast<int64_t>(TICK.value()) * 1000;
+
+        enum class eClock
+        {
+            ESP_TIMER, // ticks by itself
+            MANUAL,    // ticks only in Advance()
+        };
+
+        static BaoTimerService &GetInstance();
+
+        explicit BaoTimerService(eClock clock);
+        BaoTimerService(const BaoTimerService &) = delete;
+        BaoTimerService &operator=(const BaoTimerService &) = delete;
+
+        /**
+         * @brief call callback after delay (rounded up to TICK)
+         *
+         * @return timer_id_t the timer, BaoTimerWheel::INVALID_TIMER if all MAX_TIMERS are in use
+         */
+        timer_id_t Schedule(MilliSeconds delay, BaoTimerWheel::callback_t &&callback);
+
+        /**
+         * @brief dispatch event to an FsmTask/FsmTaskless after delay, e.g. a state timeout or a retry backoff
+         */
+        template <typename Fsm, typename Event>
+        timer_id_t DispatchAfter(Fsm &fsm, MilliSeconds delay, Event event)
+        {
+            return Schedule(delay, [&fsm, event]() { fsm.Dispatch(Event{event}); });
+        }
+
+        bool Cancel(timer_id_t id);
+
+        /**
+         * @brief move a MANUAL clock forward, calling the callbacks that became due
+         */
+        void Advance(MilliSeconds elapsed);
+
+    private:
+        eClock m_clock;
+        int64_t m_manualUs{}; // the time of a MANUAL clock
+        std::mutex m_mutex;
+        BaoTimerWheel m_wheel{MAX_TIMERS};
+        esp_timer_handle_t m_timer{};
+        bool m_isTicking{false};
+        int64_t m_lastTickUs{}; // the time the wheel was last advanced to
+
+        int64_t nowUs() const;
+        void tick();
+        static void s_onTick(void *arg);
+    };
+
+} // namespace Baozi
+
+#endif // BAOZI_TIMER_WHEEL_H__
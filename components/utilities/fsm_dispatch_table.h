@@ -0,0 +1,141 @@
+#ifndef __FSM_DISPATCH_TABLE_H__
+#define __FSM_DISPATCH_TABLE_H__
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/*
+    Compile time transition table shared by FsmTask and FsmTaskless.
+    A flat table of function pointers, indexed by [state.index()][event.index()], is generated for every
+    state/event pair, so dispatching is two index loads and one call instead of a double std::visit.
+
+    Every pair calls, in order of preference:
+    1. on_event(State &, Event &) - the transition
+    2. on_unhandled(State &, Event &) - the fsm's fallback for pairs without a transition (e.g. to log them)
+    3. nothing - the event is ignored and the state does not change
+
+    on_event/on_unhandled may return a std::optional<StateVariant>, a state, or std::nullopt.
+
+    Example:
+        return_state_t on_event(STATE_IDLE &, EVENT_PRESS &);
+
+        template <typename State, typename Event>
+        void on_unhandled(State &state, Event &event)
+        {
+            printf("unhandled event!: %s got %s\n", state.NAME, event.NAME);
+        }
+
+    NOTICE - on_unhandled replaces the catch-all template on_event, which would hide every missing transition
+*/
+
+// define as 1 to make every state/event pair without an on_event a compile error naming the pair
+// (on_unhandled is not used then)
+#ifndef FSM_STRICT_TRANSITIONS
+#define FSM_STRICT_TRANSITIONS 0
+#endif
+
+template <typename Derived, typename StateVariant, typename EventVariant>
+class FsmDispatchTable
+{
+public:
+    using return_state_t = std::optional<StateVariant>;
+
+    // Call the handler of the current state and the event
+    static return_state_t Dispatch(Derived &child, StateVariant &states, EventVariant &event)
+    {
+        static constexpr auto table = makeTable(std::make_index_sequence<std::variant_size_v<StateVariant>>{});
+        return table[states.index()][event.index()](child, states, event);
+    }
+
+private:
+    using handler_t = return_state_t (*)(Derived &, StateVariant &, EventVariant &);
+
+    template <typename State, typename Event>
+    static constexpr bool s_hasTransition = requires(Derived &child, State &state, Event &event) { child.on_event(state, event); };
+
+    template <typename State, typename Event>
+    static constexpr bool s_hasFallback = requires(Derived &child, State &state, Event &event) { child.on_unhandled(state, event); };
+
+    template <typename State, typename Event>
+    static constexpr bool s_isUnhandled = false;
+
+    // the compiler output names the pair: "In instantiation of ... unhandledTransition() [with State = ...; Event = ...]"
+    template <typename State, typename Event>
+    static constexpr void unhandledTransition()
+    {
+        static_assert(s_isUnhandled<State, Event>, "FSM_STRICT_TRANSITIONS: no on_event(State &, Event &) for this state/event pair");
+    }
+
+    template <size_t S, size_t E>
+    static return_state_t handle(Derived &child, StateVariant &states, EventVariant &events)
+    {
+        using State = std::variant_alternative_t<S, StateVariant>;
+        using Event = std::variant_alternative_t<E, EventVariant>;
+
+        State &state = *std::get_if<S>(&states);
+        Event &event = *std::get_if<E>(&events);
+
+        if constexpr (s_hasTransition<State, Event>)
+        {
+            return child.on_event(state, event);
+        }
+        else if constexpr (FSM_STRICT_TRANSITIONS)
+        {
+            unhandledTransition<State, Event>();
+            return std::nullopt;
+        }
+        else if constexpr (s_hasFallback<State, Event>)
+        {
+            if constexpr (std::is_void_v<decltype(child.on_unhandled(state, event))>)
+            {
+                child.on_unhandled(state, event);
+                return std::nullopt;
+            }
+            else
+            {
+                return child.on_unhandled(state, event);
+            }
+        }
+        else
+        {
+            return std::nullopt;
+        }
+    }
+
+    // the pairs without a handler share one function instead of an empty handle<S, E> each
+    static return_state_t ignore(Derived &, StateVariant &, EventVariant &)
+    {
+        return std::nullopt;
+    }
+
+    template <size_t S, size_t E>
+    static constexpr handler_t handlerOf()
+    {
+        using State = std::variant_alternative_t<S, StateVariant>;
+        using Event = std::variant_alternative_t<E, EventVariant>;
+
+        if constexpr (!s_hasTransition<State, Event> && !s_hasFallback<State, Event> && !FSM_STRICT_TRANSITIONS)
+            return &ignore;
+        else
+            return &handle<S, E>;
+    }
+
+    template <size_t S, size_t... Es>
+    static constexpr std::array<handler_t, sizeof...(Es)> makeRow(std::index_sequence<Es...>)
+    {
+        return {handlerOf<S, Es>()...};
+    }
+
+    // spelled out, std::array{row} of a single row would deduce a copy of the row
+    template <size_t... Ss>
+    static constexpr std::array<std::array<handler_t, std::variant_size_v<EventVariant>>, sizeof...(Ss)> makeTable(std::index_sequence<Ss...>)
+    {
+        return {makeRow<Ss>(std::make_index_sequence<std::variant_size_v<EventVariant>>{})...};
+    }
+};
+
+#endif // __FSM_DISPATCH_TABLE_H__
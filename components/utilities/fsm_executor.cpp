@@ -0,0 +1,68 @@
+#include "fsm_executor.h"
+
+FsmExecutor::FsmExecutor(uint32_t taskSize, uint8_t priority, const char *name, BaseType_t xCoreID)
+{
+    configASSERT(pdPASS == xTaskCreatePinnedToCore(s_mainTaskFunc, name, taskSize, this, priority, &m_task, xCoreID));
+    configASSERT(m_task != nullptr);
+}
+
+// the executor task walks the list without locking, a member is fully linked before it is published
+void FsmExecutor::Add(member_t &member)
+{
+    portENTER_CRITICAL(&m_membersLock);
+
+    std::atomic<member_t *> *link = &m_members;
+    member_t *next = link->load(std::memory_order_relaxed);
+    while (next != nullptr && next->priority >= member.priority)
+    {
+        link = &next->next;
+        next = link->load(std::memory_order_relaxed);
+    }
+
+    member.next.store(next, std::memory_order_relaxed);
+    link->store(&member, std::memory_order_release);
+
+    portEXIT_CRITICAL(&m_membersLock);
+}
+
+void FsmExecutor::s_mainTaskFunc(void *arg)
+{
+    FsmExecutor *This = reinterpret_cast<FsmExecutor *>(arg);
+    This->mainTaskFunc();
+}
+
+void FsmExecutor::mainTaskFunc()
+{
+    for (;;)
+    {
+        // every queued event notifies after it is published, so nothing is left behind once a round handles nothing
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (runRound())
+        {
+        }
+    }
+}
+
+// handle one event of every fsm of the highest priority that has pending events, return false if none had any
+bool FsmExecutor::runRound()
+{
+    member_t *member = m_members.load(std::memory_order_acquire);
+    while (member != nullptr)
+    {
+        uint8_t priority = member->priority;
+        bool handled = false;
+
+        for (; member != nullptr && member->priority == priority; member = member->next.load(std::memory_order_acquire))
+        {
+            handled |= member->step(member->fsm);
+        }
+
+        if (handled)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,71 @@
+#ifndef __FSM_EXECUTOR_H__
+#define __FSM_EXECUTOR_H__
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstdint>
+
+/*
+    FsmExecutor runs any number of FsmTask state machines on a single freertos task, instead of a task (and a stack)
+    per fsm. Each fsm keeps its own event ring, Dispatch()/IsInState() etc. are unchanged.
+
+    The executor handles events in rounds: every fsm of the highest priority that has pending events handles one
+    event, then the next round starts again from the highest priority. So fsms of the same priority share the task
+    round robin, and an fsm with a burst of events can not starve the others of its priority.
+    Create one executor per core to spread the fsms over both cores.
+
+    example:
+        FsmExecutor executor{4096, 5, "fsm_executor"};
+
+        class ButtonFSM : public FsmTask<ButtonFSM, states, events>
+        {
+        public:
+            ButtonFSM(FsmExecutor &executor) : FsmTask(executor, 1) {} // instead of FsmTask(2048, 3, "button_fsm")
+            ...
+        };
+
+        ButtonFSM button{executor};
+        button.Start();
+        button.Dispatch(press_event{});
+
+    NOTICE - handlers of all the fsms share the executor's stack, size it for the deepest handler
+    NOTICE - a blocking handler blocks every fsm of the executor
+*/
+class FsmExecutor
+{
+public:
+    // an fsm registered to the executor, embedded in the fsm
+    struct member_t
+    {
+        bool (*step)(void *fsm); // handle at most one pending event, return false if there was none
+        void *fsm;
+        uint8_t priority;
+        std::atomic<member_t *> next{nullptr};
+    };
+
+    // Create the executor task
+    FsmExecutor(uint32_t taskSize, uint8_t priority, const char *name, BaseType_t xCoreID = tskNO_AFFINITY);
+
+    FsmExecutor(const FsmExecutor &) = delete;
+    FsmExecutor &operator=(const FsmExecutor &) = delete;
+
+    // Register an fsm, higher priority fsms are handled first. Members can not be removed
+    void Add(member_t &member);
+
+    // Wake the executor after an event was queued to one of its fsms
+    void Notify() { xTaskNotifyGive(m_task); }
+    void NotifyFromISR(BaseType_t *const xHigherPriorityTaskWoken) { vTaskNotifyGiveFromISR(m_task, xHigherPriorityTaskWoken); }
+
+private:
+    static void s_mainTaskFunc(void *arg);
+
+    void mainTaskFunc();
+    bool runRound();
+
+    TaskHandle_t m_task{};
+    std::atomic<member_t *> m_members{nullptr}; // sorted by priority, highest first
+    portMUX_TYPE m_membersLock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // __FSM_EXECUTOR_H__
@@ -0,0 +1,335 @@
+#ifndef __FSM_FUZZ_H__
+#define __FSM_FUZZ_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "esp_timer.h"
+#include "baozi_log.h"
+
+/*
+    FsmFuzzer drives an fsm with event sequences under a virtual clock and checks invariants after every step, to exercise
+    fsms like Wifi and MqttClient on the host (IDF linux target, with the esp_wifi/esp-mqtt calls of their handlers faked)
+    instead of on hardware.
+
+    Run() takes random steps that are reproducible from the seed - each step either dispatches a random event or advances
+    the virtual clock by up to maxAdvanceMs. Dispatch() and Advance() take scripted steps.
+    Events are made by their generator, events that are default constructible are generated as {} unless given one.
+    A failing seed fails the same way on every run, Print() shows the steps that led to the failure.
+
+    example:
+        MqttClient mqtt;
+        FsmFuzzer<MqttClient, MqttFSM::Events> fuzzer{mqtt, seed};
+        fuzzer.SetGenerator<MqttFSM::EVENT_INCOMING_DATA>([](FsmFuzzRandom &random) { return MqttFSM::EVENT_INCOMING_DATA{...}; });
+        fuzzer.AddInvariant("subscribed while connected", [&](uint32_t) { return !mqtt.IsConnected() || mqtt.UnsubscribedCount() == 0; });
+        fuzzer.AddMaxDwell<MqttFSM::STATE_CONNECTING>("not stuck connecting", 60000);
+
+        auto report = fuzzer.Run(100000);
+        if (!report.passed)
+            fuzzer.Print(); // seed 1234 failed "not stuck connecting" at step 5321 (63100 ms), last steps: ...
+
+    NOTICE - invariants are checked as soon as Dispatch() returns, which suits FsmTaskless (the event is handled in the
+             caller). An FsmTask handles the event later on its own task
+    NOTICE - eventsPerSecond includes generating the events and checking the invariants
+*/
+
+// xorshift32 - the same sequence for a seed on every platform, unlike the std distributions
+class FsmFuzzRandom
+{
+public:
+    explicit FsmFuzzRandom(uint32_t seed) : m_state(seed != 0 ? seed : 0x9E3779B9) {}
+
+    uint32_t Next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    // a number in [0, bound)
+    uint32_t Below(uint32_t bound) { return bound == 0 ? 0 : Next() % bound; }
+
+    bool Percent(uint32_t percent) { return Below(100) < percent; }
+
+private:
+    uint32_t m_state;
+};
+
+template <typename Fsm, typename EventVariant>
+class FsmFuzzer
+{
+public:
+    static constexpr size_t EVENTS = std::variant_size_v<EventVariant>;
+    static constexpr size_t HISTORY = 16;
+
+    using generator_t = std::function<EventVariant(FsmFuzzRandom &)>;
+    using invariant_t = std::function<bool(uint32_t nowMs)>;
+    using advance_t = std::function<void(uint32_t nowMs)>;
+
+    struct report_t
+    {
+        uint32_t seed;
+        uint32_t steps;
+        uint32_t events;
+        uint32_t nowMs;
+        uint32_t eventsPerSecond;
+        bool passed;
+        const char *violation; // name of the first invariant that failed
+        uint32_t violationStep;
+    };
+
+    FsmFuzzer(Fsm &fsm, uint32_t seed, uint32_t maxAdvanceMs = 1000, uint32_t advancePercent = 20)
+        : m_fsm(fsm), m_random(seed), m_seed(seed), m_maxAdvanceMs(maxAdvanceMs), m_advancePercent(advancePercent)
+    {
+        setDefaultGenerators(std::make_index_sequence<EVENTS>{});
+    }
+
+    // Generate Event with generator - a callable taking (FsmFuzzRandom &) and returning the event
+    template <typename Event, typename F>
+    void SetGenerator(F &&generator)
+    {
+        static_assert(indexOf<Event>() < EVENTS, "Event is not one of EventVariant");
+        m_generators[indexOf<Event>()] = [generator = std::forward<F>(generator)](FsmFuzzRandom &random)
+        { return EventVariant{generator(random)}; };
+    }
+
+    // Never generate Event at random
+    template <typename Event>
+    void Disable() { m_generators[indexOf<Event>()] = nullptr; }
+
+    // invariant is called after every step with the virtual time, and fails the run when it returns false
+    void AddInvariant(const char *name, invariant_t invariant) { m_invariants.push_back({name, std::move(invariant)}); }
+
+    // Fail the run when the fsm stays in State longer than maxMs of virtual time
+    template <typename State>
+    void AddMaxDwell(const char *name, uint32_t maxMs)
+    {
+        m_dwells.push_back({name, maxMs, [this]() { return m_fsm.template IsInState<State>(); }, 0, false});
+    }
+
+    // onAdvance is called whenever the virtual clock moves, e.g. to dispatch the timeouts that are due
+    void OnAdvance(advance_t onAdvance) { m_onAdvance = std::move(onAdvance); }
+
+    // Scripted step - dispatch event, return false if an invariant failed (now or before)
+    bool Dispatch(EventVariant event)
+    {
+        record(event.index());
+        m_fsm.Dispatch(std::move(event));
+        m_events++;
+        return check();
+    }
+
+    // Scripted step - advance the virtual clock, return false if an invariant failed (now or before)
+    bool Advance(uint32_t ms)
+    {
+        m_nowMs += ms;
+        record(ADVANCE);
+        if (m_onAdvance)
+            m_onAdvance(m_nowMs);
+
+        return check();
+    }
+
+    // Take steps random steps, stops at the first failed invariant
+    report_t Run(uint32_t steps)
+    {
+        int64_t start = esp_timer_get_time();
+        uint32_t startEvents = m_events;
+
+        for (uint32_t i = 0; i < steps && m_violation == nullptr; i++)
+        {
+            if (m_random.Percent(m_advancePercent))
+                Advance(1 + m_random.Below(m_maxAdvanceMs));
+            else
+                Dispatch(randomEvent());
+        }
+
+        int64_t elapsedUs = esp_timer_get_time() - start;
+        m_eventsPerSecond = elapsedUs > 0 ? static_cast<uint32_t>((m_events - startEvents) * 1000000ll / elapsedUs) : 0;
+        return Report();
+    }
+
+    report_t Report() const
+    {
+        return {
+            .seed = m_seed,
+            .steps = m_steps,
+            .events = m_events,
+            .nowMs = m_nowMs,
+            .eventsPerSecond = m_eventsPerSecond,
+            .passed = m_violation == nullptr,
+            .violation = m_violation,
+            .violationStep = m_violationStep,
+        };
+    }
+
+    // Log the report and the last HISTORY steps
+    void Print() const
+    {
+        if (m_violation != nullptr)
+            BAO_LOG_ERROR("seed %lu failed \"%s\" at step %lu (%lu ms)", (unsigned long)m_seed, m_violation, (unsigned long)m_violationStep, (unsigned long)m_nowMs);
+        else
+            BAO_LOG_INFO("seed %lu passed %lu steps, %lu events (%lu events/s)", (unsigned long)m_seed, (unsigned long)m_steps, (unsigned long)m_events, (unsigned long)m_eventsPerSecond);
+
+        size_t count = m_steps < HISTORY ? m_steps : HISTORY;
+        for (size_t i = m_steps - count; i < m_steps; i++)
+        {
+            const step_t &step = m_history[i % HISTORY];
+            if (step.event == ADVANCE)
+                BAO_LOG_INFO("  step %lu: %lu ms", (unsigned long)i, (unsigned long)step.nowMs);
+            else
+                BAO_LOG_INFO("  step %lu: %lu ms %s(%u)", (unsigned long)i, (unsigned long)step.nowMs, nameOf(step.event), (unsigned)step.event);
+        }
+    }
+
+    uint32_t NowMs() const { return m_nowMs; }
+    FsmFuzzRandom &Random() { return m_random; }
+
+private:
+    static constexpr size_t ADVANCE = EVENTS; // history entry of a clock step
+
+    struct step_t
+    {
+        uint32_t nowMs;
+        size_t event;
+    };
+
+    struct named_invariant_t
+    {
+        const char *name;
+        invariant_t invariant;
+    };
+
+    struct dwell_t
+    {
+        const char *name;
+        uint32_t maxMs;
+        std::function<bool()> isInState;
+        uint32_t enteredMs;
+        bool wasInState;
+    };
+
+    Fsm &m_fsm;
+    FsmFuzzRandom m_random;
+    uint32_t m_seed;
+    uint32_t m_maxAdvanceMs;
+    uint32_t m_advancePercent;
+    std::array<generator_t, EVENTS> m_generators{};
+    std::vector<named_invariant_t> m_invariants;
+    std::vector<dwell_t> m_dwells;
+    advance_t m_onAdvance;
+    std::array<step_t, HISTORY> m_history{};
+    uint32_t m_steps{};
+    uint32_t m_events{};
+    uint32_t m_nowMs{};
+    uint32_t m_eventsPerSecond{};
+    const char *m_violation{};
+    uint32_t m_violationStep{};
+
+    template <typename Event>
+    static constexpr size_t indexOf()
+    {
+        return []<size_t... Is>(std::index_sequence<Is...>)
+        {
+            size_t index = EVENTS;
+            ((std::is_same_v<Event, std::variant_alternative_t<Is, EventVariant>> ? index = Is : 0), ...);
+            return index;
+        }(std::make_index_sequence<EVENTS>{});
+    }
+
+    template <size_t... Is>
+    void setDefaultGenerators(std::index_sequence<Is...>)
+    {
+        ((m_generators[Is] = defaultGenerator<std::variant_alternative_t<Is, EventVariant>>()), ...);
+    }
+
+    template <typename Event>
+    static generator_t defaultGenerator()
+    {
+        if constexpr (std::is_default_constructible_v<Event>)
+            return [](FsmFuzzRandom &) { return EventVariant{Event{}}; };
+        else
+            return nullptr;
+    }
+
+    template <size_t... Is>
+    static const char *nameOf(size_t index, std::index_sequence<Is...>)
+    {
+        static constexpr std::array<const char *, sizeof...(Is)> names{nameOrNull<std::variant_alternative_t<Is, EventVariant>>()...};
+        return names[index] != nullptr ? names[index] : "?";
+    }
+
+    static const char *nameOf(size_t index) { return nameOf(index, std::make_index_sequence<EVENTS>{}); }
+
+    template <typename T>
+    static constexpr const char *nameOrNull()
+    {
+        if constexpr (requires { T::NAME; })
+            return T::NAME;
+        else
+            return nullptr;
+    }
+
+    EventVariant randomEvent()
+    {
+        size_t enabled = 0;
+        for (const generator_t &generator : m_generators)
+            enabled += generator != nullptr;
+
+        configASSERT(enabled > 0);
+
+        // the pick-th enabled generator
+        size_t index = 0;
+        for (uint32_t pick = m_random.Below(enabled); m_generators[index] == nullptr || pick-- > 0; index++)
+        {
+        }
+
+        return m_generators[index](m_random);
+    }
+
+    void record(size_t event)
+    {
+        m_history[m_steps % HISTORY] = {m_nowMs, event};
+        m_steps++;
+    }
+
+    bool check()
+    {
+        if (m_violation != nullptr)
+            return false;
+
+        for (const named_invariant_t &invariant : m_invariants)
+        {
+            if (!invariant.invariant(m_nowMs))
+                return fail(invariant.name);
+        }
+
+        for (dwell_t &dwell : m_dwells)
+        {
+            bool isInState = dwell.isInState();
+            if (isInState && !dwell.wasInState)
+                dwell.enteredMs = m_nowMs;
+
+            dwell.wasInState = isInState;
+            if (isInState && m_nowMs - dwell.enteredMs > dwell.maxMs)
+                return fail(dwell.name);
+        }
+
+        return true;
+    }
+
+    bool fail(const char *name)
+    {
+        m_violation = name;
+        m_violationStep = m_steps - 1;
+        return false;
+    }
+};
+
+#endif // __FSM_FUZZ_H__
@@ -0,0 +1,138 @@
+#ifndef __FSM_SNAPSHOT_H__
+#define __FSM_SNAPSHOT_H__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "esp_rom_crc.h"
+
+/*
+    FsmSnapshot keeps the state of an FsmTask/FsmTaskless across deep sleep, placed in RTC memory that is not
+    initialized on wake, so the fsm resumes where it was instead of starting over from the first state.
+
+    example:
+        RTC_NOINIT_ATTR static FsmSnapshot<SensorFSM::States> s_sensorSnapshot;
+
+        sensor.StartFromSnapshot(s_sensorSnapshot); // instead of sensor.Start()
+        ...
+        sensor.SaveSnapshot(s_sensorSnapshot); // right before esp_deep_sleep_start()
+
+    The snapshot holds the index and the bytes of the current state, a fingerprint of the state types and a crc.
+    A snapshot that does not check out (garbage after power on, a firmware with other states) is ignored, and a snapshot
+    is used once - taking it invalidates the region, so a reset after the wake starts from scratch unless saved again.
+
+    NOTICE - the fsm resumes in the saved state with on_entry called for it, drivers the state stands for (wifi, mqtt
+             sessions) do not survive deep sleep, on_entry has to bring them back or those fsms should not resume
+    NOTICE - every state must be trivially copyable, a state holding a pointer or a handle would resume dangling
+*/
+template <typename StateVariant>
+class FsmSnapshot
+{
+    static_assert([]<typename... States>(std::variant<States...> *)
+                  { return (std::is_trivially_copyable_v<States> && ...); }(static_cast<StateVariant *>(nullptr)),
+                  "only trivially copyable states can be kept in a snapshot");
+
+public:
+    // Save the current state, call it from the fsm context or while the fsm is idle
+    void Save(const StateVariant &states)
+    {
+        m_magic = 0; // invalid while being written
+        m_index = states.index();
+        std::fill(std::begin(m_payload), std::end(m_payload), std::byte{0});
+        std::visit([&](const auto &state)
+                   { std::memcpy(m_payload, &state, sizeof(state)); },
+                   states);
+
+        m_fingerprint = s_fingerprint;
+        m_magic = MAGIC;
+        m_crc = crc();
+    }
+
+    // The saved state if the snapshot is valid, the snapshot is invalidated either way
+    std::optional<StateVariant> Take()
+    {
+        std::optional<StateVariant> state;
+        if (IsValid())
+            state = restore(std::make_index_sequence<std::variant_size_v<StateVariant>>{});
+
+        Invalidate();
+        return state;
+    }
+
+    bool IsValid() const
+    {
+        return m_magic == MAGIC && m_fingerprint == s_fingerprint && m_index < std::variant_size_v<StateVariant> && m_crc == crc();
+    }
+
+    void Invalidate() { m_magic = 0; }
+
+private:
+    static constexpr uint32_t MAGIC = 0x42414F53; // "BAOS"
+
+    // differs between firmwares whose state types differ by name or size (__PRETTY_FUNCTION__ names StateVariant)
+    static constexpr uint32_t fingerprint()
+    {
+        std::string_view signature = __PRETTY_FUNCTION__;
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (char c : signature)
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+
+        return hash;
+    }
+
+    static constexpr uint32_t sizesHash()
+    {
+        return []<typename... States>(std::variant<States...> *)
+        {
+            uint32_t hash = 2166136261u;
+            ((hash = (hash ^ static_cast<uint32_t>(sizeof(States))) * 16777619u), ...);
+            return hash;
+        }(static_cast<StateVariant *>(nullptr));
+    }
+
+    static constexpr uint32_t s_fingerprint = fingerprint() ^ sizesHash();
+
+    static constexpr size_t PAYLOAD_SIZE = []<typename... States>(std::variant<States...> *)
+    { return std::max({sizeof(States)...}); }(static_cast<StateVariant *>(nullptr));
+
+    static constexpr size_t PAYLOAD_ALIGN = []<typename... States>(std::variant<States...> *)
+    { return std::max({alignof(States)...}); }(static_cast<StateVariant *>(nullptr));
+
+    uint32_t crc() const
+    {
+        uint32_t crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(&m_magic), sizeof(m_magic));
+        crc = esp_rom_crc32_le(crc, reinterpret_cast<const uint8_t *>(&m_fingerprint), sizeof(m_fingerprint));
+        crc = esp_rom_crc32_le(crc, reinterpret_cast<const uint8_t *>(&m_index), sizeof(m_index));
+        return esp_rom_crc32_le(crc, reinterpret_cast<const uint8_t *>(m_payload), sizeof(m_payload));
+    }
+
+    template <size_t... Is>
+    StateVariant restore(std::index_sequence<Is...>) const
+    {
+        using restore_t = StateVariant (*)(const std::byte *);
+        static constexpr restore_t restorers[] = {[](const std::byte *payload)
+                                                  {
+                                                      using State = std::variant_alternative_t<Is, StateVariant>;
+                                                      return StateVariant{std::in_place_index<Is>, *std::launder(reinterpret_cast<const State *>(payload))};
+                                                  }...};
+
+        return restorers[m_index](m_payload);
+    }
+
+    // no default member initializers - the region must stay trivial, a constructor would wipe it on every boot
+    uint32_t m_magic;
+    uint32_t m_fingerprint;
+    uint32_t m_index;
+    uint32_t m_crc;
+    alignas(PAYLOAD_ALIGN) std::byte m_payload[PAYLOAD_SIZE];
+};
+
+#endif // __FSM_SNAPSHOT_H__
@@ -3,9 +3,19 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <variant>
 #include <optional>
+#include <type_traits>
+#include "fsm_dispatch_table.h"
+#include "fsm_snapshot.h"
+#include "fsm_executor.h"
 
 /*  Finite state machine running over a freertos task.
     This implementation of the fsm class is based on Mateusz Pusz mpusz/fsm-variant repository presented in his cppCon talk.
@@ -33,12 +43,11 @@
     public:
         ButtonFSM() : FsmTask(2048, 3, "button_fsm") {}
 
-        //DEFAULT_HANDLER, will be invoked for undefined state/events
+        //DEFAULT_HANDLER, will be invoked for state/events without an on_event (see fsm_dispatch_table.h)
         template <typename State, typename Event>
-        auto on_event(State &, const Event &)
+        void on_unhandled(State &, const Event &)
         {
-            printf("got an unknown event!");
-            return std::nullopt; //return null option because state havn't changed
+            printf("got an unknown event!"); //state does not change
         }
 
         //handler for idle state, press event
@@ -85,7 +94,7 @@
     button.Start();
 
     bool dispatchedSuccessfully = button.Dispatch(press_event{});
-    configASSERT(dispatchedSuccessfully); // Check if dispatched successfully, otherwise might be better to enlarge event queue
+    configASSERT(dispatchedSuccessfully); // Check if dispatched successfully, otherwise might be better to enlarge event queue (FsmTask<ButtonFSM, states, events, 8>)
     configASSERT(button.IsInState<state_pressed>());
 
     button.Dispatch(timer_event{3_sec});
@@ -112,20 +121,125 @@
 #define CALL_ON_STATE_EXIT 0
 #endif
 
-template <typename Derived, typename StateVariant, typename EventVariant>
+// define as 1 to trace every dispatch (see fsm_trace.h)
+#ifndef FSM_TRACE_ENABLED
+#define FSM_TRACE_ENABLED 0
+#endif
+
+#if FSM_TRACE_ENABLED
+#include "fsm_trace.h"
+#endif
+
+/*
+    Events may declare how they are queued with a static constexpr FsmEventPolicy POLICY member, events without one
+    are queued in order and rejected once the queue stays full for the dispatch timeout.
+    - coalesce: the event replaces a pending event of the same type (which moves to the back of the queue), for events
+      where only the latest matters like sensor ticks or "published" notifications
+    - urgent: the event is queued in a lane of its own (URGENT_QUEUE_SIZE slots) that is always handled first, so urgent
+      events neither wait behind routine ones nor find their slots taken by a burst of them
+    - dropOldest: when its lane is full, the oldest pending event of the lane is dropped to make room for the event
+
+    example:
+        struct EVENT_SensorTick
+        {
+            static constexpr FsmEventPolicy POLICY{.coalesce = true, .dropOldest = true};
+            float temperature;
+        };
+        struct EVENT_Alarm
+        {
+            static constexpr FsmEventPolicy POLICY{.urgent = true};
+        };
+
+    GetQueueStats() counts the coalesced, dropped and rejected events and the peak depth of each lane.
+*/
+struct FsmEventPolicy
+{
+    bool coalesce = false;
+    bool urgent = false;
+    bool dropOldest = false;
+};
+
+template <typename Event>
+constexpr FsmEventPolicy fsmEventPolicy()
+{
+    if constexpr (requires { Event::POLICY; })
+        return Event::POLICY;
+    else
+        return {};
+}
+
+// where the task runs and how it drains, after the task info: FsmTask(4096, 5, "name", {.xCoreID = 1})
+struct FsmTaskOptions
+{
+    BaseType_t xCoreID = tskNO_AFFINITY;
+    bool drainAll = true;
+};
+
+// one urgent slot if any of the events is urgent, none otherwise
+template <typename... Events>
+constexpr size_t fsmUrgentQueueSize(const std::variant<Events...> *)
+{
+    return (fsmEventPolicy<Events>().urgent || ...) ? 1 : 0;
+}
+
+/*
+    Events are kept in statically allocated EventVariant slots owned by the FsmTask.
+    Dispatch() move-constructs the event into a free slot (placement new), queues the slot and wakes the task with a
+    task notification, the task handles the event in place and destroys it, so events holding std::string, BaoJson etc.
+    are safe to dispatch. A counting semaphore per lane tracks the free slots, so Dispatch() can block until one frees up
+    (timeout).
+
+    By default the task drains every pending event on each wakeup, pass FsmTaskOptions{.drainAll = false} to handle one
+    event per wakeup (and let other tasks of the same priority run in between).
+
+    Constructed with an FsmExecutor instead of task info, the fsm creates no task and is run by the executor together
+    with its other fsms (see fsm_executor.h), the api is the same.
+
+    NOTICE - DispatchFromISR() moves the event (and destroys a coalesced or dropped one) in ISR context,
+             only dispatch events that move and destroy without allocating
+*/
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE = 3,
+          size_t URGENT_QUEUE_SIZE = fsmUrgentQueueSize(static_cast<EventVariant *>(nullptr))>
 class FsmTask
 {
-    static constexpr uint8_t EVENT_QUEUE_DEFAULT_SIZE{3};
+    static constexpr size_t SLOTS = EVENT_QUEUE_SIZE + URGENT_QUEUE_SIZE;
+
+    static_assert(EVENT_QUEUE_SIZE > 0, "the event queue must hold at least one event");
+    static_assert(SLOTS <= 32, "the free slots are tracked in a 32 bit mask");
+    static_assert(URGENT_QUEUE_SIZE > 0 || fsmUrgentQueueSize(static_cast<EventVariant *>(nullptr)) == 0, "urgent events need an urgent queue");
 
 public:
+    struct queue_stats_t
+    {
+        uint32_t coalesced;     // pending events replaced by a newer one of the same type
+        uint32_t droppedOldest; // pending events dropped to make room for a dropOldest event
+        uint32_t rejected;      // events Dispatch() returned false for because their lane was full
+        uint8_t peakDepth;      // most slots of the lane in use at once
+        uint8_t peakUrgentDepth;
+    };
+
     // Create the FSM Task
-    FsmTask(uint32_t taskSize, uint8_t priority, const char *name, uint8_t eventQueueSize = EVENT_QUEUE_DEFAULT_SIZE, BaseType_t xCoreID = tskNO_AFFINITY);
+    FsmTask(uint32_t taskSize, uint8_t priority, const char *name, FsmTaskOptions options = {});
+
+    // the queue size used to be the 4th argument, it is the EVENT_QUEUE_SIZE template argument now
+    template <typename T>
+        requires std::is_integral_v<T>
+    FsmTask(uint32_t taskSize, uint8_t priority, const char *name, T eventQueueSize, ...) = delete;
+
+    // Create the FSM on a shared executor task, priority among the executor's fsms
+    FsmTask(FsmExecutor &executor, uint8_t priority = 0);
 
     // Start the FSM Task
     void Start();
     void Start(StateVariant &&state);
 
-    // Dispatch an event to state machine
+    // Start in the state saved in a valid snapshot (see fsm_snapshot.h), otherwise like Start(), return whether it resumed
+    bool StartFromSnapshot(FsmSnapshot<StateVariant> &snapshot);
+
+    // Save the current state to a snapshot kept across deep sleep, call it while the fsm is idle
+    void SaveSnapshot(FsmSnapshot<StateVariant> &snapshot) const { snapshot.Save(m_states); }
+
+    // Dispatch an event to state machine according to its POLICY, waits up to timeout for a free slot
     template <typename Event>
     bool Dispatch(Event &&event, TickType_t timeout = 0);
 
@@ -137,6 +251,14 @@ public:
     bool IsInState() const { return std::holds_alternative<State>(m_states); }
     bool IsRunning() const { return m_isRunning; }
 
+    // The queue counters since the fsm was created
+    queue_stats_t GetQueueStats() const;
+
+#if FSM_TRACE_ENABLED
+    // The recent dispatches and their durations
+    const FsmTracer<StateVariant, EventVariant> &GetTracer() const { return m_tracer; }
+#endif
+
 protected:
     // Get the state if the state is the requested otherwise asserts
     template <class State>
@@ -151,86 +273,250 @@ protected:
     StateVariant &GetStates() { return m_states; }
 
 private:
+    static constexpr size_t NORMAL_LANE = 0;
+    static constexpr size_t URGENT_LANE = 1;
+    static constexpr size_t ANY_EVENT = SIZE_MAX;
+
+    struct slot_t
+    {
+        alignas(EventVariant) std::byte storage[sizeof(EventVariant)];
+        size_t eventIndex; // of the queued event, to find the one to coalesce with
+    };
+
+    // a lane owns a range of the slots and keeps its queued slots oldest first
+    struct lane_t
+    {
+        uint32_t freeSlots; // bit per free slot
+        uint8_t size;
+        uint8_t peakDepth;
+        uint8_t pendingCount;
+        std::array<uint8_t, SLOTS> pending;
+        SemaphoreHandle_t freeCount;
+        StaticSemaphore_t freeCountBuffer;
+    };
+
     static void s_mainTaskFunc(void *arg);
+    static bool s_executorStep(void *arg);
 
     void mainTaskFunc();
-    void dispatch();
+    void enterInitialState();
+    void notify();
+    void initLanes();
+    template <typename Event>
+    static size_t indexOf(const Event &event);
+    static const FsmEventPolicy &policyOf(size_t eventIndex);
+    template <bool FROM_ISR>
+    int claimSlot(lane_t &lane, size_t eventIndex, TickType_t timeout);
+    template <bool FROM_ISR>
+    bool takeFreeCount(lane_t &lane, TickType_t timeout);
+    template <bool FROM_ISR>
+    int allocSlot(lane_t &lane);
+    template <bool FROM_ISR>
+    int takePending(lane_t &lane, size_t eventIndex, uint32_t &counter);
+    template <bool FROM_ISR>
+    void queueSlot(lane_t &lane, int slot, size_t eventIndex);
+    template <bool FROM_ISR>
+    void enterCritical() const;
+    template <bool FROM_ISR>
+    void exitCritical() const;
+    EventVariant *eventAt(size_t slot) { return std::launder(reinterpret_cast<EventVariant *>(m_slots[slot].storage)); }
+    bool handlePendingEvent();
+    void dispatch(EventVariant &event);
     void handleNewState(std::optional<StateVariant> &&newState);
 
-    bool m_isRunning{false};
+    std::atomic<bool> m_isRunning{false}; // an executor polls it from its task, set once the state is in place
+#if FSM_TRACE_ENABLED
+    FsmTracer<StateVariant, EventVariant> m_tracer;
+#endif
+    bool m_drainAll;
     StateVariant m_states{};
-    EventVariant m_events{};
     TaskHandle_t m_task{};
-    QueueHandle_t m_eventQueue{};
+    FsmExecutor *m_executor{};
+    FsmExecutor::member_t m_member{};
+    bool m_hasEntered{false}; // the initial on_entry ran, only used on an executor
+
+    std::array<slot_t, SLOTS> m_slots{};
+    std::array<lane_t, 2> m_lanes{};
+    queue_stats_t m_stats{}; // counters only, the peaks are kept by the lanes
+    mutable portMUX_TYPE m_queueLock = portMUX_INITIALIZER_UNLOCKED;
 };
 
 //----------------------- PUBLIC FUNTIONS IMPLEMENTATION ------------------------
 
 // CONSTRUCTOR
-template <typename Derived, typename StateVariant, typename EventVariant>
-FsmTask<Derived, StateVariant, EventVariant>::FsmTask(uint32_t taskSize, uint8_t priority, const char *name, uint8_t eventQueueSize, BaseType_t xCoreID)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::FsmTask(uint32_t taskSize, uint8_t priority, const char *name, FsmTaskOptions options)
+    : m_drainAll(options.drainAll)
 {
-    m_eventQueue = xQueueCreate(eventQueueSize, sizeof(EventVariant));
-    configASSERT(pdPASS == xTaskCreatePinnedToCore(s_mainTaskFunc, name, taskSize, this, priority, &m_task, xCoreID));
-    configASSERT(m_eventQueue != nullptr);
+    initLanes();
+    configASSERT(pdPASS == xTaskCreatePinnedToCore(s_mainTaskFunc, name, taskSize, this, priority, &m_task, options.xCoreID));
     configASSERT(m_task != nullptr);
 }
 
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::Start()
+// CONSTRUCTOR ON AN EXECUTOR
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::FsmTask(FsmExecutor &executor, uint8_t priority)
+    : m_drainAll(false), m_executor(&executor)
+{
+    initLanes();
+
+    m_member.step = s_executorStep;
+    m_member.fsm = this;
+    m_member.priority = priority;
+    executor.Add(m_member);
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::Start()
 {
     configASSERT(!m_isRunning);
 
     m_isRunning = true;
-    xTaskNotifyGive(m_task);
+    notify();
 }
 
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::Start(StateVariant &&state)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::Start(StateVariant &&state)
 {
     configASSERT(!m_isRunning);
 
-    m_isRunning = true;
     m_states = std::move(state);
-    xTaskNotifyGive(m_task);
+    m_isRunning = true;
+    notify();
+}
+
+// START FROM A SNAPSHOT
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::StartFromSnapshot(FsmSnapshot<StateVariant> &snapshot)
+{
+    std::optional<StateVariant> state = snapshot.Take();
+    if (!state)
+    {
+        Start();
+        return false;
+    }
+
+    Start(*std::move(state));
+    return true;
 }
 
 // DISPATCH AN EVENT
-template <typename Derived, typename StateVariant, typename EventVariant>
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
 template <typename Event>
-bool FsmTask<Derived, StateVariant, EventVariant>::Dispatch(Event &&event, TickType_t timeout)
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::Dispatch(Event &&event, TickType_t timeout)
 {
     if (!m_isRunning)
         return false;
 
-    EventVariant var{event};
-    return xQueueSend(m_eventQueue, &var, timeout) == pdTRUE;
+    size_t eventIndex = indexOf(event);
+    lane_t &lane = m_lanes[policyOf(eventIndex).urgent ? URGENT_LANE : NORMAL_LANE];
+    int slot = claimSlot<false>(lane, eventIndex, timeout);
+    if (slot < 0)
+        return false;
+
+    new (m_slots[slot].storage) EventVariant{std::forward<Event>(event)};
+    queueSlot<false>(lane, slot, eventIndex);
+    notify();
+    return true;
 }
 
 // DISPATCH AN EVENT FROM ISR
-template <typename Derived, typename StateVariant, typename EventVariant>
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
 template <typename Event>
-bool FsmTask<Derived, StateVariant, EventVariant>::DispatchFromISR(Event &&event, BaseType_t *const xHigherPriorityTaskWoken)
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::DispatchFromISR(Event &&event, BaseType_t *const xHigherPriorityTaskWoken)
+{
+    if (!m_isRunning)
+        return false;
+
+    size_t eventIndex = indexOf(event);
+    lane_t &lane = m_lanes[policyOf(eventIndex).urgent ? URGENT_LANE : NORMAL_LANE];
+    int slot = claimSlot<true>(lane, eventIndex, 0);
+    if (slot < 0)
+        return false;
+
+    new (m_slots[slot].storage) EventVariant{std::forward<Event>(event)};
+    queueSlot<true>(lane, slot, eventIndex);
+
+    if (m_executor != nullptr)
+        m_executor->NotifyFromISR(xHigherPriorityTaskWoken);
+    else
+        vTaskNotifyGiveFromISR(m_task, xHigherPriorityTaskWoken);
+    return true;
+}
+
+// QUEUE COUNTERS AND PEAKS
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+typename FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::queue_stats_t FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::GetQueueStats() const
 {
-    EventVariant var{event};
-    return xQueueSendFromISR(m_eventQueue, &var, xHigherPriorityTaskWoken) == pdTRUE;
+    enterCritical<false>();
+    queue_stats_t stats = m_stats;
+    stats.peakDepth = m_lanes[NORMAL_LANE].peakDepth;
+    stats.peakUrgentDepth = m_lanes[URGENT_LANE].peakDepth;
+    exitCritical<false>();
+
+    return stats;
 }
 
 //--------------------- TASK MANAGEMENT FUNCTIONS IMPLEMENTATION ----------------
 
 // MAIN TASK ENTRY FUNCTION
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::s_mainTaskFunc(void *arg)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::s_mainTaskFunc(void *arg)
 {
     FsmTask *This = reinterpret_cast<FsmTask *>(arg);
     This->mainTaskFunc();
 }
 
 // MAIN TASK LOOP
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::mainTaskFunc()
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::mainTaskFunc()
 {
     ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+    enterInitialState();
+
+    for (;;)
+    {
+        // every queued event notifies once - drain all clears the count, otherwise it is taken one event at a time
+        // (a coalesced or dropped event notified too, its wakeup finds nothing to handle)
+        ulTaskNotifyTake(m_drainAll ? pdTRUE : pdFALSE, portMAX_DELAY);
+
+        if (m_drainAll)
+        {
+            while (handlePendingEvent())
+            {
+            }
+        }
+        else
+        {
+            handlePendingEvent();
+        }
+    }
+}
+
+// EXECUTOR STEP - ENTER THE INITIAL STATE ONCE STARTED, THEN HANDLE ONE EVENT PER CALL
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::s_executorStep(void *arg)
+{
+    FsmTask *This = reinterpret_cast<FsmTask *>(arg);
+    if (!This->m_isRunning)
+        return false;
+
+    if (!This->m_hasEntered)
+    {
+        This->m_hasEntered = true;
+        This->enterInitialState();
+        return true;
+    }
+
+    return This->handlePendingEvent();
+}
+
+//------------------------ PRIVATE FUNTIONS IMPLEMENTATION ----------------------
+
+// CALL on_entry OF THE STATE THE FSM STARTS IN
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::enterInitialState()
+{
     if constexpr (CALL_ON_STATE_ENTRY)
     {
         Derived &child = static_cast<Derived &>(*this);
@@ -238,32 +524,242 @@ void FsmTask<Derived, StateVariant, EventVariant>::mainTaskFunc()
                    { child.on_entry(stateVar); },
                    m_states);
     }
+}
 
-    for (;;)
+// WAKE WHOEVER RUNS THE FSM
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::notify()
+{
+    if (m_executor != nullptr)
+        m_executor->Notify();
+    else
+        xTaskNotifyGive(m_task);
+}
+
+// THE NORMAL LANE OWNS THE FIRST EVENT_QUEUE_SIZE SLOTS, THE URGENT LANE THE REST
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::initLanes()
+{
+    m_lanes[NORMAL_LANE].size = EVENT_QUEUE_SIZE;
+    m_lanes[NORMAL_LANE].freeSlots = (1ull << EVENT_QUEUE_SIZE) - 1;
+    m_lanes[URGENT_LANE].size = URGENT_QUEUE_SIZE;
+    m_lanes[URGENT_LANE].freeSlots = ((1ull << URGENT_QUEUE_SIZE) - 1) << EVENT_QUEUE_SIZE;
+
+    for (lane_t &lane : m_lanes)
     {
-        xQueueReceive(m_eventQueue, &m_events, portMAX_DELAY);
-        dispatch();
+        if (lane.size == 0)
+            continue;
+
+        lane.freeCount = xSemaphoreCreateCountingStatic(lane.size, lane.size, &lane.freeCountBuffer);
+        configASSERT(lane.freeCount != nullptr);
     }
 }
 
-//------------------------ PRIVATE FUNTIONS IMPLEMENTATION ----------------------
+// INDEX OF THE EVENT IN EventVariant, KNOWN AT COMPILE TIME UNLESS THE EVENT IS AN EventVariant ITSELF
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <typename Event>
+size_t FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::indexOf(const Event &event)
+{
+    if constexpr (std::is_same_v<Event, EventVariant>)
+    {
+        return event.index();
+    }
+    else
+    {
+        constexpr size_t index = []<size_t... Is>(std::index_sequence<Is...>)
+        {
+            size_t found = ANY_EVENT;
+            ((std::is_same_v<Event, std::variant_alternative_t<Is, EventVariant>> ? found = Is : 0), ...);
+            return found;
+        }(std::make_index_sequence<std::variant_size_v<EventVariant>>{});
+
+        static_assert(index != ANY_EVENT, "dispatch one of the EventVariant events, or an EventVariant");
+        return index;
+    }
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+const FsmEventPolicy &FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::policyOf(size_t eventIndex)
+{
+    static constexpr auto policies = []<size_t... Is>(std::index_sequence<Is...>)
+    {
+        return std::array<FsmEventPolicy, sizeof...(Is)>{fsmEventPolicy<std::variant_alternative_t<Is, EventVariant>>()...};
+    }(std::make_index_sequence<std::variant_size_v<EventVariant>>{});
+
+    return policies[eventIndex];
+}
+
+// TAKE A SLOT FOR THE EVENT ACCORDING TO ITS POLICY, -1 IF THE LANE STAYED FULL
+// the slot is owned by the caller until it is queued, it holds no event
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+int FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::claimSlot(lane_t &lane, size_t eventIndex, TickType_t timeout)
+{
+    const FsmEventPolicy &policy = policyOf(eventIndex);
+
+    if (policy.coalesce)
+    {
+        int slot = takePending<FROM_ISR>(lane, eventIndex, m_stats.coalesced);
+        if (slot >= 0)
+            return slot;
+    }
+
+    if (takeFreeCount<FROM_ISR>(lane, 0))
+        return allocSlot<FROM_ISR>(lane);
+
+    if (policy.dropOldest)
+    {
+        int slot = takePending<FROM_ISR>(lane, ANY_EVENT, m_stats.droppedOldest);
+        if (slot >= 0)
+            return slot;
+    }
+
+    if (timeout > 0 && takeFreeCount<FROM_ISR>(lane, timeout))
+        return allocSlot<FROM_ISR>(lane);
+
+    enterCritical<FROM_ISR>();
+    m_stats.rejected++;
+    exitCritical<FROM_ISR>();
+    return -1;
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::takeFreeCount(lane_t &lane, TickType_t timeout)
+{
+    if constexpr (FROM_ISR)
+        return xSemaphoreTakeFromISR(lane.freeCount, nullptr) == pdTRUE;
+    else
+        return xSemaphoreTake(lane.freeCount, timeout) == pdTRUE;
+}
+
+// TAKE A FREE SLOT, THE CALLER ALREADY TOOK IT FROM THE LANE'S freeCount
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+int FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::allocSlot(lane_t &lane)
+{
+    enterCritical<FROM_ISR>();
+    int slot = __builtin_ctz(lane.freeSlots);
+    lane.freeSlots &= ~(1u << slot);
+    lane.peakDepth = std::max<uint8_t>(lane.peakDepth, lane.size - __builtin_popcount(lane.freeSlots));
+    exitCritical<FROM_ISR>();
+
+    return slot;
+}
+
+// TAKE BACK THE OLDEST QUEUED SLOT OF eventIndex (OR OF ANY EVENT) AND DESTROY ITS EVENT, -1 IF THERE IS NONE
+// counter counts the event as coalesced or dropped
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+int FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::takePending(lane_t &lane, size_t eventIndex, uint32_t &counter)
+{
+    int slot = -1;
+
+    enterCritical<FROM_ISR>();
+    for (size_t i = 0; i < lane.pendingCount; i++)
+    {
+        if (eventIndex == ANY_EVENT || m_slots[lane.pending[i]].eventIndex == eventIndex)
+        {
+            slot = lane.pending[i];
+            std::copy(lane.pending.begin() + i + 1, lane.pending.begin() + lane.pendingCount, lane.pending.begin() + i);
+            lane.pendingCount--;
+            counter++;
+            break;
+        }
+    }
+    exitCritical<FROM_ISR>();
+
+    if (slot >= 0)
+        eventAt(slot)->~EventVariant();
+
+    return slot;
+}
+
+// QUEUE A SLOT ONCE ITS EVENT IS CONSTRUCTED, THE TASK ONLY EVER SEES COMPLETE EVENTS
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::queueSlot(lane_t &lane, int slot, size_t eventIndex)
+{
+    enterCritical<FROM_ISR>();
+    m_slots[slot].eventIndex = eventIndex;
+    lane.pending[lane.pendingCount++] = slot;
+    exitCritical<FROM_ISR>();
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::enterCritical() const
+{
+    if constexpr (FROM_ISR)
+        portENTER_CRITICAL_ISR(&m_queueLock);
+    else
+        portENTER_CRITICAL(&m_queueLock);
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+template <bool FROM_ISR>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::exitCritical() const
+{
+    if constexpr (FROM_ISR)
+        portEXIT_CRITICAL_ISR(&m_queueLock);
+    else
+        portEXIT_CRITICAL(&m_queueLock);
+}
+
+// HANDLE THE OLDEST QUEUED EVENT, URGENT ONES FIRST, RETURN FALSE IF THERE IS NONE
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+bool FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::handlePendingEvent()
+{
+    enterCritical<false>();
+    lane_t &lane = m_lanes[URGENT_LANE].pendingCount > 0 ? m_lanes[URGENT_LANE] : m_lanes[NORMAL_LANE];
+    if (lane.pendingCount == 0)
+    {
+        exitCritical<false>();
+        return false;
+    }
+
+    uint8_t slot = lane.pending[0];
+    std::copy(lane.pending.begin() + 1, lane.pending.begin() + lane.pendingCount, lane.pending.begin());
+    lane.pendingCount--;
+    exitCritical<false>();
+
+    EventVariant *event = eventAt(slot);
+    dispatch(*event);
+    event->~EventVariant();
+
+    enterCritical<false>();
+    lane.freeSlots |= 1u << slot;
+    exitCritical<false>();
+    xSemaphoreGive(lane.freeCount);
+    return true;
+}
 
 // PRIVATE DISPATCH HANDLING
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::dispatch()
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::dispatch(EventVariant &event)
 {
     Derived &child = static_cast<Derived &>(*this);
-    auto newState = std::visit(
-        [&](auto &stateVar, auto &eventVar) -> std::optional<StateVariant>
-        { return child.on_event(stateVar, eventVar); },
-        m_states, m_events);
+#if FSM_TRACE_ENABLED
+    uint32_t start = esp_cpu_get_cycle_count();
+    size_t stateIndex = m_states.index();
+#endif
+
+    auto newState = FsmDispatchTable<Derived, StateVariant, EventVariant>::Dispatch(child, m_states, event);
+
+#if FSM_TRACE_ENABLED
+    size_t newStateIndex = newState ? newState->index() : FsmTracer<StateVariant, EventVariant>::NO_TRANSITION;
+#endif
 
     handleNewState(std::move(newState));
+
+#if FSM_TRACE_ENABLED
+    m_tracer.Record(stateIndex, event.index(), newStateIndex, esp_cpu_get_cycle_count() - start);
+#endif
 }
 
 // HANDLE NEW STATE TRANSITION
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTask<Derived, StateVariant, EventVariant>::handleNewState(std::optional<StateVariant> &&newState)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t EVENT_QUEUE_SIZE, size_t URGENT_QUEUE_SIZE>
+void FsmTask<Derived, StateVariant, EventVariant, EVENT_QUEUE_SIZE, URGENT_QUEUE_SIZE>::handleNewState(std::optional<StateVariant> &&newState)
 {
     Derived &child = static_cast<Derived &>(*this);
     if (!newState)
@@ -3,12 +3,32 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 #include <variant>
 #include <optional>
+#include "fsm_dispatch_table.h"
+#include "fsm_snapshot.h"
 
 /*
     Equivalent to FSMTask but without a task (run in the same conetxt as the caller)
+
+    Dispatch() is safe from any number of tasks - the event is pushed into a lock free inbox, and whichever caller
+    wins the "draining" flag handles the inbox until it is empty, one event at a time (run to completion).
+    A caller that loses the race returns right away, its event is handled by the caller that is draining.
+    Handlers may dispatch too, those events are handled after the current one.
+
+    DispatchSync() also waits until its event was handled, for events borrowing memory the caller only owns
+    for the duration of the call. It blocks on a semaphore the draining task gives right after handling the event.
+    DispatchFromISR() only queues the event, it is handled by the next Dispatch() / ProcessInbox() from a task.
+
+    NOTICE - the inbox holds INBOX_SIZE events, Dispatch() drops the event and returns false when it is full
+    NOTICE - DispatchSync() waits for whichever task is draining, do not call it while holding a lock that handlers
+             may take (e.g. from an esp-mqtt event handler, esp-mqtt holds its lock while handlers publish)
 */
 
 // define as 1 if on_entry(state) functions required. (see example)
@@ -21,23 +41,58 @@
 #define CALL_ON_STATE_EXIT 0
 #endif
 
-template <typename Derived, typename StateVariant, typename EventVariant>
+// define as 1 to trace every dispatch (see fsm_trace.h)
+#ifndef FSM_TRACE_ENABLED
+#define FSM_TRACE_ENABLED 0
+#endif
+
+#if FSM_TRACE_ENABLED
+#include "fsm_trace.h"
+#endif
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE = 8>
 class FsmTaskless
 {
+    static_assert(INBOX_SIZE > 1 && (INBOX_SIZE & (INBOX_SIZE - 1)) == 0, "INBOX_SIZE must be a power of 2");
+
 public:
+    FsmTaskless();
+
     // Start the FSM Task
     void Start();
     void Start(StateVariant &&state);
 
-    // Dispatch an event to state machine
+    // Start in the state saved in a valid snapshot (see fsm_snapshot.h), otherwise like Start(), return whether it resumed
+    bool StartFromSnapshot(FsmSnapshot<StateVariant> &snapshot);
+
+    // Save the current state to a snapshot kept across deep sleep, call it while the fsm is idle
+    void SaveSnapshot(FsmSnapshot<StateVariant> &snapshot) const { snapshot.Save(m_states); }
+
+    // Dispatch an event to state machine, return false if the inbox is full
     template <typename Event>
-    void Dispatch(Event &&event);
+    bool Dispatch(Event &&event);
+
+    // Dispatch an event and return only after it was handled, waits for room if the inbox is full
+    template <typename Event>
+    void DispatchSync(Event &&event);
+
+    // Queue an event from an ISR, return false if the inbox is full
+    template <typename Event>
+    bool DispatchFromISR(Event &&event);
+
+    // Handle queued events, if no other task is handling them already
+    void ProcessInbox();
 
     // Whether the fsm is currently in a certain state
     template <class State>
     bool IsInState() const { return std::holds_alternative<State>(m_states); }
     bool IsRunning() const { return m_isRunning; }
 
+#if FSM_TRACE_ENABLED
+    // The recent dispatches and their durations
+    const FsmTracer<StateVariant, EventVariant> &GetTracer() const { return m_tracer; }
+#endif
+
 protected:
     // Get the state if the state is the requested otherwise asserts
     template <class State>
@@ -52,17 +107,45 @@ protected:
     StateVariant &GetStates() { return m_states; }
 
 private:
+    // a slot is free for the push of ticket t when sequence == t, and holds its event when sequence == t + 1
+    struct slot_t
+    {
+        std::atomic<size_t> sequence;
+        SemaphoreHandle_t handled; // given once the event was handled, nullptr if nobody waits for it
+        alignas(EventVariant) std::byte storage[sizeof(EventVariant)];
+    };
+
+    template <typename Event>
+    std::optional<size_t> push(Event &&event, SemaphoreHandle_t handled = nullptr);
+    bool handleNext();
+    void dispatch(EventVariant &event);
     void handleNewState(std::optional<StateVariant> &&newState);
 
     bool m_isRunning{false};
+#if FSM_TRACE_ENABLED
+    FsmTracer<StateVariant, EventVariant> m_tracer;
+#endif
     StateVariant m_states{};
-    EventVariant m_events{};
+
+    std::array<slot_t, INBOX_SIZE> m_inbox;
+    std::atomic<size_t> m_pushTicket{0};
+    size_t m_nextTicket{0}; // next event to handle, only touched while draining
+    std::atomic<bool> m_isDraining{false};
+    std::atomic<TaskHandle_t> m_drainingTask{nullptr};
 };
 
 //----------------------- PUBLIC FUNTIONS IMPLEMENTATION ------------------------
 
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTaskless<Derived, StateVariant, EventVariant>::Start()
+// CONSTRUCTOR
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::FsmTaskless()
+{
+    for (size_t i = 0; i < INBOX_SIZE; i++)
+        m_inbox[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::Start()
 {
     configASSERT(!m_isRunning);
 
@@ -77,8 +160,8 @@ void FsmTaskless<Derived, StateVariant, EventVariant>::Start()
     }
 }
 
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTaskless<Derived, StateVariant, EventVariant>::Start(StateVariant &&state)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::Start(StateVariant &&state)
 {
     configASSERT(!m_isRunning);
 
@@ -94,28 +177,172 @@ void FsmTaskless<Derived, StateVariant, EventVariant>::Start(StateVariant &&stat
     }
 }
 
+// START FROM A SNAPSHOT
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+bool FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::StartFromSnapshot(FsmSnapshot<StateVariant> &snapshot)
+{
+    std::optional<StateVariant> state = snapshot.Take();
+    if (!state)
+    {
+        Start();
+        return false;
+    }
+
+    Start(*std::move(state));
+    return true;
+}
+
 // DISPATCH AN EVENT
-template <typename Derived, typename StateVariant, typename EventVariant>
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
 template <typename Event>
-void FsmTaskless<Derived, StateVariant, EventVariant>::Dispatch(Event &&event)
+bool FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::Dispatch(Event &&event)
 {
     configASSERT(m_isRunning);
 
-    m_events = std::move(event);
-    Derived &child = static_cast<Derived &>(*this);
-    auto newState = std::visit(
-        [&](auto &stateVar, auto &eventVar) -> std::optional<StateVariant>
-        { return child.on_event(stateVar, eventVar); },
-        m_states, m_events);
+    bool isQueued = push(std::forward<Event>(event)).has_value();
+    ProcessInbox();
+    return isQueued;
+}
 
-    handleNewState(std::move(newState));
+// DISPATCH AN EVENT AND WAIT UNTIL IT WAS HANDLED
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+template <typename Event>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::DispatchSync(Event &&event)
+{
+    configASSERT(m_isRunning);
+    // from inside a handler the event could only be handled after the handler returns
+    configASSERT(m_drainingTask.load() != xTaskGetCurrentTaskHandle());
+
+    StaticSemaphore_t handledBuffer;
+    SemaphoreHandle_t handled = xSemaphoreCreateBinaryStatic(&handledBuffer);
+
+    // the event is only moved from once a slot was claimed, a full inbox is rare enough to poll
+    while (!push(std::forward<Event>(event), handled).has_value())
+    {
+        ProcessInbox();
+        vTaskDelay(1);
+    }
+
+    ProcessInbox();
+    xSemaphoreTake(handled, portMAX_DELAY);
+    vSemaphoreDelete(handled);
+}
+
+// QUEUE AN EVENT FROM ISR
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+template <typename Event>
+bool FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::DispatchFromISR(Event &&event)
+{
+    if (!m_isRunning)
+        return false;
+
+    return push(std::forward<Event>(event)).has_value();
+}
+
+// DRAIN THE INBOX IF NO ONE ELSE IS
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::ProcessInbox()
+{
+    while (!m_isDraining.exchange(true))
+    {
+        m_drainingTask.store(xTaskGetCurrentTaskHandle());
+        while (handleNext())
+        {
+        }
+
+        size_t next = m_nextTicket;
+        m_drainingTask.store(nullptr);
+        m_isDraining.store(false);
+
+        // an event pushed after the last check, whose caller saw the flag still taken, is ours to handle
+        if (m_inbox[next % INBOX_SIZE].sequence.load() != next + 1)
+            return;
+    }
 }
 
 //------------------------ PRIVATE FUNTIONS IMPLEMENTATION ----------------------
 
+// CLAIM A SLOT AND MOVE THE EVENT INTO IT, RETURN ITS TICKET OR NULLOPT IF THE INBOX IS FULL
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+template <typename Event>
+std::optional<size_t> FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::push(Event &&event, SemaphoreHandle_t handled)
+{
+    size_t ticket = m_pushTicket.load(std::memory_order_relaxed);
+    slot_t *slot;
+    for (;;)
+    {
+        slot = &m_inbox[ticket % INBOX_SIZE];
+        intptr_t diff = static_cast<intptr_t>(slot->sequence.load(std::memory_order_acquire) - ticket);
+        if (diff == 0)
+        {
+            if (m_pushTicket.compare_exchange_weak(ticket, ticket + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return std::nullopt; // the slot still holds an event from the previous lap
+        }
+        else
+        {
+            ticket = m_pushTicket.load(std::memory_order_relaxed);
+        }
+    }
+
+    new (slot->storage) EventVariant{std::forward<Event>(event)};
+    slot->handled = handled;
+    slot->sequence.store(ticket + 1, std::memory_order_release);
+    return ticket;
+}
+
+// HANDLE THE NEXT EVENT IF IT WAS FULLY PUSHED, ONLY CALLED WHILE DRAINING
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+bool FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::handleNext()
+{
+    slot_t &slot = m_inbox[m_nextTicket % INBOX_SIZE];
+    if (slot.sequence.load(std::memory_order_acquire) != m_nextTicket + 1)
+        return false;
+
+    EventVariant *event = std::launder(reinterpret_cast<EventVariant *>(slot.storage));
+    dispatch(*event);
+    event->~EventVariant();
+
+    // read before the slot is handed to the next push
+    SemaphoreHandle_t handled = slot.handled;
+    slot.sequence.store(m_nextTicket + INBOX_SIZE, std::memory_order_release);
+    m_nextTicket++;
+
+    if (handled != nullptr)
+        xSemaphoreGive(handled);
+
+    return true;
+}
+
+// PRIVATE DISPATCH HANDLING
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::dispatch(EventVariant &event)
+{
+    Derived &child = static_cast<Derived &>(*this);
+#if FSM_TRACE_ENABLED
+    uint32_t start = esp_cpu_get_cycle_count();
+    size_t stateIndex = m_states.index();
+#endif
+
+    auto newState = FsmDispatchTable<Derived, StateVariant, EventVariant>::Dispatch(child, m_states, event);
+
+#if FSM_TRACE_ENABLED
+    size_t newStateIndex = newState ? newState->index() : FsmTracer<StateVariant, EventVariant>::NO_TRANSITION;
+#endif
+
+    handleNewState(std::move(newState));
+
+#if FSM_TRACE_ENABLED
+    m_tracer.Record(stateIndex, event.index(), newStateIndex, esp_cpu_get_cycle_count() - start);
+#endif
+}
+
 // HANDLE NEW STATE TRANSITION
-template <typename Derived, typename StateVariant, typename EventVariant>
-void FsmTaskless<Derived, StateVariant, EventVariant>::handleNewState(std::optional<StateVariant> &&newState)
+template <typename Derived, typename StateVariant, typename EventVariant, size_t INBOX_SIZE>
+void FsmTaskless<Derived, StateVariant, EventVariant, INBOX_SIZE>::handleNewState(std::optional<StateVariant> &&newState)
 {
     Derived &child = static_cast<Derived &>(*this);
     if (!newState)
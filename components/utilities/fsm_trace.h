@@ -0,0 +1,272 @@
+#ifndef __FSM_TRACE_H__
+#define __FSM_TRACE_H__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "baozi_json.h"
+#include "baozi_log.h"
+
+/*
+    Opt-in tracing of FsmTask/FsmTaskless dispatches, define FSM_TRACE_ENABLED as 1 for the whole project
+    (it changes the fsm classes layout, so every translation unit must agree).
+
+    Every dispatch records the state index, event index, resulting state (NO_TRANSITION if the state did not change),
+    a timestamp and the handler duration in CPU cycles (including on_exit/on_entry) into a ring of the last RING_SIZE
+    dispatches, and counts the duration into a log2 histogram of its state/event pair.
+    States and events that have a NAME (static constexpr const char *) are dumped by name, otherwise by index.
+
+    The fsm writes the records from its dispatching context only, and readers on any task get consistent copies without
+    locking (a record being overwritten while read is skipped).
+
+    example:
+        mqtt.Publish("baozi/trace", mqtt.GetTracer().ToJson());
+        wifi.GetTracer().Print();
+
+    NOTICE - with FSM_TRACE_ENABLED 0 (default) the tracer is compiled out and dispatching is unchanged
+*/
+
+// define as 1 to trace dispatches of every fsm (see above)
+#ifndef FSM_TRACE_ENABLED
+#define FSM_TRACE_ENABLED 0
+#endif
+
+template <typename StateVariant, typename EventVariant, size_t RING_SIZE = 32>
+class FsmTracer
+{
+public:
+    static constexpr size_t STATES = std::variant_size_v<StateVariant>;
+    static constexpr size_t EVENTS = std::variant_size_v<EventVariant>;
+    static constexpr uint8_t NO_TRANSITION = UINT8_MAX;
+
+    // bucket 0 counts durations below 2^FIRST_BUCKET_BITS cycles, bucket i [2^(FIRST_BUCKET_BITS + i - 1), 2^(FIRST_BUCKET_BITS + i)),
+    // the last bucket everything longer
+    static constexpr size_t BUCKETS = 12;
+    static constexpr uint32_t FIRST_BUCKET_BITS = 10;
+
+    static_assert(STATES < NO_TRANSITION && EVENTS <= UINT8_MAX, "too many states/events to trace");
+
+    struct record_t
+    {
+        uint32_t timestampUs; // low 32 bits of esp_timer_get_time()
+        uint32_t cycles;
+        uint8_t state;
+        uint8_t event;
+        uint8_t newState; // NO_TRANSITION if the state did not change
+    };
+
+    struct histogram_t
+    {
+        uint32_t count;
+        uint32_t maxCycles;
+        std::array<uint32_t, BUCKETS> buckets;
+    };
+
+    // Record a dispatch, only called by the fsm
+    void Record(size_t state, size_t event, size_t newState, uint32_t cycles)
+    {
+        uint32_t sequence = m_written.load(std::memory_order_relaxed);
+        slot_t &slot = m_ring[sequence % RING_SIZE];
+
+        // odd while being written, readers skip a slot whose sequence changed while they copied it
+        slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestampUs.store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+        slot.cycles.store(cycles, std::memory_order_relaxed);
+        slot.indices.store(state | (event << 8) | (newState << 16), std::memory_order_relaxed);
+        slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+        m_written.store(sequence + 1, std::memory_order_release);
+
+        pair_t &pair = m_pairs[state][event];
+        pair.count.fetch_add(1, std::memory_order_relaxed);
+        pair.buckets[bucketOf(cycles)].fetch_add(1, std::memory_order_relaxed);
+        if (cycles > pair.maxCycles.load(std::memory_order_relaxed))
+            pair.maxCycles.store(cycles, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Performs a function for each of the last RING_SIZE records, oldest first
+     *
+     * @tparam F a functor or a function that takes (const record_t &)
+     */
+    template <typename F>
+    void ForEachRecord(F &&func) const
+    {
+        uint32_t written = m_written.load(std::memory_order_acquire);
+        uint32_t first = written > RING_SIZE ? written - RING_SIZE : 0;
+
+        for (uint32_t sequence = first; sequence < written; sequence++)
+        {
+            const slot_t &slot = m_ring[sequence % RING_SIZE];
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before != 2 * sequence + 2)
+                continue; // overwritten by a newer record already
+
+            uint32_t indices = slot.indices.load(std::memory_order_relaxed);
+            record_t record{
+                .timestampUs = slot.timestampUs.load(std::memory_order_relaxed),
+                .cycles = slot.cycles.load(std::memory_order_relaxed),
+                .state = static_cast<uint8_t>(indices),
+                .event = static_cast<uint8_t>(indices >> 8),
+                .newState = static_cast<uint8_t>(indices >> 16),
+            };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before)
+                func(record);
+        }
+    }
+
+    histogram_t Histogram(size_t state, size_t event) const
+    {
+        const pair_t &pair = m_pairs[state][event];
+        histogram_t histogram{.count = pair.count.load(std::memory_order_relaxed), .maxCycles = pair.maxCycles.load(std::memory_order_relaxed), .buckets = {}};
+        for (size_t i = 0; i < BUCKETS; i++)
+            histogram.buckets[i] = pair.buckets[i].load(std::memory_order_relaxed);
+
+        return histogram;
+    }
+
+    /**
+     * @brief dump the records and the histograms of the pairs that were dispatched, e.g. to publish over mqtt
+     *        {"records":[{"t":..,"state":..,"event":..,"next":..,"cycles":..}],
+     *         "histograms":[{"state":..,"event":..,"count":..,"max":..,"buckets":[..]}]}
+     */
+    Baozi::BaoJson ToJson() const
+    {
+        Baozi::BaoJson records = Baozi::BaoJson::CreateArray();
+        ForEachRecord([&](const record_t &record)
+                      {
+                          Baozi::BaoJson item;
+                          item.AddVal("t", record.timestampUs);
+                          addName<StateVariant>(item, "state", record.state);
+                          addName<EventVariant>(item, "event", record.event);
+                          if (record.newState != NO_TRANSITION)
+                              addName<StateVariant>(item, "next", record.newState);
+                          item.AddVal("cycles", record.cycles);
+                          records.AddValToArray(std::move(item)); });
+
+        Baozi::BaoJson histograms = Baozi::BaoJson::CreateArray();
+        for (size_t state = 0; state < STATES; state++)
+        {
+            for (size_t event = 0; event < EVENTS; event++)
+            {
+                histogram_t histogram = Histogram(state, event);
+                if (histogram.count == 0)
+                    continue;
+
+                Baozi::BaoJson item;
+                addName<StateVariant>(item, "state", state);
+                addName<EventVariant>(item, "event", event);
+                item.AddVal("count", histogram.count);
+                item.AddVal("max", histogram.maxCycles);
+
+                Baozi::BaoJson buckets = Baozi::BaoJson::CreateArray();
+                for (uint32_t bucket : histogram.buckets)
+                    buckets.AddValToArray(bucket);
+                item.AddVal("buckets", std::move(buckets));
+
+                histograms.AddValToArray(std::move(item));
+            }
+        }
+
+        Baozi::BaoJson dump;
+        dump.AddVal("records", std::move(records));
+        dump.AddVal("histograms", std::move(histograms));
+        return dump;
+    }
+
+    // Log the records and the histograms to the console
+    void Print() const
+    {
+        ForEachRecord([](const record_t &record)
+                      { BAO_LOG_INFO("%lu us: %s(%u) + %s(%u) -> %s, %lu cycles",
+                                     (unsigned long)record.timestampUs,
+                                     nameOf<StateVariant>(record.state), record.state,
+                                     nameOf<EventVariant>(record.event), record.event,
+                                     record.newState == NO_TRANSITION ? "-" : nameOf<StateVariant>(record.newState),
+                                     (unsigned long)record.cycles); });
+
+        for (size_t state = 0; state < STATES; state++)
+        {
+            for (size_t event = 0; event < EVENTS; event++)
+            {
+                histogram_t histogram = Histogram(state, event);
+                if (histogram.count == 0)
+                    continue;
+
+                BAO_LOG_INFO("%s(%u) + %s(%u): %lu dispatches, max %lu cycles",
+                             nameOf<StateVariant>(state), (unsigned)state, nameOf<EventVariant>(event), (unsigned)event,
+                             (unsigned long)histogram.count, (unsigned long)histogram.maxCycles);
+            }
+        }
+    }
+
+private:
+    struct slot_t
+    {
+        std::atomic<uint32_t> sequence{0}; // 2 * record sequence + 2 once written
+        std::atomic<uint32_t> timestampUs{0};
+        std::atomic<uint32_t> cycles{0};
+        std::atomic<uint32_t> indices{0}; // state | event << 8 | newState << 16
+    };
+
+    struct pair_t
+    {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> maxCycles{0};
+        std::array<std::atomic<uint32_t>, BUCKETS> buckets{};
+    };
+
+    std::array<slot_t, RING_SIZE> m_ring{};
+    std::atomic<uint32_t> m_written{0};
+    std::array<std::array<pair_t, EVENTS>, STATES> m_pairs{};
+
+    static size_t bucketOf(uint32_t cycles)
+    {
+        size_t bits = cycles == 0 ? 0 : 32 - __builtin_clz(cycles);
+        if (bits <= FIRST_BUCKET_BITS)
+            return 0;
+
+        return bits - FIRST_BUCKET_BITS < BUCKETS ? bits - FIRST_BUCKET_BITS : BUCKETS - 1;
+    }
+
+    template <typename Variant, size_t... Is>
+    static const char *nameOf(size_t index, std::index_sequence<Is...>)
+    {
+        static constexpr std::array<const char *, sizeof...(Is)> names{nameOrNull<std::variant_alternative_t<Is, Variant>>()...};
+        return names[index] != nullptr ? names[index] : "?";
+    }
+
+    template <typename Variant>
+    static const char *nameOf(size_t index)
+    {
+        return nameOf<Variant>(index, std::make_index_sequence<std::variant_size_v<Variant>>{});
+    }
+
+    template <typename T>
+    static constexpr const char *nameOrNull()
+    {
+        if constexpr (requires { T::NAME; })
+            return T::NAME;
+        else
+            return nullptr;
+    }
+
+    // by NAME if the alternative has one, by index otherwise
+    template <typename Variant>
+    static void addName(Baozi::BaoJson &json, const char *key, size_t index)
+    {
+        const char *name = nameOf<Variant>(index);
+        if (name[0] != '?')
+            json.AddVal(key, name);
+        else
+            json.AddVal(key, static_cast<int>(index));
+    }
+};
+
+#endif // __FSM_TRACE_H__
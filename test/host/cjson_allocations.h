@@ -0,0 +1,38 @@
+#ifndef HOST_CJSON_ALLOCATIONS_H__
+#define HOST_CJSON_ALLOCATIONS_H__
+
+// counts the cJSON allocations of the calling task while it is alive, they are still served by the heap
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include "baozi_json_hooks.h"
+
+class CJsonAllocations
+{
+public:
+    uint32_t Count() const { return m_count; }
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    uint32_t m_count{};
+    size_t m_bytes{};
+
+    Baozi::BaoJsonHooks::Handler m_handler{.allocate = s_allocate, .release = s_release, .context = this};
+    Baozi::BaoJsonHooks::Scope m_scope{m_handler};
+
+    static void *s_allocate(void *context, size_t size)
+    {
+        auto *self = static_cast<CJsonAllocations *>(context);
+        self->m_count++;
+        self->m_bytes += size;
+        return nullptr;
+    }
+
+    static bool s_release(void *, void *)
+    {
+        return false;
+    }
+};
+
+#endif // HOST_CJSON_ALLOCATIONS_H__
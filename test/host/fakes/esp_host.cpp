@@ -0,0 +1,126 @@
+// the small esp-idf calls - log, errors, cycle counter, rom crc and restart
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "host_idf.h"
+
+namespace
+{
+    std::atomic<esp_log_level_t> s_logLevel{ESP_LOG_INFO};
+    std::atomic<uint32_t> s_restarts{};
+} // namespace
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_FOUND:
+        return "ESP_ERR_NVS_NOT_FOUND";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+void esp_log_level_set(const char *, esp_log_level_t level)
+{
+    s_logLevel = level;
+}
+
+esp_log_level_t esp_log_level_get(const char *)
+{
+    return s_logLevel;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static constexpr char LETTERS[] = "-EWIDV";
+
+    // the repo logs with __FILE__ as the tag, the file name is enough
+    const char *slash = strrchr(tag, '/');
+    printf("%c (%s) ", LETTERS[level], slash != nullptr ? slash + 1 : tag);
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<esp_cpu_cycle_count_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac)
+{
+    static constexpr uint8_t HOST_MAC[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    memcpy(mac, HOST_MAC, sizeof(HOST_MAC));
+    return ESP_OK;
+}
+
+void esp_restart(void)
+{
+    s_restarts++;
+}
+
+uint32_t HostIdf::RestartCount()
+{
+    return s_restarts;
+}
+
+void HostIdf::ResetRestartCount()
+{
+    s_restarts = 0;
+}
+
+#ifndef HAVE_STRLCPY
+// newlib has strlcpy, older glibc does not
+extern "C" size_t strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t length = strlen(src);
+    if (size > 0)
+    {
+        size_t copied = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, copied);
+        dst[copied] = '\0';
+    }
+    return length;
+}
+#endif
@@ -0,0 +1,170 @@
+// esp-mqtt client without a network - the test is the broker, see host_mqtt.h
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "host_mqtt.h"
+
+struct esp_mqtt_client
+{
+    std::recursive_mutex apiLock; // esp-mqtt holds its api lock while it calls the handler, and in publish/subscribe
+    esp_event_handler_t handler{};
+    void *handlerArg{};
+    bool started{};
+    int nextMsgId{1};
+    std::vector<HostMqtt::Message> published;
+    std::vector<std::string> subscribed;
+};
+
+namespace
+{
+    std::mutex s_clientsMutex;
+    std::deque<std::unique_ptr<esp_mqtt_client>> s_clients; // never shrinks until Reset(), handles stay valid
+    std::atomic<bool> s_failPublishes{};
+    std::atomic<bool> s_failSubscribes{};
+
+    void deliver(esp_mqtt_client_handle_t client, esp_mqtt_event_t &event)
+    {
+        std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+        if (client->handler == nullptr || !client->started)
+            return;
+
+        event.client = client;
+        client->handler(client->handlerArg, "MQTT_EVENTS", event.event_id, &event);
+    }
+} // namespace
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *)
+{
+    std::lock_guard<std::mutex> lock(s_clientsMutex);
+    return s_clients.emplace_back(std::make_unique<esp_mqtt_client>()).get();
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t, esp_event_handler_t event_handler,
+                                         void *event_handler_arg)
+{
+    std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+    client->handler = event_handler;
+    client->handlerArg = event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+    client->started = true;
+    return ESP_OK;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int)
+{
+    std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+    if (s_failSubscribes)
+        return -1;
+
+    client->subscribed.emplace_back(topic);
+    return client->nextMsgId++;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len, int, int)
+{
+    std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+    if (s_failPublishes)
+        return -1;
+
+    size_t length = len > 0 ? static_cast<size_t>(len) : strlen(data);
+    client->published.push_back(HostMqtt::Message{.topic = topic, .payload = std::string{data, length}});
+    return client->nextMsgId++;
+}
+
+// =====================================================================
+
+namespace HostMqtt
+{
+    esp_mqtt_client_handle_t LastClient()
+    {
+        std::lock_guard<std::mutex> lock(s_clientsMutex);
+        return s_clients.empty() ? nullptr : s_clients.back().get();
+    }
+
+    void Deliver(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t id)
+    {
+        esp_mqtt_event_t event{};
+        event.event_id = id;
+        deliver(client, event);
+    }
+
+    void DeliverData(esp_mqtt_client_handle_t client, std::string_view topic, std::string_view payload, size_t chunkSize)
+    {
+        if (chunkSize == 0 || chunkSize > payload.size())
+            chunkSize = payload.size();
+
+        int msgId = 0;
+        {
+            std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+            msgId = client->nextMsgId++;
+        }
+
+        size_t offset = 0;
+        do
+        {
+            size_t length = std::min(chunkSize, payload.size() - offset);
+
+            // fresh copies, like the esp-mqtt buffer they are only valid during the callback
+            std::string topicCopy{offset == 0 ? topic : std::string_view{}};
+            std::string chunk{payload.substr(offset, length)};
+
+            esp_mqtt_event_t event{};
+            event.event_id = MQTT_EVENT_DATA;
+            event.topic = topicCopy.data();
+            event.topic_len = static_cast<int>(topicCopy.size());
+            event.data = chunk.data();
+            event.data_len = static_cast<int>(length);
+            event.total_data_len = static_cast<int>(payload.size());
+            event.current_data_offset = static_cast<int>(offset);
+            event.msg_id = msgId;
+            deliver(client, event);
+
+            offset += length;
+        } while (offset < payload.size());
+    }
+
+    std::vector<Message> Published(esp_mqtt_client_handle_t client)
+    {
+        std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+        return client->published;
+    }
+
+    std::vector<std::string> Subscribed(esp_mqtt_client_handle_t client)
+    {
+        std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+        return client->subscribed;
+    }
+
+    void ClearPublished(esp_mqtt_client_handle_t client)
+    {
+        std::lock_guard<std::recursive_mutex> lock(client->apiLock);
+        client->published.clear();
+    }
+
+    void FailPublishes(bool fail)
+    {
+        s_failPublishes = fail;
+    }
+
+    void FailSubscribes(bool fail)
+    {
+        s_failSubscribes = fail;
+    }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(s_clientsMutex);
+        s_clients.clear();
+        s_failPublishes = false;
+        s_failSubscribes = false;
+    }
+} // namespace HostMqtt
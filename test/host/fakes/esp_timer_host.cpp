@@ -0,0 +1,154 @@
+// esp_timer on one timer thread - callbacks of all timers run there one at a time, like on the esp_timer task
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "esp_timer.h"
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t periodUs;
+    int64_t dueUs;
+    bool isArmed;
+};
+
+namespace
+{
+    std::mutex s_mutex;
+    // never destroyed, the timer thread still waits on them at exit - the condition would block its destruction, and
+    // the thread reads the list as it wakes up
+    std::condition_variable &s_changed = *new std::condition_variable;
+    std::vector<esp_timer *> &s_timers = *new std::vector<esp_timer *>; // protected by s_mutex
+    bool s_threadStarted{};             // protected by s_mutex
+
+    esp_timer *nextDue()
+    {
+        esp_timer *next = nullptr;
+        for (esp_timer *timer : s_timers)
+        {
+            if (timer->isArmed && (next == nullptr || timer->dueUs < next->dueUs))
+            {
+                next = timer;
+            }
+        }
+        return next;
+    }
+
+    void timerThread()
+    {
+        std::unique_lock<std::mutex> lock(s_mutex);
+        for (;;)
+        {
+            esp_timer *timer = nextDue();
+            if (timer == nullptr)
+            {
+                s_changed.wait(lock);
+                continue;
+            }
+
+            int64_t now = esp_timer_get_time();
+            if (timer->dueUs > now)
+            {
+                s_changed.wait_for(lock, std::chrono::microseconds(timer->dueUs - now));
+                continue;
+            }
+
+            if (timer->periodUs > 0)
+            {
+                // skip the periods that were missed, as with skip_unhandled_events
+                timer->dueUs = std::max(timer->dueUs + timer->periodUs, now + 1);
+            }
+            else
+            {
+                timer->isArmed = false;
+            }
+
+            esp_timer_cb_t callback = timer->callback;
+            void *arg = timer->arg;
+            lock.unlock();
+            callback(arg);
+            lock.lock();
+        }
+    }
+
+    esp_err_t start(esp_timer_handle_t timer, uint64_t timeoutUs, uint64_t periodUs)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (timer->isArmed)
+        {
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        if (!s_threadStarted)
+        {
+            std::thread(timerThread).detach();
+            s_threadStarted = true;
+        }
+
+        timer->periodUs = static_cast<int64_t>(periodUs);
+        timer->dueUs = esp_timer_get_time() + static_cast<int64_t>(timeoutUs);
+        timer->isArmed = true;
+        s_changed.notify_all();
+        return ESP_OK;
+    }
+} // namespace
+
+int64_t esp_timer_get_time(void)
+{
+    static const auto boot = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == nullptr || create_args->callback == nullptr || out_handle == nullptr)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    *out_handle = new esp_timer{.callback = create_args->callback, .arg = create_args->arg, .periodUs = 0, .dueUs = 0, .isArmed = false};
+    s_timers.push_back(*out_handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!timer->isArmed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    timer->isArmed = false;
+    s_changed.notify_all();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (timer->isArmed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_timers.erase(std::find(s_timers.begin(), s_timers.end(), timer));
+    delete timer;
+    return ESP_OK;
+}
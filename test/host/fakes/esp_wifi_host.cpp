@@ -0,0 +1,159 @@
+// esp_wifi driver, netif and default event loop without a radio - the test is the access point, see host_wifi.h
+
+#include <mutex>
+#include <vector>
+#include "host_wifi.h"
+
+struct esp_netif_obj
+{
+};
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+namespace
+{
+    struct handler_t
+    {
+        esp_event_base_t base;
+        int32_t id;
+        esp_event_handler_t handler;
+        void *arg;
+    };
+
+    std::mutex s_mutex;
+    std::vector<handler_t> s_handlers; // protected by s_mutex
+    HostWifi::Calls s_calls{};         // protected by s_mutex
+    esp_netif_obj s_apNetif;
+    esp_netif_obj s_staNetif;
+
+    template <typename Update>
+    esp_err_t record(Update &&update)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        update(s_calls);
+        return ESP_OK;
+    }
+} // namespace
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void)
+{
+    return &s_apNetif;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    return &s_staNetif;
+}
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t event_base, int32_t event_id, esp_event_handler_t event_handler,
+                                              void *event_handler_arg, esp_event_handler_instance_t *instance)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_handlers.push_back(handler_t{event_base, event_id, event_handler, event_handler_arg});
+    if (instance != nullptr)
+        *instance = event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void *event_data, size_t, TickType_t)
+{
+    std::vector<handler_t> handlers;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        handlers = s_handlers;
+    }
+
+    // called unlocked, a handler may call back into the driver
+    for (const handler_t &handler : handlers)
+    {
+        bool baseMatches = handler.base == ESP_EVENT_ANY_BASE || handler.base == event_base;
+        bool idMatches = handler.id == ESP_EVENT_ANY_ID || handler.id == event_id;
+        if (baseMatches && idMatches)
+            handler.handler(handler.arg, event_base, event_id, const_cast<void *>(event_data));
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *)
+{
+    return record([](HostWifi::Calls &calls) { calls.inits++; });
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return record([mode](HostWifi::Calls &calls) { calls.mode = mode; });
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    return record([interface, conf](HostWifi::Calls &calls) {
+        if (interface == WIFI_IF_STA)
+            calls.staSsid = reinterpret_cast<const char *>(conf->sta.ssid);
+    });
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    return record([](HostWifi::Calls &calls) { calls.starts++; });
+}
+
+esp_err_t esp_wifi_stop(void)
+{
+    return record([](HostWifi::Calls &calls) { calls.stops++; });
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    return record([](HostWifi::Calls &calls) { calls.connects++; });
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    return record([](HostWifi::Calls &calls) { calls.disconnects++; });
+}
+
+// =====================================================================
+
+namespace HostWifi
+{
+    Calls GetCalls()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_calls;
+    }
+
+    void Post(wifi_event_t id)
+    {
+        esp_event_post(WIFI_EVENT, id, nullptr, 0, portMAX_DELAY);
+    }
+
+    void PostDisconnected(wifi_err_reason_t reason)
+    {
+        wifi_event_sta_disconnected_t event{};
+        event.reason = static_cast<uint8_t>(reason);
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event), portMAX_DELAY);
+    }
+
+    void PostGotIp()
+    {
+        esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, nullptr, 0, portMAX_DELAY);
+    }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_handlers.clear();
+        s_calls = Calls{};
+    }
+} // namespace HostWifi
@@ -0,0 +1,257 @@
+// FreeRTOS on std::thread - enough of the kernel for the fsm, timer and json code, with real concurrency so the
+// lock free paths run under TSan
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_idf.h"
+
+struct HostTask
+{
+    std::string name;
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications{};
+};
+
+struct HostSemaphore
+{
+    std::mutex mutex;
+    std::condition_variable given;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+};
+
+namespace
+{
+    // tasks are never freed, a handle stays valid for the whole test run like a task that never returns - not even at
+    // exit, where a task still waiting on its notification would block the destruction of its condition variable
+    std::mutex s_tasksMutex;
+    std::deque<HostTask> &s_tasks = *new std::deque<HostTask>;
+    thread_local HostTask *t_currentTask{};
+
+    std::recursive_mutex s_criticalMutex;
+    std::atomic<uint32_t> s_createdTasks{};
+    std::atomic<uint32_t> s_stackBytes{};
+
+    HostTask *newTask(const char *name)
+    {
+        std::lock_guard<std::mutex> lock(s_tasksMutex);
+        HostTask &task = s_tasks.emplace_back();
+        task.name = name;
+        return &task;
+    }
+
+    template <typename Predicate>
+    bool waitFor(std::condition_variable &cv, std::unique_lock<std::mutex> &lock, TickType_t ticks, Predicate predicate)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            cv.wait(lock, predicate);
+            return true;
+        }
+
+        return cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), predicate);
+    }
+
+    HostSemaphore *newSemaphore(UBaseType_t maxCount, UBaseType_t initialCount)
+    {
+        HostSemaphore *semaphore = new HostSemaphore;
+        semaphore->count = initialCount;
+        semaphore->maxCount = maxCount;
+        return semaphore;
+    }
+} // namespace
+
+extern "C" void vHostAssertFailed(const char *file, int line, const char *expression)
+{
+    fprintf(stderr, "assert failed: %s:%d (%s)\n", file, line, expression);
+    fflush(stderr);
+    abort();
+}
+
+extern "C" void vHostEnterCritical(portMUX_TYPE *)
+{
+    s_criticalMutex.lock();
+}
+
+extern "C" void vHostExitCritical(portMUX_TYPE *)
+{
+    s_criticalMutex.unlock();
+}
+
+// ===================================== TASKS =====================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t,
+                                   TaskHandle_t *createdTask, BaseType_t)
+{
+    s_createdTasks++;
+    s_stackBytes += stackDepth; // esp-idf counts the stack depth in bytes
+    HostTask *task = newTask(name != nullptr ? name : "");
+    if (createdTask != nullptr)
+    {
+        *createdTask = task;
+    }
+
+    std::thread([task, function, parameters]() {
+        t_currentTask = task;
+        function(parameters);
+    }).detach();
+
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameters, UBaseType_t priority,
+                       TaskHandle_t *createdTask)
+{
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameters, priority, createdTask, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (t_currentTask == nullptr)
+    {
+        t_currentTask = newTask("host");
+    }
+
+    return t_currentTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->notifications++;
+    }
+    task->notified.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken != nullptr)
+    {
+        *higherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    HostTask *task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    waitFor(task->notified, lock, ticksToWait, [task]() { return task->notifications > 0; });
+
+    uint32_t count = task->notifications;
+    if (count > 0)
+    {
+        task->notifications = clearCountOnExit ? 0 : count - 1;
+    }
+
+    return count;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    if (ticks == 0)
+    {
+        std::this_thread::yield();
+        return;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    static const auto start = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<TickType_t>(elapsed.count() / portTICK_PERIOD_MS);
+}
+
+// ===================================== SEMAPHORES =====================================
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t maxCount, UBaseType_t initialCount, StaticSemaphore_t *)
+{
+    return newSemaphore(maxCount, initialCount);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *)
+{
+    return newSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return newSemaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return newSemaphore(1, 1);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitFor(semaphore->given, lock, ticksToWait, [semaphore]() { return semaphore->count > 0; }))
+    {
+        return pdFALSE;
+    }
+
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t *)
+{
+    return xSemaphoreTake(semaphore, 0);
+}
+
+// notified under the lock, a waiter woken by the count may delete the semaphore as soon as the lock is released
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->maxCount)
+    {
+        return pdFALSE;
+    }
+
+    semaphore->count++;
+    semaphore->given.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken)
+{
+    if (higherPriorityTaskWoken != nullptr)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+
+    return xSemaphoreGive(semaphore);
+}
+
+uint32_t HostIdf::CreatedTaskCount()
+{
+    return s_createdTasks;
+}
+
+uint32_t HostIdf::CreatedTaskStackBytes()
+{
+    return s_stackBytes;
+}
@@ -0,0 +1,19 @@
+#ifndef HOST_IDF_H__
+#define HOST_IDF_H__
+
+// test side controls of the faked esp-idf calls that are not covered by host_mqtt.h / host_wifi.h
+
+#include <cstdint>
+
+namespace HostIdf
+{
+    // esp_restart() calls since the last ResetRestartCount()
+    uint32_t RestartCount();
+    void ResetRestartCount();
+
+    // tasks created by xTaskCreate() / xTaskCreatePinnedToCore() so far, and the stack they asked for
+    uint32_t CreatedTaskCount();
+    uint32_t CreatedTaskStackBytes();
+} // namespace HostIdf
+
+#endif // HOST_IDF_H__
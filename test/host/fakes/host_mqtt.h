@@ -0,0 +1,44 @@
+#ifndef HOST_MQTT_H__
+#define HOST_MQTT_H__
+
+// test side of the faked esp-mqtt client - stands in for the broker: records what the client publishes and subscribes,
+// and delivers broker events to the client's handler
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mqtt_client.h"
+
+namespace HostMqtt
+{
+    struct Message
+    {
+        std::string topic;
+        std::string payload;
+    };
+
+    // the client created by the last esp_mqtt_client_init(), nullptr after Reset()
+    esp_mqtt_client_handle_t LastClient();
+
+    // delivers an event without data (CONNECTED, DISCONNECTED, SUBSCRIBED...) on the calling thread, holding the
+    // client's lock as the esp-mqtt task does while it calls the handler
+    void Deliver(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t id);
+
+    // delivers an incoming message, in chunks of chunkSize bytes (0 for a single chunk) as esp-mqtt does for
+    // messages larger than its buffer. the chunks are freed as soon as the handler returns
+    void DeliverData(esp_mqtt_client_handle_t client, std::string_view topic, std::string_view payload, size_t chunkSize = 0);
+
+    std::vector<Message> Published(esp_mqtt_client_handle_t client);
+    std::vector<std::string> Subscribed(esp_mqtt_client_handle_t client);
+    void ClearPublished(esp_mqtt_client_handle_t client);
+
+    // esp_mqtt_client_publish() / esp_mqtt_client_subscribe() return -1 while set
+    void FailPublishes(bool fail);
+    void FailSubscribes(bool fail);
+
+    // forgets every client, tests call it before creating a new MqttClient
+    void Reset();
+} // namespace HostMqtt
+
+#endif // HOST_MQTT_H__
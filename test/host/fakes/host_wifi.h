@@ -0,0 +1,36 @@
+#ifndef HOST_WIFI_H__
+#define HOST_WIFI_H__
+
+// test side of the faked wifi driver - stands in for the access point: records the driver calls, and posts the driver
+// events to the handlers registered on the default event loop
+
+#include <cstdint>
+#include <string>
+#include "esp_netif.h"
+#include "esp_wifi.h"
+
+namespace HostWifi
+{
+    struct Calls
+    {
+        uint32_t inits;
+        uint32_t starts;
+        uint32_t stops;
+        uint32_t connects;
+        uint32_t disconnects;
+        wifi_mode_t mode;    // of the last esp_wifi_set_mode()
+        std::string staSsid; // of the last esp_wifi_set_config(WIFI_IF_STA)
+    };
+
+    Calls GetCalls();
+
+    // post a driver event on the calling thread, as esp_event_post() does
+    void Post(wifi_event_t id);
+    void PostDisconnected(wifi_err_reason_t reason);
+    void PostGotIp();
+
+    // unregisters every handler and clears the calls, tests call it before creating a new Wifi
+    void Reset();
+} // namespace HostWifi
+
+#endif // HOST_WIFI_H__
@@ -0,0 +1,166 @@
+// FsmDispatchTable against the double std::visit it replaced, on the real MqttClient and Wifi fsms and on a synthetic
+// 6 states x 6 events fsm where half of the pairs have a transition. The events are drawn at random so neither version
+// gets a predicted branch for free. The real fsms run their own handlers (against the esp-mqtt/esp_wifi fakes), and
+// pairs without a transition go to their on_unhandled, which prints - stdout is quiet while they run
+//   fsm_dispatch_bench
+
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "baozi_json_bench.h"
+#include "baozi_mqtt.h"
+#include "baozi_wifi.h"
+#include "esp_log.h"
+#include "fsm_dispatch_table.h"
+#include "host_fuzz.h"
+#include "host_mqtt.h"
+#include "host_wifi.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr size_t EVENTS = 1024;
+
+    template <int N>
+    struct STATE
+    {
+        int entered = 0;
+    };
+
+    template <int N>
+    struct EVENT
+    {
+        int value = N;
+    };
+
+    using States = std::variant<STATE<0>, STATE<1>, STATE<2>, STATE<3>, STATE<4>, STATE<5>>;
+    using Events = std::variant<EVENT<0>, EVENT<1>, EVENT<2>, EVENT<3>, EVENT<4>, EVENT<5>>;
+
+    struct BenchFsm
+    {
+        int handled = 0;
+
+        // states move on to the next one on events of the same parity, other pairs have no transition
+        template <int S, int E>
+            requires((S + E) % 2 == 0)
+        std::optional<States> on_event(STATE<S> &, EVENT<E> &event)
+        {
+            handled += event.value;
+            return STATE<(S + 1) % 6>{};
+        }
+
+        template <typename State, typename Event>
+        void on_unhandled(State &, Event &)
+        {
+        }
+    };
+
+    template <typename Fsm, typename StateVariant, typename EventVariant>
+    [[gnu::noinline]] std::optional<StateVariant> dispatchTable(Fsm &fsm, StateVariant &states, EventVariant &event)
+    {
+        return FsmDispatchTable<Fsm, StateVariant, EventVariant>::Dispatch(fsm, states, event);
+    }
+
+    // the dispatch before the table - the catch-all on_event it had falls back like on_unhandled does
+    template <typename Fsm, typename StateVariant, typename EventVariant>
+    [[gnu::noinline]] std::optional<StateVariant> dispatchVisit(Fsm &fsm, StateVariant &states, EventVariant &event)
+    {
+        return std::visit([&](auto &state, auto &e) -> std::optional<StateVariant> {
+            if constexpr (requires { fsm.on_event(state, e); })
+            {
+                return fsm.on_event(state, e);
+            }
+            else
+            {
+                fsm.on_unhandled(state, e);
+                return std::nullopt;
+            }
+        }, states, event);
+    }
+
+    template <typename EventVariant, size_t... Is>
+    EventVariant eventAt(size_t index, std::index_sequence<Is...>)
+    {
+        EventVariant event;
+        ((index == Is ? (event = std::variant_alternative_t<Is, EventVariant>{}, 0) : 0), ...);
+        return event;
+    }
+
+    template <typename EventVariant>
+    std::vector<EventVariant> randomEvents()
+    {
+        static constexpr size_t TYPES = std::variant_size_v<EventVariant>;
+
+        std::mt19937 random{1234};
+        std::vector<EventVariant> events;
+        for (size_t i = 0; i < EVENTS; i++)
+            events.push_back(eventAt<EventVariant>(std::uniform_int_distribution<size_t>(0, TYPES - 1)(random), std::make_index_sequence<TYPES>{}));
+        return events;
+    }
+
+    // runs the events through both dispatches, each on its own fsm, and returns whether they ended in the same state
+    template <typename StateVariant, typename EventVariant, typename Fsm>
+    bool compare(BaoJsonBench &bench, const char *tableName, const char *visitName, uint32_t iterations, Fsm &tableFsm, Fsm &visitFsm)
+    {
+        std::vector<EventVariant> events = randomEvents<EventVariant>();
+
+        StateVariant tableStates;
+        bench.Run(tableName, iterations, [&] {
+            for (EventVariant &event : events)
+            {
+                if (auto next = dispatchTable(tableFsm, tableStates, event))
+                    tableStates = std::move(*next);
+            }
+        });
+
+        StateVariant visitStates;
+        bench.Run(visitName, iterations, [&] {
+            for (EventVariant &event : events)
+            {
+                if (auto next = dispatchVisit(visitFsm, visitStates, event))
+                    visitStates = std::move(*next);
+            }
+        });
+
+        return tableStates.index() == visitStates.index();
+    }
+} // namespace
+
+int main()
+{
+    esp_log_level_set("*", ESP_LOG_NONE);
+    BaoJsonBench bench;
+
+    BenchFsm tableFsm;
+    BenchFsm visitFsm;
+    bool same = compare<States, Events>(bench, "dispatch_1024_table", "dispatch_1024_visit", 1000, tableFsm, visitFsm);
+    same &= tableFsm.handled == visitFsm.handled;
+
+    {
+        HostFuzz::QuietStdout quiet;
+
+        HostMqtt::Reset();
+        MqttClient tableMqtt;
+        MqttClient visitMqtt;
+        same &= compare<MqttFSM::States, MqttFSM::Events>(bench, "mqtt_1024_table", "mqtt_1024_visit", 200, tableMqtt, visitMqtt);
+
+        HostWifi::Reset();
+        BaoTimerService timers{BaoTimerService::eClock::MANUAL};
+        Wifi tableWifi{timers};
+        Wifi visitWifi{timers};
+        same &= compare<WifiFSM::States, WifiFSM::Events>(bench, "wifi_1024_table", "wifi_1024_visit", 200, tableWifi, visitWifi);
+    }
+
+    if (!same)
+    {
+        printf("the table and std::visit dispatched differently\n");
+        return 1;
+    }
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
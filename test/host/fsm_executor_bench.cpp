@@ -0,0 +1,134 @@
+// 5 FsmTask state machines on a task each against the same 5 on one FsmExecutor - events per second with 2 producer
+// threads, and the tasks and stack each setup asks freertos for
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "baozi_json_bench.h"
+#include "fsm_executor.h"
+#include "fsm_task.h"
+#include "host_idf.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr size_t FSMS = 5;
+    constexpr uint32_t FSM_STACK = 3072;
+    constexpr uint32_t EXECUTOR_STACK = 4096;
+    constexpr int EVENTS_PER_PRODUCER = 1000;
+
+    struct EVENT_Work
+    {
+        int value;
+    };
+    using events_t = std::variant<EVENT_Work>;
+
+    struct STATE_Idle
+    {
+    };
+    using states_t = std::variant<STATE_Idle>;
+
+    class CounterFsm : public FsmTask<CounterFsm, states_t, events_t, 8>
+    {
+    public:
+        // a task of its own
+        explicit CounterFsm(std::atomic<int> &handled) : FsmTask(FSM_STACK, 5, "counter"), m_handled(handled) {}
+        // on a shared executor
+        CounterFsm(FsmExecutor &executor, std::atomic<int> &handled) : FsmTask(executor), m_handled(handled) {}
+
+        void on_entry(STATE_Idle &) {}
+
+        std::optional<states_t> on_event(STATE_Idle &, EVENT_Work &event)
+        {
+            m_handled.fetch_add(event.value, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+    private:
+        std::atomic<int> &m_handled;
+    };
+
+    struct resources_t
+    {
+        uint32_t tasks;
+        uint32_t stackBytes;
+    };
+
+    // the fsms run on tasks that never end, so they are never freed
+    template <typename Create>
+    std::vector<CounterFsm *> createFsms(Create &&create, resources_t &resources)
+    {
+        uint32_t tasks = HostIdf::CreatedTaskCount();
+        uint32_t stackBytes = HostIdf::CreatedTaskStackBytes();
+
+        std::vector<CounterFsm *> fsms = create();
+        for (CounterFsm *fsm : fsms)
+            fsm->Start();
+
+        resources = {HostIdf::CreatedTaskCount() - tasks, HostIdf::CreatedTaskStackBytes() - stackBytes};
+        return fsms;
+    }
+
+    // 2 producers spread their events over every fsm, then wait until all are handled
+    void produce(const std::vector<CounterFsm *> &fsms, std::atomic<int> &handled)
+    {
+        int expected = handled.load() + 2 * EVENTS_PER_PRODUCER;
+        auto producer = [&fsms]() {
+            for (int i = 0; i < EVENTS_PER_PRODUCER; i++)
+                fsms[i % FSMS]->Dispatch(EVENT_Work{1}, portMAX_DELAY);
+        };
+
+        std::thread first(producer);
+        std::thread second(producer);
+        first.join();
+        second.join();
+
+        while (handled.load() < expected)
+            std::this_thread::yield();
+    }
+
+    BaoJson toJson(const resources_t &resources)
+    {
+        return BaoJson{KV{"tasks", static_cast<int>(resources.tasks)}, KV{"stackBytes", static_cast<int>(resources.stackBytes)}};
+    }
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 200;
+
+    std::atomic<int> dedicatedHandled{0};
+    resources_t dedicated{};
+    auto dedicatedFsms = createFsms([&] {
+        std::vector<CounterFsm *> fsms;
+        for (size_t i = 0; i < FSMS; i++)
+            fsms.push_back(new CounterFsm(dedicatedHandled));
+        return fsms;
+    }, dedicated);
+
+    std::atomic<int> sharedHandled{0};
+    resources_t shared{};
+    auto sharedFsms = createFsms([&] {
+        FsmExecutor *executor = new FsmExecutor(EXECUTOR_STACK, 5, "fsm_executor");
+        std::vector<CounterFsm *> fsms;
+        for (size_t i = 0; i < FSMS; i++)
+            fsms.push_back(new CounterFsm(*executor, sharedHandled));
+        return fsms;
+    }, shared);
+
+    BaoJsonBench bench;
+    bench.Run("dedicated_tasks_2000_events", ITERATIONS, [&] { produce(dedicatedFsms, dedicatedHandled); });
+    bench.Run("executor_2000_events", ITERATIONS, [&] { produce(sharedFsms, sharedHandled); });
+    printf("%s\n", bench.Report().PrintRaw().get());
+
+    // a task also costs its TCB, and every fsm on an executor its FsmExecutor::member_t, which is part of sizeof the fsm
+    printf("%s\n", BaoJson{KV{"dedicated", toJson(dedicated)}, KV{"executor", toJson(shared)},
+                           KV{"fsmBytes", static_cast<int>(sizeof(CounterFsm))},
+                           KV{"memberBytes", static_cast<int>(sizeof(FsmExecutor::member_t))}}
+                       .PrintRaw()
+                       .get());
+    return 0;
+}
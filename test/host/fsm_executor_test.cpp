@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <variant>
+#include <vector>
+#include "fsm_executor.h"
+#include "fsm_task.h"
+#include "host_idf.h"
+
+namespace
+{
+    // the handled events of every fsm of a test, in the order the executor handled them
+    class Log
+    {
+    public:
+        void Add(const std::string &entry)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.push_back(entry);
+            m_changed.notify_all();
+        }
+
+        std::vector<std::string> WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait_for(lock, std::chrono::seconds(5), [&] { return m_entries.size() >= count; });
+            return m_entries;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::vector<std::string> m_entries;
+    };
+
+    // holds the executor's task inside a handler, so the test can queue events to every fsm behind it
+    class Gate
+    {
+    public:
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiting = true;
+            m_changed.notify_all();
+            m_changed.wait(lock, [this] { return m_open; });
+        }
+
+        void WaitForWaiter()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this] { return m_waiting; });
+        }
+
+        void Open()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_changed.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_waiting = false;
+        bool m_open = false;
+    };
+
+    struct EVENT_Block
+    {
+        Gate *gate;
+    };
+
+    struct EVENT_Work
+    {
+        int number;
+    };
+
+    struct EVENT_Switch
+    {
+    };
+
+    struct STATE_Idle
+    {
+    };
+
+    struct STATE_Switched
+    {
+    };
+
+    using events_t = std::variant<EVENT_Block, EVENT_Work, EVENT_Switch>;
+    using states_t = std::variant<STATE_Idle, STATE_Switched>;
+
+    class WorkerFsm : public FsmTask<WorkerFsm, states_t, events_t, 4>
+    {
+    public:
+        WorkerFsm(FsmExecutor &executor, uint8_t priority, const char *name, Log &log)
+            : FsmTask(executor, priority), m_name(name), m_log(log)
+        {
+        }
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        template <typename State>
+        std::optional<states_t> on_event(State &, EVENT_Block &event)
+        {
+            m_log.Add(m_name + " block");
+            event.gate->Wait();
+            return std::nullopt;
+        }
+
+        template <typename State>
+        std::optional<states_t> on_event(State &, EVENT_Work &event)
+        {
+            m_log.Add(m_name + std::to_string(event.number));
+            return std::nullopt;
+        }
+
+        std::optional<states_t> on_event(STATE_Idle &, EVENT_Switch &)
+        {
+            m_log.Add(m_name + " switch");
+            return STATE_Switched{};
+        }
+
+        std::optional<states_t> on_event(STATE_Switched &, EVENT_Switch &) { return std::nullopt; }
+
+    private:
+        std::string m_name;
+        Log &m_log;
+    };
+
+    // executors and their fsms run on tasks that never end, so they are never freed
+    FsmExecutor &newExecutor()
+    {
+        return *new FsmExecutor(4096, 5, "fsm_executor");
+    }
+
+    WorkerFsm &startedWorker(FsmExecutor &executor, uint8_t priority, const char *name, Log &log)
+    {
+        WorkerFsm *fsm = new WorkerFsm(executor, priority, name, log);
+        fsm->Start();
+        return *fsm;
+    }
+} // namespace
+
+TEST(FsmExecutor, RunsItsFsmsWithoutATaskEach)
+{
+    Log log;
+    uint32_t tasksBefore = HostIdf::CreatedTaskCount();
+
+    FsmExecutor &executor = newExecutor();
+    WorkerFsm &first = startedWorker(executor, 0, "first", log);
+    WorkerFsm &second = startedWorker(executor, 0, "second", log);
+    EXPECT_EQ(HostIdf::CreatedTaskCount(), tasksBefore + 1);
+
+    ASSERT_TRUE(first.Dispatch(EVENT_Switch{}));
+    ASSERT_TRUE(second.Dispatch(EVENT_Work{1}));
+    log.WaitFor(2);
+
+    EXPECT_TRUE(first.IsInState<STATE_Switched>());
+    EXPECT_TRUE(second.IsInState<STATE_Idle>());
+}
+
+TEST(FsmExecutor, SharesTheTaskRoundRobinAndHandlesHigherPrioritiesFirst)
+{
+    Log log;
+    Gate gate;
+    FsmExecutor &executor = newExecutor();
+    WorkerFsm &low = startedWorker(executor, 0, "low", log);
+    WorkerFsm &a = startedWorker(executor, 1, "a", log);
+    WorkerFsm &b = startedWorker(executor, 1, "b", log);
+    WorkerFsm &high = startedWorker(executor, 2, "high", log);
+
+    ASSERT_TRUE(low.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+
+    // a burst on one fsm must not starve the other fsm of its priority
+    for (int i = 1; i <= 3; i++)
+        ASSERT_TRUE(a.Dispatch(EVENT_Work{i}));
+    ASSERT_TRUE(b.Dispatch(EVENT_Work{1}));
+    ASSERT_TRUE(b.Dispatch(EVENT_Work{2}));
+    ASSERT_TRUE(low.Dispatch(EVENT_Work{1}));
+    ASSERT_TRUE(high.Dispatch(EVENT_Work{1}));
+
+    gate.Open();
+    EXPECT_EQ(log.WaitFor(8), (std::vector<std::string>{"low block", "high1", "a1", "b1", "a2", "b2", "a3", "low1"}));
+}
+
+TEST(FsmExecutor, KeepsTheOrderOfEachFsmUnderConcurrentDispatch)
+{
+    static constexpr int EVENTS = 500;
+    Log log;
+    FsmExecutor &executor = newExecutor();
+    WorkerFsm &a = startedWorker(executor, 0, "a", log);
+    WorkerFsm &b = startedWorker(executor, 0, "b", log);
+
+    auto produce = [](WorkerFsm &fsm) {
+        for (int i = 0; i < EVENTS; i++)
+            ASSERT_TRUE(fsm.Dispatch(EVENT_Work{i}, portMAX_DELAY));
+    };
+    std::thread producerA(produce, std::ref(a));
+    std::thread producerB(produce, std::ref(b));
+    producerA.join();
+    producerB.join();
+
+    auto entries = log.WaitFor(2 * EVENTS);
+    ASSERT_EQ(entries.size(), 2u * EVENTS);
+
+    int nextA = 0;
+    int nextB = 0;
+    for (const std::string &entry : entries)
+    {
+        if (entry[0] == 'a')
+            EXPECT_EQ(entry, "a" + std::to_string(nextA++));
+        else
+            EXPECT_EQ(entry, "b" + std::to_string(nextB++));
+    }
+}
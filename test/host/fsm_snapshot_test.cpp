@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+#include "fsm_snapshot.h"
+#include "fsm_task.h"
+#include "fsm_taskless.h"
+
+namespace
+{
+    struct STATE_Idle
+    {
+    };
+
+    struct STATE_Measuring
+    {
+        uint32_t samples;
+        float last;
+    };
+
+    struct EVENT_Sample
+    {
+        float value;
+    };
+
+    using states_t = std::variant<STATE_Idle, STATE_Measuring>;
+    using events_t = std::variant<EVENT_Sample>;
+
+    // the states of a firmware that added a field to STATE_Measuring
+    struct STATE_MeasuringV2
+    {
+        uint32_t samples;
+        float last;
+        float average;
+    };
+    using states_v2_t = std::variant<STATE_Idle, STATE_MeasuringV2>;
+
+    class SensorFsm : public FsmTaskless<SensorFsm, states_t, events_t>
+    {
+    public:
+        std::vector<std::string> entered;
+
+        void on_entry(STATE_Idle &) { entered.push_back("idle"); }
+        void on_entry(STATE_Measuring &state) { entered.push_back("measuring " + std::to_string(state.samples)); }
+
+        std::optional<states_t> on_event(STATE_Idle &, EVENT_Sample &event) { return STATE_Measuring{1, event.value}; }
+
+        std::optional<states_t> on_event(STATE_Measuring &state, EVENT_Sample &event)
+        {
+            state.samples++;
+            state.last = event.value;
+            return std::nullopt;
+        }
+
+        const STATE_Measuring &Measuring() { return Get<STATE_Measuring>(); }
+    };
+
+    class SensorTaskFsm : public FsmTask<SensorTaskFsm, states_t, events_t>
+    {
+    public:
+        SensorTaskFsm() : FsmTask(4096, 5, "sensor") {}
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        std::optional<states_t> on_event(STATE_Idle &, EVENT_Sample &event) { return STATE_Measuring{1, event.value}; }
+        std::optional<states_t> on_event(STATE_Measuring &, EVENT_Sample &) { return std::nullopt; }
+    };
+
+    // stands in for the RTC_NOINIT region, whatever it holds survives from one "boot" to the next
+    struct rtc_region_t
+    {
+        alignas(8) std::byte bytes[64];
+
+        template <typename States>
+        FsmSnapshot<States> &As()
+        {
+            static_assert(sizeof(FsmSnapshot<States>) <= sizeof(bytes));
+            return *std::launder(reinterpret_cast<FsmSnapshot<States> *>(bytes));
+        }
+    };
+
+    // a snapshot saved while measuring 3 samples, the last 21.5
+    rtc_region_t savedRegion()
+    {
+        rtc_region_t region{};
+        SensorFsm fsm;
+        fsm.Start();
+        for (float value : {20.0f, 21.0f, 21.5f})
+            fsm.Dispatch(EVENT_Sample{value});
+
+        fsm.SaveSnapshot(region.As<states_t>());
+        return region;
+    }
+} // namespace
+
+TEST(FsmSnapshot, ResumesTheSavedStateWithItsPayload)
+{
+    rtc_region_t region = savedRegion();
+    ASSERT_TRUE(region.As<states_t>().IsValid());
+
+    SensorFsm woken;
+    EXPECT_TRUE(woken.StartFromSnapshot(region.As<states_t>()));
+    ASSERT_TRUE(woken.IsInState<STATE_Measuring>());
+    EXPECT_EQ(woken.Measuring().samples, 3u);
+    EXPECT_EQ(woken.Measuring().last, 21.5f);
+    EXPECT_EQ(woken.entered, (std::vector<std::string>{"measuring 3"}));
+
+    woken.Dispatch(EVENT_Sample{22.0f});
+    EXPECT_EQ(woken.Measuring().samples, 4u);
+}
+
+TEST(FsmSnapshot, FsmTaskResumesTooAndStartsOverWithoutASnapshot)
+{
+    rtc_region_t region = savedRegion();
+
+    // the task of an fsm never ends, so neither does the fsm
+    SensorTaskFsm *woken = new SensorTaskFsm;
+    EXPECT_TRUE(woken->StartFromSnapshot(region.As<states_t>()));
+    EXPECT_TRUE(woken->IsInState<STATE_Measuring>());
+
+    SensorTaskFsm *rebooted = new SensorTaskFsm;
+    EXPECT_FALSE(rebooted->StartFromSnapshot(region.As<states_t>()));
+    EXPECT_TRUE(rebooted->IsInState<STATE_Idle>());
+}
+
+TEST(FsmSnapshot, IsUsedOnlyOnce)
+{
+    rtc_region_t region = savedRegion();
+    FsmSnapshot<states_t> &snapshot = region.As<states_t>();
+
+    ASSERT_TRUE(snapshot.Take().has_value());
+    EXPECT_FALSE(snapshot.IsValid());
+    EXPECT_FALSE(snapshot.Take().has_value());
+
+    // a reset after the wake starts from scratch
+    SensorFsm rebooted;
+    EXPECT_FALSE(rebooted.StartFromSnapshot(snapshot));
+    EXPECT_TRUE(rebooted.IsInState<STATE_Idle>());
+    EXPECT_EQ(rebooted.entered, (std::vector<std::string>{"idle"}));
+}
+
+TEST(FsmSnapshot, IgnoresGarbageAfterPowerOn)
+{
+    std::mt19937 random{42};
+    for (int i = 0; i < 1000; i++)
+    {
+        rtc_region_t region;
+        for (std::byte &byte : region.bytes)
+            byte = static_cast<std::byte>(random());
+
+        EXPECT_FALSE(region.As<states_t>().IsValid());
+        EXPECT_FALSE(region.As<states_t>().Take().has_value());
+    }
+
+    rtc_region_t zeros{};
+    EXPECT_FALSE(zeros.As<states_t>().IsValid());
+}
+
+TEST(FsmSnapshot, IgnoresTheSnapshotOfAFirmwareWithOtherStates)
+{
+    rtc_region_t region = savedRegion();
+
+    EXPECT_TRUE(region.As<states_t>().IsValid());
+    EXPECT_FALSE(region.As<states_v2_t>().IsValid());
+    EXPECT_FALSE(region.As<states_v2_t>().Take().has_value());
+}
+
+TEST(FsmSnapshot, RejectsACorruptionOfAnyField)
+{
+    const rtc_region_t saved = savedRegion();
+
+    // magic, fingerprint, index and crc come first, the payload after them
+    struct field_t
+    {
+        const char *name;
+        size_t offset;
+    };
+    const field_t fields[] = {{"magic", 0}, {"fingerprint", 4}, {"index", 8}, {"crc", 12}, {"samples", 16}, {"last", 20}};
+
+    for (const field_t &field : fields)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            rtc_region_t region = saved;
+            region.bytes[field.offset] ^= static_cast<std::byte>(1u << bit);
+            EXPECT_FALSE(region.As<states_t>().IsValid()) << field.name << " bit " << int(bit);
+        }
+    }
+
+    // an index past the states is rejected even with the crc fixed up to match - only Save() writes a valid one
+    auto withIndex = [&saved](uint32_t index) {
+        rtc_region_t region = saved;
+        std::memcpy(region.bytes + 8, &index, sizeof(index));
+        uint32_t crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t *>(region.bytes), 12);
+        crc = esp_rom_crc32_le(crc, reinterpret_cast<const uint8_t *>(region.bytes + 16), sizeof(STATE_Measuring));
+        std::memcpy(region.bytes + 12, &crc, sizeof(crc));
+        return region;
+    };
+    EXPECT_TRUE(withIndex(1).As<states_t>().IsValid()); // the fix up matches the saved crc
+    EXPECT_FALSE(withIndex(std::variant_size_v<states_t>).As<states_t>().IsValid());
+}
@@ -0,0 +1,370 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "fsm_task.h"
+
+namespace
+{
+    // counts the live copies, so the test sees every event the fsm moved in is destroyed once
+    struct Tracked
+    {
+        static inline std::atomic<int> s_live{};
+
+        Tracked() { s_live++; }
+        Tracked(const Tracked &) { s_live++; }
+        Tracked(Tracked &&) noexcept { s_live++; }
+        Tracked &operator=(const Tracked &) = default;
+        Tracked &operator=(Tracked &&) noexcept = default;
+        ~Tracked() { s_live--; }
+    };
+
+    // holds the fsm's task inside a handler, so the test can fill the queue behind it
+    class Gate
+    {
+    public:
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_waiting = true;
+            m_changed.notify_all();
+            m_changed.wait(lock, [this] { return m_open; });
+        }
+
+        void WaitForWaiter()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this] { return m_waiting; });
+        }
+
+        void Open()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_changed.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_waiting = false;
+        bool m_open = false;
+    };
+
+    struct EVENT_Block
+    {
+        Gate *gate;
+    };
+
+    struct EVENT_Text
+    {
+        std::string text;
+        Tracked tracked{};
+    };
+
+    struct EVENT_Alarm
+    {
+        static constexpr FsmEventPolicy POLICY{.urgent = true};
+        std::string text;
+    };
+
+    // only the latest matters
+    struct EVENT_Tick
+    {
+        static constexpr FsmEventPolicy POLICY{.coalesce = true};
+        std::string text;
+    };
+
+    // newer samples are worth more than older events
+    struct EVENT_Sample
+    {
+        static constexpr FsmEventPolicy POLICY{.dropOldest = true};
+        std::string text;
+    };
+
+    struct EVENT_Reading
+    {
+        static constexpr FsmEventPolicy POLICY{.coalesce = true, .dropOldest = true};
+        std::string text;
+    };
+
+    struct STATE_Idle
+    {
+    };
+
+    using events_t = std::variant<EVENT_Block, EVENT_Text, EVENT_Alarm, EVENT_Tick, EVENT_Sample, EVENT_Reading>;
+    using states_t = std::variant<STATE_Idle>;
+
+    class RecorderFsm : public FsmTask<RecorderFsm, states_t, events_t, 3>
+    {
+    public:
+        RecorderFsm() : FsmTask(4096, 5, "recorder") {}
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        std::optional<states_t> on_event(STATE_Idle &, EVENT_Block &event)
+        {
+            record("block");
+            event.gate->Wait();
+            return std::nullopt;
+        }
+
+        template <typename Event>
+            requires requires(Event event) { event.text; }
+        std::optional<states_t> on_event(STATE_Idle &, Event &event)
+        {
+            record(event.text);
+            return std::nullopt;
+        }
+
+        std::vector<std::string> WaitForHandled(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_handledChanged.wait_for(lock, std::chrono::seconds(5), [&] { return m_handled.size() >= count; });
+            return m_handled;
+        }
+
+        size_t HandledCount()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_handled.size();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_handledChanged;
+        std::vector<std::string> m_handled;
+
+        void record(const std::string &name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_handled.push_back(name);
+            m_handledChanged.notify_all();
+        }
+    };
+
+    // the task of an fsm never ends, so neither does the fsm
+    RecorderFsm &startedFsm()
+    {
+        RecorderFsm *fsm = new RecorderFsm;
+        fsm->Start();
+        return *fsm;
+    }
+
+    bool eventually(const std::function<bool()> &condition)
+    {
+        for (int i = 0; i < 500 && !condition(); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return condition();
+    }
+} // namespace
+
+TEST(FsmTask, MovesNonTrivialEventsInAndDestroysThemOnce)
+{
+    RecorderFsm &fsm = startedFsm();
+    std::vector<std::string> expected;
+
+    for (int i = 0; i < 200; i++)
+    {
+        // long enough to be on the heap, a memcpy of it would double free
+        std::string text = "event number " + std::to_string(i) + " with a heap allocated text";
+        expected.push_back(text);
+        ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = text}, portMAX_DELAY));
+    }
+
+    EXPECT_EQ(fsm.WaitForHandled(expected.size()), expected);
+    EXPECT_TRUE(eventually([] { return Tracked::s_live == 0; }));
+}
+
+TEST(FsmTask, HandlesUrgentEventsBeforeQueuedNormalOnes)
+{
+    RecorderFsm &fsm = startedFsm();
+    Gate gate;
+
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 1"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 2"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Alarm{"urgent"}));
+
+    // the single urgent slot is taken until the task gets to it
+    EXPECT_FALSE(fsm.Dispatch(EVENT_Alarm{"second urgent"}));
+
+    gate.Open();
+    EXPECT_EQ(fsm.WaitForHandled(4), (std::vector<std::string>{"block", "urgent", "normal 1", "normal 2"}));
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.peakUrgentDepth, 1u);
+}
+
+TEST(FsmTask, RejectsOnAFullSlotPoolAndWaitsForAFreedSlot)
+{
+    RecorderFsm &fsm = startedFsm();
+    Gate gate;
+
+    // the blocked event keeps its slot while it is handled, two of the three are left
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "queued 1"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "queued 2"}));
+
+    EXPECT_FALSE(fsm.Dispatch(EVENT_Text{.text = "rejected"}));
+    EXPECT_FALSE(fsm.Dispatch(EVENT_Text{.text = "timed out"}, 5));
+
+    // the urgent lane has slots of its own
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Alarm{"urgent"}));
+
+    std::atomic<bool> dispatched{false};
+    std::thread waiter([&] { dispatched = fsm.Dispatch(EVENT_Text{.text = "waited"}, portMAX_DELAY); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(dispatched);
+
+    gate.Open();
+    waiter.join();
+    EXPECT_TRUE(dispatched);
+
+    EXPECT_EQ(fsm.WaitForHandled(5), (std::vector<std::string>{"block", "urgent", "queued 1", "queued 2", "waited"}));
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.rejected, 2u);
+    EXPECT_EQ(stats.peakDepth, 3u);
+    EXPECT_TRUE(eventually([] { return Tracked::s_live == 0; }));
+}
+
+TEST(FsmTask, CoalescesAPendingEventOfTheSameType)
+{
+    RecorderFsm &fsm = startedFsm();
+    Gate gate;
+
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Tick{"tick 1"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal"}));
+
+    // the lane is full, the newer ticks take the pending tick's slot and its place at the back
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Tick{"tick 2"}));
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Tick{"tick 3"}));
+
+    gate.Open();
+    EXPECT_EQ(fsm.WaitForHandled(3), (std::vector<std::string>{"block", "normal", "tick 3"}));
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.coalesced, 2u);
+    EXPECT_EQ(stats.droppedOldest, 0u);
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_TRUE(eventually([] { return Tracked::s_live == 0; }));
+}
+
+TEST(FsmTask, DropsTheOldestPendingEventOfAFullLane)
+{
+    RecorderFsm &fsm = startedFsm();
+    Gate gate;
+
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 1"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 2"}));
+
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Sample{"sample 1"}));
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Sample{"sample 2"}));
+
+    // events without a policy are still rejected, nothing is dropped for them
+    EXPECT_FALSE(fsm.Dispatch(EVENT_Text{.text = "rejected"}));
+
+    gate.Open();
+    EXPECT_EQ(fsm.WaitForHandled(3), (std::vector<std::string>{"block", "sample 1", "sample 2"}));
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.droppedOldest, 2u);
+    EXPECT_EQ(stats.coalesced, 0u);
+    EXPECT_EQ(stats.rejected, 1u);
+    EXPECT_EQ(stats.peakDepth, 3u);
+    EXPECT_TRUE(eventually([] { return Tracked::s_live == 0; }));
+}
+
+TEST(FsmTask, CoalescesBeforeDroppingTheOldest)
+{
+    RecorderFsm &fsm = startedFsm();
+    Gate gate;
+
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&gate}));
+    gate.WaitForWaiter();
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Reading{"reading 1"}));
+
+    // a pending reading is replaced, the normal event survives
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Reading{"reading 2"}));
+
+    gate.Open();
+    EXPECT_EQ(fsm.WaitForHandled(3), (std::vector<std::string>{"block", "normal", "reading 2"}));
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.coalesced, 1u);
+    EXPECT_EQ(stats.droppedOldest, 0u);
+
+    // with no reading pending, the oldest event makes room
+    Gate second;
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Block{&second}));
+    second.WaitForWaiter();
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 1"}));
+    ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = "normal 2"}));
+    EXPECT_TRUE(fsm.Dispatch(EVENT_Reading{"reading 3"}));
+
+    second.Open();
+    EXPECT_EQ(fsm.WaitForHandled(6), (std::vector<std::string>{"block", "normal", "reading 2", "block", "normal 2", "reading 3"}));
+    EXPECT_EQ(fsm.GetQueueStats().droppedOldest, 1u);
+}
+
+// a burst keeps the normal lane full while alarms are dispatched - every alarm is handled before any normal event
+// queued after it, at most the one being handled when it arrived goes first
+TEST(FsmTask, HandlesUrgentEventsInBoundedTimeDuringABurst)
+{
+    static constexpr int BURST = 2000;
+    static constexpr int ALARMS = 50;
+    RecorderFsm &fsm = startedFsm();
+
+    auto burst = [&fsm](int producer) {
+        for (int i = 0; i < BURST; i++)
+            ASSERT_TRUE(fsm.Dispatch(EVENT_Text{.text = std::to_string(producer)}, portMAX_DELAY));
+    };
+    std::thread first(burst, 1);
+    std::thread second(burst, 2);
+
+    std::vector<size_t> handledAtDispatch;
+    for (int i = 0; i < ALARMS; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        ASSERT_TRUE(fsm.Dispatch(EVENT_Alarm{"alarm " + std::to_string(i)}, portMAX_DELAY));
+        handledAtDispatch.push_back(fsm.HandledCount());
+    }
+
+    first.join();
+    second.join();
+    auto handled = fsm.WaitForHandled(2 * BURST + ALARMS);
+    ASSERT_EQ(handled.size(), 2u * BURST + ALARMS);
+
+    for (int i = 0; i < ALARMS; i++)
+    {
+        size_t position = std::find(handled.begin(), handled.end(), "alarm " + std::to_string(i)) - handled.begin();
+        ASSERT_LT(position, handled.size());
+        if (position > handledAtDispatch[i])
+        {
+            EXPECT_LE(position - handledAtDispatch[i], 1u) << "alarm " << i;
+        }
+    }
+
+    auto stats = fsm.GetQueueStats();
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_EQ(stats.peakDepth, 3u);
+    EXPECT_EQ(stats.peakUrgentDepth, 1u);
+}
@@ -0,0 +1,73 @@
+// FsmTaskless Dispatch() and DispatchSync() from one task, and DispatchSync() while other tasks keep the inbox busy -
+// a DispatchSync() whose event is drained by another task waits on its semaphore instead of polling every tick
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "baozi_json_bench.h"
+#include "fsm_taskless.h"
+
+using namespace Baozi;
+
+namespace
+{
+    struct EVENT_Tick
+    {
+        int value;
+    };
+
+    struct STATE_Running
+    {
+    };
+
+    class TickFsm : public FsmTaskless<TickFsm, std::variant<STATE_Running>, std::variant<EVENT_Tick>>
+    {
+    public:
+        std::atomic<int> sum{0};
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        std::optional<std::variant<STATE_Running>> on_event(STATE_Running &, EVENT_Tick &event)
+        {
+            sum.fetch_add(event.value, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+    };
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+    static constexpr int CONTENDERS = 3;
+
+    TickFsm fsm;
+    fsm.Start();
+
+    BaoJsonBench bench;
+
+    bench.Run("dispatch_uncontended", ITERATIONS, [&] { fsm.Dispatch(EVENT_Tick{1}); });
+    bench.Run("dispatch_sync_uncontended", ITERATIONS, [&] { fsm.DispatchSync(EVENT_Tick{1}); });
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> contenders;
+    for (int i = 0; i < CONTENDERS; i++)
+    {
+        contenders.emplace_back([&] {
+            while (!stop)
+                fsm.Dispatch(EVENT_Tick{1});
+        });
+    }
+
+    bench.Run("dispatch_contended_3", ITERATIONS, [&] { fsm.Dispatch(EVENT_Tick{1}); });
+    bench.Run("dispatch_sync_contended_3", ITERATIONS, [&] { fsm.DispatchSync(EVENT_Tick{1}); });
+
+    stop = true;
+    for (std::thread &contender : contenders)
+        contender.join();
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "fsm_taskless.h"
+
+namespace
+{
+    static constexpr int PRODUCERS = 4;
+
+    struct EVENT_Count
+    {
+        int producer;
+        int sequence;
+        std::string padding; // non trivial, the inbox moves it in and destroys it
+    };
+
+    struct EVENT_Chain
+    {
+        int remaining;
+    };
+
+    struct STATE_Counting
+    {
+    };
+
+    using events_t = std::variant<EVENT_Count, EVENT_Chain>;
+    using states_t = std::variant<STATE_Counting>;
+
+    class CounterFsm : public FsmTaskless<CounterFsm, states_t, events_t>
+    {
+    public:
+        std::array<std::atomic<int>, PRODUCERS> handled{};
+        std::atomic<int> outOfOrder{0};
+        std::atomic<int> overlapping{0};
+        std::vector<int> chain;
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        std::optional<states_t> on_event(STATE_Counting &, EVENT_Count &event)
+        {
+            if (m_isHandling.exchange(true))
+                overlapping++;
+
+            // every producer's events are handled in the order it dispatched them
+            if (event.sequence != handled[event.producer].load())
+                outOfOrder++;
+            handled[event.producer].store(event.sequence + 1);
+
+            m_isHandling.store(false);
+            return std::nullopt;
+        }
+
+        std::optional<states_t> on_event(STATE_Counting &, EVENT_Chain &event)
+        {
+            chain.push_back(event.remaining);
+            if (event.remaining > 0)
+            {
+                Dispatch(EVENT_Chain{event.remaining - 1});
+                chain.push_back(-event.remaining); // the dispatched event waits for this handler to return
+            }
+            return std::nullopt;
+        }
+
+    private:
+        std::atomic<bool> m_isHandling{false};
+    };
+
+    template <typename F>
+    void runProducers(F &&produce)
+    {
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; p++)
+            producers.emplace_back([&, p] { produce(p); });
+        for (std::thread &producer : producers)
+            producer.join();
+    }
+} // namespace
+
+TEST(FsmTaskless, HandlesEveryEventOfManyProducersOnceAndInOrder)
+{
+    static constexpr int EVENTS = 20000;
+    CounterFsm fsm;
+    fsm.Start();
+
+    runProducers([&](int p) {
+        for (int i = 0; i < EVENTS; i++)
+        {
+            // a full inbox drops the event, the producer retries
+            while (!fsm.Dispatch(EVENT_Count{p, i, std::string(32, 'x')}))
+                std::this_thread::yield();
+        }
+    });
+    fsm.ProcessInbox();
+
+    for (int p = 0; p < PRODUCERS; p++)
+        EXPECT_EQ(fsm.handled[p].load(), EVENTS);
+    EXPECT_EQ(fsm.outOfOrder.load(), 0);
+    EXPECT_EQ(fsm.overlapping.load(), 0);
+}
+
+TEST(FsmTaskless, DispatchSyncReturnsOnlyOnceItsEventWasHandled)
+{
+    static constexpr int EVENTS = 5000;
+    CounterFsm fsm;
+    fsm.Start();
+    std::atomic<int> early{0};
+
+    runProducers([&](int p) {
+        for (int i = 0; i < EVENTS; i++)
+        {
+            fsm.DispatchSync(EVENT_Count{p, i, std::string(32, 'x')});
+            if (fsm.handled[p].load() != i + 1)
+                early++;
+        }
+    });
+
+    EXPECT_EQ(early.load(), 0);
+    EXPECT_EQ(fsm.outOfOrder.load(), 0);
+    EXPECT_EQ(fsm.overlapping.load(), 0);
+}
+
+TEST(FsmTaskless, MixesDispatchAndDispatchSyncProducers)
+{
+    static constexpr int EVENTS = 5000;
+    CounterFsm fsm;
+    fsm.Start();
+
+    runProducers([&](int p) {
+        for (int i = 0; i < EVENTS; i++)
+        {
+            if (p % 2 == 0)
+            {
+                fsm.DispatchSync(EVENT_Count{p, i, {}});
+                continue;
+            }
+
+            while (!fsm.Dispatch(EVENT_Count{p, i, {}}))
+                std::this_thread::yield();
+        }
+    });
+    fsm.ProcessInbox();
+
+    for (int p = 0; p < PRODUCERS; p++)
+        EXPECT_EQ(fsm.handled[p].load(), EVENTS);
+    EXPECT_EQ(fsm.outOfOrder.load(), 0);
+    EXPECT_EQ(fsm.overlapping.load(), 0);
+}
+
+TEST(FsmTaskless, HandlesEventsDispatchedByAHandlerAfterIt)
+{
+    CounterFsm fsm;
+    fsm.Start();
+
+    fsm.Dispatch(EVENT_Chain{3});
+    EXPECT_EQ(fsm.chain, (std::vector<int>{3, -3, 2, -2, 1, -1, 0}));
+}
+
+TEST(FsmTaskless, QueuesIsrEventsUntilTheNextDrain)
+{
+    CounterFsm fsm;
+    fsm.Start();
+
+    EXPECT_TRUE(fsm.DispatchFromISR(EVENT_Count{0, 0, {}}));
+    EXPECT_TRUE(fsm.DispatchFromISR(EVENT_Count{0, 1, {}}));
+    EXPECT_EQ(fsm.handled[0].load(), 0);
+
+    fsm.ProcessInbox();
+    EXPECT_EQ(fsm.handled[0].load(), 2);
+}
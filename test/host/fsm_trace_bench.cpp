@@ -0,0 +1,85 @@
+// FsmTaskless::Dispatch() with the tracer compiled out and compiled in - built twice, as fsm_trace_bench and as
+// fsm_trace_bench_traced with FSM_TRACE_ENABLED 1, so both runs dispatch the same fsm through the same code
+
+#include <cstdio>
+#include <optional>
+#include <variant>
+#include "baozi_json_bench.h"
+#include "fsm_taskless.h"
+
+using namespace Baozi;
+
+namespace
+{
+    struct STATE_Off
+    {
+        static constexpr const char *NAME = "STATE_Off";
+    };
+    struct STATE_On
+    {
+        static constexpr const char *NAME = "STATE_On";
+    };
+    using States = std::variant<STATE_Off, STATE_On>;
+
+    struct EVENT_Toggle
+    {
+        static constexpr const char *NAME = "EVENT_Toggle";
+    };
+    struct EVENT_Ping
+    {
+        static constexpr const char *NAME = "EVENT_Ping";
+        int value;
+    };
+    using Events = std::variant<EVENT_Toggle, EVENT_Ping>;
+
+    class BenchFsm : public FsmTaskless<BenchFsm, States, Events>
+    {
+    public:
+        int pings = 0;
+
+        template <typename State>
+        void on_entry(State &) {}
+
+        std::optional<States> on_event(STATE_Off &, EVENT_Toggle &) { return STATE_On{}; }
+        std::optional<States> on_event(STATE_On &, EVENT_Toggle &) { return STATE_Off{}; }
+
+        template <typename State>
+        std::optional<States> on_event(State &, EVENT_Ping &event)
+        {
+            pings += event.value;
+            return std::nullopt;
+        }
+    };
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+
+    BenchFsm fsm;
+    fsm.Start();
+
+    BaoJsonBench bench;
+    bench.Run("dispatch_no_transition", ITERATIONS, [&] { fsm.Dispatch(EVENT_Ping{1}); });
+    bench.Run("dispatch_transition", ITERATIONS, [&] { fsm.Dispatch(EVENT_Toggle{}); });
+
+#if FSM_TRACE_ENABLED
+    // every dispatch must have been counted, or the traced numbers measure less than they claim
+    uint32_t traced = 0;
+    for (size_t state = 0; state < 2; state++)
+    {
+        for (size_t event = 0; event < 2; event++)
+            traced += fsm.GetTracer().Histogram(state, event).count;
+    }
+
+    if (traced != 2 * (1 + 2 * ITERATIONS))
+    {
+        printf("the tracer counted %lu dispatches\n", (unsigned long)traced);
+        return 1;
+    }
+#endif
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    printf("%s\n", BaoJson{KV{"traced", FSM_TRACE_ENABLED == 1}, KV{"fsm_bytes", static_cast<int>(sizeof(BenchFsm))}}.PrintRaw().get());
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <variant>
+#include <vector>
+#include "fsm_trace.h"
+
+namespace
+{
+    struct STATE_Named
+    {
+        static constexpr const char *NAME = "STATE_Named";
+    };
+    struct STATE_Unnamed
+    {
+    };
+    using States = std::variant<STATE_Named, STATE_Unnamed>;
+
+    struct EVENT_Named
+    {
+        static constexpr const char *NAME = "EVENT_Named";
+    };
+    using Events = std::variant<EVENT_Named>;
+
+    using Tracer = FsmTracer<States, Events, 4>;
+} // namespace
+
+TEST(FsmTracer, KeepsTheLastRecordsOldestFirst)
+{
+    Tracer tracer;
+    for (uint32_t i = 0; i < 6; i++)
+        tracer.Record(i % 2, 0, Tracer::NO_TRANSITION, i);
+
+    std::vector<uint32_t> cycles;
+    tracer.ForEachRecord([&](const Tracer::record_t &record) {
+        cycles.push_back(record.cycles);
+        EXPECT_EQ(record.state, record.cycles % 2);
+        EXPECT_EQ(record.newState, Tracer::NO_TRANSITION);
+    });
+    EXPECT_EQ(cycles, (std::vector<uint32_t>{2, 3, 4, 5}));
+}
+
+TEST(FsmTracer, CountsDurationsIntoLog2Buckets)
+{
+    Tracer tracer;
+    for (uint32_t cycles : {0u, 1023u, 1024u, 2047u, 2048u, UINT32_MAX})
+        tracer.Record(0, 0, 1, cycles);
+
+    auto histogram = tracer.Histogram(0, 0);
+    EXPECT_EQ(histogram.count, 6u);
+    EXPECT_EQ(histogram.maxCycles, UINT32_MAX);
+    EXPECT_EQ(histogram.buckets[0], 2u);
+    EXPECT_EQ(histogram.buckets[1], 2u);
+    EXPECT_EQ(histogram.buckets[2], 1u);
+    EXPECT_EQ(histogram.buckets[Tracer::BUCKETS - 1], 1u);
+    EXPECT_EQ(tracer.Histogram(1, 0).count, 0u);
+}
+
+TEST(FsmTracer, DumpsByNameOrIndex)
+{
+    Tracer tracer;
+    tracer.Record(0, 0, 1, 100);
+    tracer.Record(1, 0, Tracer::NO_TRANSITION, 200);
+
+    std::string dump = tracer.ToJson().PrintRaw().get();
+    EXPECT_NE(dump.find(R"("state":"STATE_Named","event":"EVENT_Named","next":1,"cycles":100)"), std::string::npos) << dump;
+    EXPECT_NE(dump.find(R"("state":1,"event":"EVENT_Named","cycles":200)"), std::string::npos) << dump;
+    EXPECT_NE(dump.find(R"({"state":"STATE_Named","event":"EVENT_Named","count":1,"max":100,"buckets":[1,0,0,0,0,0,0,0,0,0,0,0]})"),
+              std::string::npos)
+        << dump;
+}
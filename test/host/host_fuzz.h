@@ -0,0 +1,69 @@
+#ifndef HOST_FUZZ_H__
+#define HOST_FUZZ_H__
+
+// shared by the fuzz targets: the seeds to run and the report of a run. A failing seed is reproduced with
+//   wifi_fuzz <seed>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#include "baozi_json.h"
+
+namespace HostFuzz
+{
+    // the seeds given on the command line, or the fixed ones ctest runs
+    inline std::vector<uint32_t> Seeds(int argc, char **argv)
+    {
+        std::vector<uint32_t> seeds;
+        for (int i = 1; i < argc; i++)
+            seeds.push_back(static_cast<uint32_t>(strtoul(argv[i], nullptr, 0)));
+
+        if (seeds.empty())
+            seeds = {1, 2, 3, 42, 1234};
+        return seeds;
+    }
+
+    // sends stdout to /dev/null while it lives - the fsms printf every event they leave unhandled, and a fuzzer
+    // raises those all the time
+    class QuietStdout
+    {
+    public:
+        QuietStdout()
+        {
+            fflush(stdout);
+            m_stdout = dup(STDOUT_FILENO);
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+            close(null);
+        }
+
+        ~QuietStdout()
+        {
+            fflush(stdout);
+            dup2(m_stdout, STDOUT_FILENO);
+            close(m_stdout);
+        }
+
+        QuietStdout(const QuietStdout &) = delete;
+        QuietStdout &operator=(const QuietStdout &) = delete;
+
+    private:
+        int m_stdout;
+    };
+
+    template <typename Report>
+    Baozi::BaoJson ToJson(const Report &report)
+    {
+        using namespace Baozi;
+        BaoJson json{KV{"seed", static_cast<int>(report.seed)}, KV{"steps", static_cast<int>(report.steps)},
+                     KV{"events", static_cast<int>(report.events)}, KV{"virtualMs", static_cast<int>(report.nowMs)},
+                     KV{"eventsPerSecond", static_cast<int>(report.eventsPerSecond)}, KV{"passed", report.passed}};
+        if (!report.passed)
+            json.AddVal("violation", report.violation);
+        return json;
+    }
+} // namespace HostFuzz
+
+#endif // HOST_FUZZ_H__
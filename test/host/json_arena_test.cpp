@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_arena.h"
+
+using namespace Baozi;
+
+namespace
+{
+    size_t heapInUse()
+    {
+        return mallinfo2().uordblks;
+    }
+
+    bool isIn(const void *ptr, const uint8_t *buffer, size_t size)
+    {
+        auto *p = static_cast<const uint8_t *>(ptr);
+        return p >= buffer && p < buffer + size;
+    }
+} // namespace
+
+TEST(BaoJsonArena, AllocatesFromTheBuffer)
+{
+    static uint8_t buffer[1024];
+    BaoJsonArena arena{buffer};
+
+    BaoJson json{KV{"name", "baozi"}, KV{"state_topic", "baozi/state"}};
+    auto printed = json.PrintRaw();
+
+    EXPECT_GT(arena.Used(), 0u);
+    EXPECT_TRUE(isIn(json.data(), buffer, sizeof(buffer)));
+    EXPECT_TRUE(isIn(printed.get(), buffer, sizeof(buffer)));
+    EXPECT_STREQ(printed.get(), R"({"name":"baozi","state_topic":"baozi/state"})");
+}
+
+TEST(BaoJsonArena, FallsBackToTheHeapWhenFull)
+{
+    static uint8_t buffer[128];
+    BaoJsonArena::ResetStats();
+    BaoJsonArena arena{buffer};
+
+    BaoJson json{KV{"a", "a string that is long enough"}, KV{"b", "another string that is long enough"}, KV{"c", 3}};
+    auto printed = json.PrintRaw();
+
+    EXPECT_GT(BaoJsonArena::GetStats().overflows, 0u);
+    EXPECT_LE(BaoJsonArena::GetStats().highWaterMark, sizeof(buffer));
+    EXPECT_STREQ(printed.get(), R"({"a":"a string that is long enough","b":"another string that is long enough","c":3})");
+}
+
+TEST(BaoJsonArena, ResetReleasesEverything)
+{
+    static uint8_t buffer[512];
+    BaoJsonArena arena{buffer};
+    {
+        BaoJson json{KV{"x", 1}};
+    }
+    ASSERT_GT(arena.Used(), 0u);
+
+    arena.Reset();
+    EXPECT_EQ(arena.Used(), 0u);
+}
+
+TEST(BaoJsonArena, HeapIsStableOver100kCycles)
+{
+    static uint8_t buffer[1536];
+
+    auto cycle = [] {
+        BaoJsonArena arena{buffer};
+        BaoJson json{KV{"name", "Temperature"}, KV{"device_class", "temperature"}, KV{"unit_of_measurement", "C"},
+                     KV{"state_topic", "baozi/sensor/state"}, KV{"value_template", "{{ value_json.temperature }}"}};
+        auto printed = json.PrintRaw();
+        ASSERT_NE(printed, nullptr);
+    };
+
+    cycle();
+    size_t before = heapInUse();
+    BaoJsonArena::ResetStats();
+
+    for (int i = 0; i < 100000; i++)
+    {
+        cycle();
+    }
+
+    EXPECT_EQ(heapInUse(), before);
+    EXPECT_EQ(BaoJsonArena::GetStats().overflows, 0u);
+}
+
+TEST(BaoJsonArena, OtherTasksAllocateFromTheHeap)
+{
+    static uint8_t buffer[512];
+    BaoJsonArena arena{buffer};
+    size_t used = arena.Used();
+
+    // json of another task outlives the arena, so it must not come from its buffer
+    std::optional<BaoJson> other;
+    std::thread([&other] { other.emplace(KV{"other", "task"}); }).join();
+
+    EXPECT_EQ(arena.Used(), used);
+    EXPECT_FALSE(isIn(other->data(), buffer, sizeof(buffer)));
+}
+
+TEST(BaoJsonArena, HeapJsonOfAnotherTaskIsFreedSafelyAfterTheArena)
+{
+    static uint8_t buffer[512];
+    std::atomic<bool> arenaGone{false};
+    std::atomic<bool> created{false};
+
+    std::thread other([&] {
+        BaoJson json{KV{"created", "while the arena is alive"}};
+        created = true;
+        while (!arenaGone)
+        {
+            std::this_thread::yield();
+        }
+        // freed through the same hooks it was allocated with
+    });
+
+    {
+        BaoJsonArena arena{buffer};
+        while (!created)
+        {
+            std::this_thread::yield();
+        }
+        BaoJson json{KV{"in", "arena"}};
+    }
+    arenaGone = true;
+    other.join();
+}
+
+TEST(BaoJsonArena, ArenasOfDifferentTasksTakeTurns)
+{
+    static constexpr int TASKS = 4;
+    static constexpr int CYCLES = 2000;
+
+    std::atomic<int> active{0};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> corrupted{0};
+
+    std::vector<std::thread> tasks;
+    for (int t = 0; t < TASKS; t++)
+    {
+        tasks.emplace_back([&, t] {
+            uint8_t buffer[512];
+            for (int i = 0; i < CYCLES; i++)
+            {
+                BaoJsonArena arena{buffer};
+                if (active.fetch_add(1) != 0)
+                {
+                    overlaps++;
+                }
+
+                BaoJson json{KV{"task", t}, KV{"cycle", i}};
+                auto printed = json.PrintRaw();
+                std::string expected = "{\"task\":" + std::to_string(t) + ",\"cycle\":" + std::to_string(i) + "}";
+                if (expected != printed.get() || !isIn(printed.get(), buffer, sizeof(buffer)))
+                {
+                    corrupted++;
+                }
+
+                active--;
+            }
+        });
+    }
+
+    for (std::thread &task : tasks)
+    {
+        task.join();
+    }
+
+    EXPECT_EQ(overlaps, 0);
+    EXPECT_EQ(corrupted, 0);
+}
+
+TEST(BaoJsonArenaDeathTest, ArenasDoNotNestOnTheSameTask)
+{
+    static uint8_t outerBuffer[256];
+    static uint8_t innerBuffer[256];
+
+    EXPECT_DEATH(
+        {
+            BaoJsonArena outer{outerBuffer};
+            BaoJsonArena inner{innerBuffer};
+        },
+        "assert failed");
+}
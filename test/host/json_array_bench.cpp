@@ -0,0 +1,54 @@
+// time-series arrays of 10, 100 and 1000 samples - building them one value at a time against AppendNumbers,
+// and draining them from the back with the old cJSON_GetArraySize + cJSON_DetachItemFromArray against ArrayPopBack
+
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+
+using namespace Baozi;
+
+int main()
+{
+    BaoJsonBench bench;
+
+    for (int size : {10, 100, 1000})
+    {
+        std::vector<float> samples(size);
+        for (int i = 0; i < size; i++)
+            samples[i] = 20.0f + i * 0.25f;
+
+        uint32_t iterations = 100000 / size;
+        std::string suffix = "_" + std::to_string(size);
+
+        bench.Run(("append_one_by_one" + suffix).c_str(), iterations, [&] {
+            BaoJson array = BaoJson::CreateArray();
+            array.AddValsToArray(samples.begin(), samples.end());
+        });
+
+        bench.Run(("append_numbers" + suffix).c_str(), iterations, [&] {
+            BaoJson array = BaoJson::CreateArray();
+            array.AppendNumbers(std::span<const float>{samples});
+        });
+
+        bench.Run(("drain_cjson_size_detach" + suffix).c_str(), iterations, [&] {
+            BaoJson array = BaoJson::CreateArray();
+            array.AppendNumbers(std::span<const float>{samples});
+            cJSON *raw = array.data();
+            while (int count = cJSON_GetArraySize(raw))
+                cJSON_Delete(cJSON_DetachItemFromArray(raw, count - 1));
+        });
+
+        bench.Run(("drain_pop_back" + suffix).c_str(), iterations, [&] {
+            BaoJson array = BaoJson::CreateArray();
+            array.AppendNumbers(std::span<const float>{samples});
+            while (array.ArraySize() > 0)
+                array.ArrayPopBack();
+        });
+    }
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
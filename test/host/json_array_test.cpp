@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <span>
+#include <vector>
+#include "baozi_json.h"
+#include "cjson_allocations.h"
+
+using namespace Baozi;
+
+namespace
+{
+    std::vector<int> values(const BaoJson &array)
+    {
+        std::vector<int> result;
+        array.ArrayForEach<int>([&](int value) { result.push_back(value); });
+        return result;
+    }
+} // namespace
+
+TEST(BaoJsonArray, PopsFromBothEnds)
+{
+    BaoJson array = BaoJson::CreateArray();
+    array.AddValsToArray(1, 2, 3, 4);
+
+    EXPECT_EQ(array.ArrayPopFront()->GetVal<int>(), 1);
+    EXPECT_EQ(array.ArrayPopBack()->GetVal<int>(), 4);
+    EXPECT_EQ(array.ArraySize(), 2);
+    EXPECT_EQ(values(array), (std::vector<int>{2, 3}));
+
+    EXPECT_EQ(array.ArrayPopBack()->GetVal<int>(), 3);
+    EXPECT_EQ(array.ArrayPopBack()->GetVal<int>(), 2);
+    EXPECT_FALSE(array.ArrayPopBack().has_value());
+    EXPECT_FALSE(array.ArrayPopFront().has_value());
+    EXPECT_EQ(array.ArraySize(), 0);
+
+    // the tail is still right after emptying the array
+    array.AddValsToArray(5, 6);
+    EXPECT_EQ(array.ArrayPopBack()->GetVal<int>(), 6);
+    EXPECT_EQ(values(array), (std::vector<int>{5}));
+}
+
+TEST(BaoJsonArray, SizeFollowsEveryChange)
+{
+    BaoJson array = BaoJson::CreateArray();
+    EXPECT_EQ(array.ArraySize(), 0);
+
+    array.AddValToArray(1);
+    array.AddValToArray(BaoJson{KV{"a", 1}});
+    const float samples[] = {1.5f, 2.5f, 3.5f};
+    array.AppendNumbers(std::span<const float>{samples});
+    EXPECT_EQ(array.ArraySize(), 5);
+
+    array.ArrayPopFront();
+    EXPECT_EQ(array.ArraySize(), 4);
+
+    // a change behind BaoJson's back through data() drops the cached size
+    cJSON_AddItemToArray(array.data(), cJSON_CreateNumber(9));
+    EXPECT_EQ(array.ArraySize(), 5);
+    EXPECT_EQ(array.ArraySize(), cJSON_GetArraySize(array.data()));
+}
+
+TEST(BaoJsonArray, AppendNumbersLinksTheWholeChain)
+{
+    BaoJson array = BaoJson::CreateArray();
+    array.AddValToArray(0);
+
+    const int samples[] = {1, 2, 3, 4};
+    {
+        CJsonAllocations allocations;
+        array.AppendNumbers(std::span<const int>{samples});
+        EXPECT_EQ(allocations.Count(), 4u); // the nodes, nothing else
+    }
+
+    EXPECT_EQ(values(array), (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(array.data()->child->prev->valueint, 4); // cJSON's tail pointer
+    EXPECT_STREQ(array.PrintRaw().get(), "[0,1,2,3,4]");
+
+    array.AppendNumbers(std::span<const int>{});
+    EXPECT_EQ(array.ArraySize(), 5);
+}
+
+TEST(BaoJsonArray, AppendNumbersToAnEmptyArray)
+{
+    BaoJson array = BaoJson::CreateArray();
+    const double samples[] = {0.25, 0.5};
+    array.AppendNumbers(std::span<const double>{samples});
+
+    EXPECT_STREQ(array.PrintRaw().get(), "[0.25,0.5]");
+    EXPECT_EQ(array.ArrayPopBack()->GetVal<double>(), 0.5);
+    EXPECT_EQ(array.ArrayPopFront()->GetVal<double>(), 0.25);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+
+using namespace Baozi;
+
+TEST(BaoJsonBench, CallsTheOpForWarmUpTimingAndCounting)
+{
+    BaoJsonBench bench;
+    int calls = 0;
+    bench.Run("count", 10, [&] { calls++; });
+
+    EXPECT_EQ(calls, 1 + 10 + 10);
+}
+
+TEST(BaoJsonBench, CountsCJsonAllocationsPerOp)
+{
+    BaoJsonBench bench;
+
+    // the object, the number node and its copied key
+    auto copied = bench.Run("copied_key", 100, [] { BaoJson json{KV{"a", 1}}; });
+    EXPECT_FLOAT_EQ(copied.allocsPerOp, 3.0f);
+
+    auto none = bench.Run("no_json", 100, [] {});
+    EXPECT_FLOAT_EQ(none.allocsPerOp, 0.0f);
+    EXPECT_EQ(none.peakHeapBytes, 0u);
+}
+
+TEST(BaoJsonBench, MeasuresThePeakOfLiveAllocations)
+{
+    BaoJsonBench bench;
+    const std::string value(1000, 'x');
+
+    auto one = bench.Run("one_alive", 10, [&] { BaoJson json{value.c_str()}; });
+    auto three = bench.Run("three_alive", 10, [&] {
+        BaoJson a{value.c_str()};
+        BaoJson b{value.c_str()};
+        BaoJson c{value.c_str()};
+    });
+
+    EXPECT_GE(one.peakHeapBytes, 1001u);
+    EXPECT_LT(one.peakHeapBytes, 2002u);
+    EXPECT_GE(three.peakHeapBytes, 3 * 1001u);
+}
+
+TEST(BaoJsonBench, IgnoresFreesOfJsonMadeBeforeTheRun)
+{
+    std::vector<BaoJson> made;
+    for (int i = 0; i < 21; i++)
+        made.emplace_back(KV{"i", i});
+
+    BaoJsonBench bench;
+    auto &result = bench.Run("free_older", 10, [&] { made.pop_back(); });
+
+    EXPECT_FLOAT_EQ(result.allocsPerOp, 0.0f);
+    EXPECT_EQ(result.peakHeapBytes, 0u);
+}
+
+TEST(BaoJsonBench, ReportsEveryRunAsJson)
+{
+    BaoJsonBench bench;
+    bench.Run("first", 5, [] {});
+    bench.Run("second", 7, [] { BaoJson json{KV{"a", 1}}; });
+
+    auto report = BaoJson::Parse(bench.Report().PrintRaw().get());
+    ASSERT_TRUE(report.has_value());
+
+    std::vector<std::string> names;
+    std::vector<int> iterations;
+    report->GetVal<BaoJsonConstRef>("results")->ArrayForEach<BaoJsonConstRef>([&](BaoJsonConstRef result) {
+        names.emplace_back(result.GetVal<const char *>("name").value_or(""));
+        iterations.push_back(result.GetVal<int>("iterations").value_or(0));
+        EXPECT_TRUE(result.HasAllItems("nsPerOp", "allocsPerOp", "peakHeapBytes"));
+    });
+
+    EXPECT_EQ(names, (std::vector<std::string>{"first", "second"}));
+    EXPECT_EQ(iterations, (std::vector<int>{5, 7}));
+}
@@ -0,0 +1,74 @@
+// decoding a light command - the GetVal chain on a cJSON tree (what handlers did), the same chain on a BaoJsonView,
+// and the single pass BAOZI_JSON_FIELDS decoder; and encoding it with ToJson() against BaoJsonWriter::AddFields
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include "baozi_json_bench.h"
+#include "baozi_json_fields.h"
+
+using namespace Baozi;
+
+namespace
+{
+    struct LightCommand
+    {
+        bool state;
+        int brightness;
+        std::optional<std::string> effect;
+        double transition;
+
+        BAOZI_JSON_FIELDS(LightCommand, state, brightness, effect, transition)
+    };
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+    const std::string text = R"({"state":true,"brightness":80,"effect":"rainbow","transition":2.5,"flash":null})";
+
+    BaoJsonBench bench;
+    volatile int sink = 0;
+
+    bench.Run("decode_cjson_getval_chain", ITERATIONS, [&] {
+        auto json = BaoJson::Parse(text.data(), text.size());
+        LightCommand command{.state = json->GetVal<bool>("state").value_or(false),
+                             .brightness = json->GetVal<int>("brightness").value_or(0),
+                             .effect = json->GetVal<std::string>("effect"),
+                             .transition = json->GetVal<double>("transition").value_or(0)};
+        sink = command.brightness;
+    });
+
+    bench.Run("decode_view_getval_chain", ITERATIONS, [&] {
+        std::array<BaoJsonToken, 16> tokens;
+        auto json = BaoJsonView::Parse(text, tokens);
+        LightCommand command{.state = json->GetVal<bool>("state").value_or(false),
+                             .brightness = json->GetVal<int>("brightness").value_or(0),
+                             .effect = json->GetVal<std::string>("effect"),
+                             .transition = json->GetVal<double>("transition").value_or(0)};
+        sink = command.brightness;
+    });
+
+    bench.Run("decode_fields", ITERATIONS, [&] {
+        std::array<BaoJsonToken, 16> tokens;
+        auto json = BaoJsonView::Parse(text, tokens);
+        auto command = LightCommand::FromJson(json.value());
+        sink = command.value().brightness;
+    });
+
+    const LightCommand command{.state = true, .brightness = 80, .effect = "rainbow", .transition = 2.5};
+
+    bench.Run("encode_to_json_print", ITERATIONS, [&] {
+        auto printed = command.ToJson().PrintRaw();
+    });
+
+    bench.Run("encode_writer_add_fields", ITERATIONS, [&] {
+        char buffer[128];
+        BaoJsonWriter writer{buffer};
+        writer.AddFields(command);
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <optional>
+#include <string>
+#include "baozi_json_fields.h"
+
+using namespace Baozi;
+
+namespace
+{
+    struct Color
+    {
+        int r;
+        int g;
+        int b;
+
+        BAOZI_JSON_FIELDS(Color, r, g, b)
+    };
+
+    struct LightCommand
+    {
+        bool state;
+        int brightness;
+        std::optional<std::string> effect;
+        Color color;
+        double transition;
+
+        BAOZI_JSON_FIELDS(LightCommand, state, brightness, effect, color, transition)
+    };
+
+    BaoResult<LightCommand> decode(std::string_view text)
+    {
+        std::array<BaoJsonToken, 32> tokens;
+        auto json = BaoJsonView::Parse(text, tokens);
+        EXPECT_TRUE(json.has_value()) << text;
+        return LightCommand::FromJson(json.value_or(BaoJsonView{}));
+    }
+} // namespace
+
+TEST(BaoJsonFields, RoundTripsThroughTheWriter)
+{
+    LightCommand command{.state = true, .brightness = 80, .effect = "rainbow", .color = Color{255, 120, 0}, .transition = 2.5};
+
+    char buffer[160];
+    BaoJsonWriter writer{buffer};
+    writer.AddFields(command);
+    ASSERT_TRUE(writer);
+    EXPECT_STREQ(writer.c_str(), R"({"state":true,"brightness":80,"effect":"rainbow","color":{"r":255,"g":120,"b":0},"transition":2.5})");
+
+    auto decoded = decode(writer.c_str());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().state, true);
+    EXPECT_EQ(decoded.value().brightness, 80);
+    EXPECT_EQ(decoded.value().effect, "rainbow");
+    EXPECT_EQ(decoded.value().color.g, 120);
+    EXPECT_EQ(decoded.value().transition, 2.5);
+}
+
+TEST(BaoJsonFields, ToJsonMatchesTheWriter)
+{
+    LightCommand command{.state = false, .brightness = 0, .effect = std::nullopt, .color = Color{}, .transition = 0};
+
+    char buffer[160];
+    BaoJsonWriter writer{buffer};
+    writer.AddFields(command);
+
+    EXPECT_STREQ(command.ToJson().PrintRaw().get(), writer.c_str());
+    EXPECT_STREQ(writer.c_str(), R"({"state":false,"brightness":0,"effect":null,"color":{"r":0,"g":0,"b":0},"transition":0})");
+}
+
+TEST(BaoJsonFields, SkipsUnknownKeysAndAcceptsMissingOptionals)
+{
+    auto decoded = decode(R"({"extra":{"deep":[1,2,{"x":3}]},"brightness":10,"state":false,"transition":1,)"
+                          R"("color":{"b":3,"alpha":1,"g":2,"r":1}})");
+
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded.value().brightness, 10);
+    EXPECT_FALSE(decoded.value().effect.has_value());
+    EXPECT_EQ(decoded.value().color.r, 1);
+    EXPECT_EQ(decoded.value().color.b, 3);
+
+    EXPECT_TRUE(decode(R"({"state":true,"brightness":1,"transition":1,"effect":null,"color":{"r":0,"g":0,"b":0}})").has_value());
+}
+
+TEST(BaoJsonFields, ReportsMissingAndMistypedFields)
+{
+    EXPECT_EQ(decode(R"({"state":true,"transition":1,"color":{"r":0,"g":0,"b":0}})"), eResult::NOT_FOUND);
+    EXPECT_EQ(decode(R"({"state":"yes","brightness":1,"transition":1,"color":{"r":0,"g":0,"b":0}})"), eResult::INVALID_PARAMETER);
+    EXPECT_EQ(decode(R"({"state":true,"brightness":1,"transition":1,"color":{"r":1}})"), eResult::INVALID_PARAMETER); // nested struct does not decode
+    EXPECT_EQ(decode(R"([1,2])"), eResult::INVALID_PARAMETER);
+}
@@ -0,0 +1,57 @@
+// FormatJsonNumber against the %1.15g / %1.17g sprintf search cJSON uses
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_format.h"
+
+using namespace Baozi;
+
+namespace
+{
+    size_t formatLikeCJson(double val, char *out)
+    {
+        int length = snprintf(out, JSON_NUMBER_BUFFER_SIZE, "%1.15g", val);
+        if (strtod(out, nullptr) != val)
+            length = snprintf(out, JSON_NUMBER_BUFFER_SIZE, "%1.17g", val);
+        return length;
+    }
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 1000;
+
+    // sensor like readings with two decimals
+    std::mt19937 random{1234};
+    std::vector<double> readings(1000);
+    for (double &reading : readings)
+        reading = static_cast<int>(std::uniform_real_distribution<double>(-4000, 4000)(random)) / 100.0;
+
+    BaoJsonBench bench;
+    volatile size_t sink = 0;
+
+    bench.Run("format_1000_sprintf", ITERATIONS, [&] {
+        char out[JSON_NUMBER_BUFFER_SIZE];
+        for (double reading : readings)
+            sink = sink + formatLikeCJson(reading, out);
+    });
+
+    bench.Run("format_1000_shortest", ITERATIONS, [&] {
+        char out[JSON_NUMBER_BUFFER_SIZE];
+        for (double reading : readings)
+            sink = sink + FormatJsonNumber(reading, out);
+    });
+
+    bench.Run("format_1000_float_shortest", ITERATIONS, [&] {
+        char out[JSON_NUMBER_BUFFER_SIZE];
+        for (double reading : readings)
+            sink = sink + FormatJsonNumber(static_cast<float>(reading), out);
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include "baozi_json_format.h"
+
+using namespace Baozi;
+
+namespace
+{
+    template <typename T>
+    std::string format(T val)
+    {
+        char out[JSON_NUMBER_BUFFER_SIZE + 1];
+        size_t length = FormatJsonNumber(val, out);
+        EXPECT_LE(length, JSON_NUMBER_BUFFER_SIZE);
+        return std::string(out, length);
+    }
+
+    std::string formatFixed(double val, uint8_t decimals)
+    {
+        char out[JSON_NUMBER_BUFFER_SIZE + 1];
+        return std::string(out, FormatJsonFixed(val, decimals, out));
+    }
+
+    // significant digits of a formatted number, leading and trailing zeros do not count
+    size_t significantDigits(const std::string &number)
+    {
+        std::string digits;
+        for (char c : number)
+        {
+            if (c == 'e' || c == 'E')
+                break;
+            if (c >= '0' && c <= '9')
+                digits += c;
+        }
+
+        digits.erase(0, digits.find_first_not_of('0'));
+        digits.erase(digits.find_last_not_of('0') + 1);
+        return digits.empty() ? 1 : digits.size();
+    }
+
+    // whole numbers below 2^53 are written with all their digits, like cJSON writes them
+    template <typename T>
+    bool isWrittenAsInteger(T val)
+    {
+        return std::fabs(val) < 9007199254740992.0 && val == std::trunc(val);
+    }
+
+    // the fewest %g digits that read back to val, the shortest round trip reference
+    template <typename T>
+    size_t shortestDigits(T val)
+    {
+        char out[64];
+        for (int precision = 1;; precision++)
+        {
+            snprintf(out, sizeof(out), "%.*g", precision, static_cast<double>(val));
+            T parsed = std::is_same_v<T, float> ? strtof(out, nullptr) : strtod(out, nullptr);
+            if (parsed == val)
+                return precision;
+        }
+    }
+} // namespace
+
+TEST(JsonFormat, WritesShortRoundTripForms)
+{
+    EXPECT_EQ(format(21.5), "21.5");
+    EXPECT_EQ(format(0.1), "0.1");
+    EXPECT_EQ(format(-3.0), "-3");
+    EXPECT_EQ(format(0.0), "0");
+    EXPECT_EQ(format(21.3f), "21.3");
+    EXPECT_EQ(format(0.1f), "0.1");
+}
+
+TEST(JsonFormat, WritesNanAndInfAsNull)
+{
+    EXPECT_EQ(format(std::numeric_limits<double>::quiet_NaN()), "null");
+    EXPECT_EQ(format(std::numeric_limits<double>::infinity()), "null");
+    EXPECT_EQ(format(-std::numeric_limits<float>::infinity()), "null");
+}
+
+TEST(JsonFormat, RandomDoublesRoundTripWithTheFewestDigits)
+{
+    std::mt19937_64 random{1234};
+    for (int i = 0; i < 200000; i++)
+    {
+        double val;
+        if (i % 2 == 0)
+        {
+            // any bit pattern, most of them far outside the fast path
+            uint64_t bits = random();
+            memcpy(&val, &bits, sizeof(val));
+            if (!std::isfinite(val))
+                continue;
+        }
+        else
+        {
+            // sensor like values, mostly on the fast path
+            val = std::round(std::uniform_real_distribution<double>(-1000, 1000)(random) * 100) / 100;
+        }
+
+        std::string out = format(val);
+        ASSERT_EQ(strtod(out.c_str(), nullptr), val) << out;
+        if (!isWrittenAsInteger(val))
+        {
+            ASSERT_EQ(significantDigits(out), shortestDigits(val)) << out;
+        }
+    }
+}
+
+TEST(JsonFormat, RandomFloatsRoundTripWithTheFewestDigits)
+{
+    std::mt19937 random{1234};
+    for (int i = 0; i < 200000; i++)
+    {
+        float val;
+        uint32_t bits = random();
+        memcpy(&val, &bits, sizeof(val));
+        if (!std::isfinite(val))
+            continue;
+
+        std::string out = format(val);
+        ASSERT_EQ(strtof(out.c_str(), nullptr), val) << out;
+        if (!isWrittenAsInteger(val))
+        {
+            ASSERT_EQ(significantDigits(out), shortestDigits(val)) << out;
+        }
+    }
+}
+
+TEST(JsonFormat, FallbackStillWritesTheFewestDigits)
+{
+    // the smallest subnormal is outside of the exact powers of ten, %1.15g would write 4.94065645841247e-324
+    EXPECT_EQ(format(5e-324), "5e-324");
+    EXPECT_EQ(format(1e300), "1e+300");
+    EXPECT_EQ(format(0.30000000000000004), "0.30000000000000004");
+}
+
+TEST(JsonFormat, WritesIntegerLimits)
+{
+    char out[JSON_NUMBER_BUFFER_SIZE];
+
+    EXPECT_EQ(std::string(out, FormatJsonInteger(std::numeric_limits<long long>::min(), out)), "-9223372036854775808");
+    EXPECT_EQ(std::string(out, FormatJsonUnsigned(std::numeric_limits<unsigned long long>::max(), out)), "18446744073709551615");
+    EXPECT_EQ(std::string(out, FormatJsonInteger(0, out)), "0");
+}
+
+TEST(JsonFormat, FixedRoundsAndDropsTrailingZeros)
+{
+    EXPECT_EQ(formatFixed(21.46, 1), "21.5");
+    EXPECT_EQ(formatFixed(21.50, 2), "21.5");
+    EXPECT_EQ(formatFixed(21.0, 3), "21");
+    EXPECT_EQ(formatFixed(-0.04, 1), "0");
+    EXPECT_EQ(formatFixed(1234.5678, 0), "1235");
+}
+
+TEST(JsonFormat, FloatToShortestDoubleIsTheShortFormAsDouble)
+{
+    EXPECT_EQ(FloatToShortestDouble(21.3f), 21.3);
+    EXPECT_EQ(FloatToShortestDouble(0.1f), 0.1);
+    EXPECT_EQ(static_cast<float>(FloatToShortestDouble(1.17549435e-38f)), 1.17549435e-38f);
+}
@@ -0,0 +1,49 @@
+// key lookups in objects of 4 to 256 keys, walking the siblings (cJSON_GetObjectItem) against BaoJsonIndex,
+// to find the object size from which building the index pays off
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t LOOKUPS = 200000;
+
+    BaoJsonBench bench;
+    volatile int sink = 0;
+
+    for (int size : {4, 8, 16, 32, 64, 128, 256})
+    {
+        BaoJson json;
+        std::vector<std::string> keys;
+        for (int i = 0; i < size; i++)
+        {
+            keys.push_back("config_key_" + std::to_string(i));
+            json.AddVal(keys.back().c_str(), i);
+        }
+
+        // every key in turn, so the average walk is half the object
+        size_t next = 0;
+        auto lookup = [&] {
+            sink = json.GetVal<int>(keys[next].c_str()).value_or(0);
+            next = next + 1 == keys.size() ? 0 : next + 1;
+        };
+
+        std::string walkName = "walk_" + std::to_string(size);
+        bench.Run(walkName.c_str(), LOOKUPS, lookup);
+
+        json.BuildIndex();
+        std::string indexName = "index_" + std::to_string(size);
+        bench.Run(indexName.c_str(), LOOKUPS, lookup);
+
+        std::string buildName = "build_index_" + std::to_string(size);
+        bench.Run(buildName.c_str(), 10000, [&] { BaoJsonIndex index{json.data()}; });
+    }
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
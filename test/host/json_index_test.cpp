@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_index.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson makeObject(int keys)
+    {
+        BaoJson json;
+        for (int i = 0; i < keys; i++)
+            json.AddVal(("key_" + std::to_string(i)).c_str(), i);
+        return json;
+    }
+} // namespace
+
+TEST(BaoJsonIndex, FindsEveryKey)
+{
+    BaoJson json = makeObject(100);
+    BaoJsonIndex index{json.data()};
+
+    EXPECT_EQ(index.Size(), 100u);
+    for (int i = 0; i < 100; i++)
+    {
+        const cJSON *item = index.Find(("key_" + std::to_string(i)).c_str());
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(item->valueint, i);
+    }
+    EXPECT_EQ(index.Find("key_100"), nullptr);
+}
+
+TEST(BaoJsonIndex, IsCaseSensitiveAndKeepsTheFirstDuplicate)
+{
+    BaoJson json;
+    json.AddVal("State", 1);
+    json.AddVal("state", 2);
+    json.AddVal("state", 3);
+    BaoJsonIndex index{json.data()};
+
+    EXPECT_EQ(index.Find("State")->valueint, 1);
+    EXPECT_EQ(index.Find("state")->valueint, 2);
+    EXPECT_EQ(index.Find("STATE"), nullptr);
+}
+
+TEST(BaoJsonIndex, IndexedLookupsMatchTheWalk)
+{
+    BaoJson json = makeObject(32);
+    json.BuildIndex();
+    ASSERT_TRUE(json.IsIndexed());
+
+    EXPECT_EQ(json.GetVal<int>("key_31"), 31);
+    EXPECT_TRUE(json.HasItem("key_0"));
+    EXPECT_TRUE(json.HasAllItems("key_1", "key_2"));
+    EXPECT_TRUE(json.HasEitherItems("nope", "key_3"));
+    EXPECT_FALSE(json.HasItem("nope"));
+    EXPECT_TRUE(json.IsIndexed()); // const reads keep the index
+}
+
+TEST(BaoJsonIndex, MutationsDropTheIndex)
+{
+    BaoJson json = makeObject(16);
+
+    json.BuildIndex();
+    json.AddVal("added", 1);
+    EXPECT_FALSE(json.IsIndexed());
+    EXPECT_EQ(json.GetVal<int>("added"), 1);
+
+    json.BuildIndex();
+    (void)json.Ref();
+    EXPECT_FALSE(json.IsIndexed());
+
+    json.BuildIndex();
+    (void)json.data();
+    EXPECT_FALSE(json.IsIndexed());
+}
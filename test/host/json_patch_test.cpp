@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include "baozi_json.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson parse(const char *text)
+    {
+        auto json = BaoJson::Parse(text);
+        EXPECT_TRUE(json.has_value()) << text;
+        return json.has_value() ? std::move(json.value()) : BaoJson{};
+    }
+
+    std::string print(const BaoJson &json)
+    {
+        return json.PrintRaw().get();
+    }
+
+    std::string applied(const char *target, const char *patch)
+    {
+        BaoJson json = parse(target);
+        EXPECT_EQ(json.ApplyMergePatch(parse(patch)), eResult::SUCCESS);
+        return print(json);
+    }
+
+    // cJSON allocations fail once `s_budget` of them succeeded, while installed. Every allocation is counted
+    // so the tests can check nothing leaks on the failure paths
+    int s_budget = -1;
+    int s_live = 0;
+
+    void *failingMalloc(size_t size)
+    {
+        if (s_budget == 0)
+            return nullptr;
+        if (s_budget > 0)
+            s_budget--;
+
+        s_live++;
+        return malloc(size);
+    }
+
+    void countingFree(void *ptr)
+    {
+        if (ptr != nullptr)
+            s_live--;
+        free(ptr);
+    }
+
+    // swaps the cJSON hooks of this test binary, which never uses BaoJsonHooks (arenas, benches)
+    class FailingAllocations
+    {
+    public:
+        explicit FailingAllocations(int budget)
+        {
+            s_budget = budget;
+            cJSON_Hooks hooks{.malloc_fn = failingMalloc, .free_fn = countingFree};
+            cJSON_InitHooks(&hooks);
+        }
+
+        ~FailingAllocations()
+        {
+            s_budget = -1;
+        }
+    };
+} // namespace
+
+// the examples of RFC 7386 appendix A, on objects
+TEST(BaoJsonMergePatch, AppliesTheRfcExamples)
+{
+    EXPECT_EQ(applied(R"({"a":"b"})", R"({"a":"c"})"), R"({"a":"c"})");
+    EXPECT_EQ(applied(R"({"a":"b"})", R"({"b":"c"})"), R"({"a":"b","b":"c"})");
+    EXPECT_EQ(applied(R"({"a":"b"})", R"({"a":null})"), R"({})");
+    EXPECT_EQ(applied(R"({"a":"b","b":"c"})", R"({"a":null})"), R"({"b":"c"})");
+    EXPECT_EQ(applied(R"({"a":["b"]})", R"({"a":"c"})"), R"({"a":"c"})");
+    EXPECT_EQ(applied(R"({"a":"c"})", R"({"a":["b"]})"), R"({"a":["b"]})");
+    EXPECT_EQ(applied(R"({"a":{"b":"c"}})", R"({"a":{"b":"d","c":null}})"), R"({"a":{"b":"d"}})");
+    EXPECT_EQ(applied(R"({"a":[{"b":"c"}]})", R"({"a":[1]})"), R"({"a":[1]})");
+    EXPECT_EQ(applied(R"({"e":null})", R"({"a":1})"), R"({"e":null,"a":1})");
+    EXPECT_EQ(applied(R"([1,2])", R"({"a":"b","c":null})"), R"({"a":"b"})");
+    EXPECT_EQ(applied(R"({})", R"({"a":{"bb":{"ccc":null}}})"), R"({"a":{"bb":{}}})");
+    EXPECT_EQ(applied(R"({"a":"foo"})", R"("bar")"), R"("bar")");
+}
+
+TEST(BaoJsonMergePatch, CreatesTheSmallestPatch)
+{
+    BaoJson from = parse(R"({"a":1,"b":{"c":2,"d":3},"keep":[1,2]})");
+    BaoJson to = parse(R"({"a":1,"b":{"c":5},"keep":[1,2],"e":[1]})");
+
+    auto patch = BaoJson::CreateMergePatch(from, to);
+    ASSERT_TRUE(patch.has_value());
+    EXPECT_EQ(print(patch.value()), R"({"b":{"d":null,"c":5},"e":[1]})");
+
+    EXPECT_EQ(from.ApplyMergePatch(patch.value()), eResult::SUCCESS);
+    EXPECT_EQ(print(from), print(to));
+
+    auto same = BaoJson::CreateMergePatch(to, to);
+    ASSERT_TRUE(same.has_value());
+    EXPECT_TRUE(same->IsEmpty());
+}
+
+TEST(BaoJsonMergePatch, PatchedKeysKeepTheirPosition)
+{
+    EXPECT_EQ(applied(R"({"a":1,"b":2,"c":3})", R"({"b":20,"d":4})"), R"({"a":1,"b":20,"c":3,"d":4})");
+}
+
+TEST(BaoJsonMergePatch, ArraysAreReplacedAsAWhole)
+{
+    auto patch = BaoJson::CreateMergePatch(parse(R"({"a":[1,2,3]})"), parse(R"({"a":[1,2]})"));
+    ASSERT_TRUE(patch.has_value());
+    EXPECT_EQ(print(patch.value()), R"({"a":[1,2]})");
+}
+
+TEST(BaoJsonMergePatch, CreateReportsFailedAllocations)
+{
+    BaoJson from = parse(R"({"a":1,"b":{"c":2,"d":3},"gone":true})");
+    BaoJson to = parse(R"({"a":2,"b":{"c":5,"e":"new"},"f":[1,2]})");
+
+    for (int budget = 0;; budget++)
+    {
+        int live = s_live;
+        std::optional<BaoJson> patch;
+        {
+            FailingAllocations failing{budget};
+            patch = BaoJson::CreateMergePatch(from, to);
+        }
+
+        if (patch.has_value())
+        {
+            EXPECT_EQ(print(patch.value()), R"({"gone":null,"a":2,"b":{"d":null,"c":5,"e":"new"},"f":[1,2]})");
+            break;
+        }
+
+        EXPECT_EQ(s_live, live) << "leaked at budget " << budget;
+    }
+}
+
+TEST(BaoJsonMergePatch, ApplyReportsFailedAllocations)
+{
+    BaoJson patch = parse(R"({"a":2,"b":{"c":5,"e":"new"},"f":[1,2],"gone":null})");
+
+    for (int budget = 0;; budget++)
+    {
+        BaoJson target = parse(R"({"a":1,"b":{"c":2,"d":3},"gone":true})");
+        eResult result;
+        {
+            FailingAllocations failing{budget};
+            result = target.ApplyMergePatch(patch);
+        }
+
+        if (result == eResult::SUCCESS)
+        {
+            EXPECT_EQ(print(target), R"({"a":2,"b":{"c":5,"d":3,"e":"new"},"f":[1,2]})");
+            break;
+        }
+
+        EXPECT_EQ(result, eResult::OUT_OF_MEMORY);
+        EXPECT_TRUE(target) << "the target is partly patched, never lost";
+    }
+}
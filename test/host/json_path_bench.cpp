@@ -0,0 +1,57 @@
+// a 4 level deep read through chained GetVal<BaoJsonConstRef> against a compiled BaoJsonPath and a
+// BaoJsonCachedPath on the same BaoJson, and against a BaoJsonPath on a BaoJsonView of the same text
+
+#include <array>
+#include <cstdio>
+#include <string_view>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_path.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+    static constexpr std::string_view TEXT =
+        R"({"device":{"name":"hub","sw":"1.4.2"},"state":{"online":true,"battery":87},)"
+        R"("light":{"state":"ON","brightness":180,"effects":["rainbow","fire"],"color":{"mode":"rgb","rgb":{"r":255,"g":128,"b":0}}}})";
+    static constexpr auto GREEN = "/light/color/rgb/g"_path;
+
+    const BaoJson json = *BaoJson::Parse(TEXT.data());
+    std::array<BaoJsonToken, 64> tokens;
+    const BaoJsonView view = *BaoJsonView::Parse(TEXT, tokens);
+
+    BaoJsonBench bench;
+    volatile int sink = 0;
+
+    bench.Run("deep_chained_getval", ITERATIONS, [&] {
+        auto green = json.GetVal<BaoJsonConstRef>("light")
+                         ->GetVal<BaoJsonConstRef>("color")
+                         ->GetVal<BaoJsonConstRef>("rgb")
+                         ->GetVal<int>("g");
+        sink = sink + green.value_or(0);
+    });
+
+    bench.Run("deep_path", ITERATIONS, [&] { sink = sink + GREEN.GetVal<int>(json).value_or(0); });
+
+    BaoJsonCachedPath cached{GREEN};
+    bench.Run("deep_cached_path", ITERATIONS, [&] { sink = sink + cached.GetVal<int>(json).value_or(0); });
+
+    bench.Run("deep_view_chained_getval", ITERATIONS, [&] {
+        auto green = view.GetVal<BaoJsonView>("light")
+                         ->GetVal<BaoJsonView>("color")
+                         ->GetVal<BaoJsonView>("rgb")
+                         ->GetVal<int>("g");
+        sink = sink + green.value_or(0);
+    });
+
+    bench.Run("deep_view_path", ITERATIONS, [&] { sink = sink + GREEN.GetVal<int>(view).value_or(0); });
+
+    bench.Run("runtime_parse_path", ITERATIONS, [&] {
+        sink = sink + static_cast<int>(BaoJsonPath::Parse("/light/color/rgb/g")->Size());
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <string_view>
+#include "baozi_json_path.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr auto ESCAPED = "/a~1b/c~0d/12"_path;
+
+    static_assert(ESCAPED.Size() == 3);
+    static_assert(std::string_view{ESCAPED.Segment(0)} == "a/b");
+    static_assert(std::string_view{ESCAPED.Segment(1)} == "c~d");
+    static_assert(std::string_view{ESCAPED.Segment(2)} == "12");
+    static_assert(""_path.Size() == 0);
+    static_assert("/"_path.Size() == 1);
+
+    static_assert(!BaoJsonPath::Parse("no_slash").has_value());
+    static_assert(!BaoJsonPath::Parse("/bad~2escape").has_value());
+    static_assert(!BaoJsonPath::Parse("/ends_with~").has_value());
+    static_assert(!BaoJsonPath::Parse("/1/2/3/4/5/6/7/8/9").has_value());
+    static_assert(BaoJsonPath::Parse("/1/2/3/4/5/6/7/8").has_value());
+
+    constexpr std::string_view STATE =
+        R"({"light":{"color":{"r":255,"g":128}},"effects":["rainbow","fire",{"speed":3}],"a/b":{"c~d":1},"":0})";
+} // namespace
+
+TEST(BaoJsonPath, ParsesRuntimePointersLikeLiterals)
+{
+    auto path = BaoJsonPath::Parse("/a~1b/c~0d/12");
+    ASSERT_TRUE(path.has_value());
+    ASSERT_EQ(path->Size(), ESCAPED.Size());
+    for (size_t i = 0; i < ESCAPED.Size(); i++)
+        EXPECT_STREQ(path->Segment(i), ESCAPED.Segment(i));
+
+    std::string tooLong = "/" + std::string(BaoJsonPath::MAX_LENGTH, 'k');
+    EXPECT_FALSE(BaoJsonPath::Parse(tooLong).has_value());
+}
+
+TEST(BaoJsonPath, ReadsBaoJson)
+{
+    auto json = BaoJson::Parse(STATE.data());
+    ASSERT_TRUE(json.has_value());
+
+    EXPECT_EQ("/light/color/r"_path.GetVal<int>(*json), 255);
+    EXPECT_EQ("/light/color/g"_path.GetVal<int>(*json), 128);
+    EXPECT_STREQ("/effects/1"_path.GetVal<const char *>(*json).value_or(""), "fire");
+    EXPECT_EQ("/effects/2/speed"_path.GetVal<int>(*json), 3);
+    EXPECT_EQ("/a~1b/c~0d"_path.GetVal<int>(*json), 1);
+    EXPECT_EQ("/"_path.GetVal<int>(*json), 0);
+    EXPECT_EQ(""_path.Resolve(json->data()), json->data());
+}
+
+TEST(BaoJsonPath, MissesWrongKeysIndicesAndTypes)
+{
+    auto json = BaoJson::Parse(STATE.data());
+    ASSERT_TRUE(json.has_value());
+
+    EXPECT_FALSE("/light/color/b"_path.GetVal<int>(*json).has_value());
+    EXPECT_FALSE("/Light/color/r"_path.GetVal<int>(*json).has_value());
+    EXPECT_FALSE("/effects/3"_path.GetVal<const char *>(*json).has_value());
+    EXPECT_FALSE("/effects/01"_path.GetVal<const char *>(*json).has_value());
+    EXPECT_FALSE("/effects/-"_path.GetVal<const char *>(*json).has_value());
+    EXPECT_FALSE("/light/color/r/deeper"_path.GetVal<int>(*json).has_value());
+    EXPECT_FALSE("/light/color/r"_path.GetVal<const char *>(*json).has_value());
+}
+
+TEST(BaoJsonPath, ReadsBaoJsonViewLikeBaoJson)
+{
+    std::array<BaoJsonToken, 32> tokens;
+    auto view = BaoJsonView::Parse(STATE, tokens);
+    ASSERT_TRUE(view.has_value());
+
+    EXPECT_EQ("/light/color/r"_path.GetVal<int>(*view), 255);
+    EXPECT_EQ("/effects/1"_path.GetVal<std::string_view>(*view), "fire");
+    EXPECT_EQ("/effects/2/speed"_path.GetVal<int>(*view), 3);
+    EXPECT_EQ("/a~1b/c~0d"_path.GetVal<int>(*view), 1);
+    EXPECT_EQ("/"_path.GetVal<int>(*view), 0);
+
+    EXPECT_FALSE("/effects/3"_path.GetVal<std::string_view>(*view).has_value());
+    EXPECT_FALSE("/effects/01"_path.GetVal<std::string_view>(*view).has_value());
+    EXPECT_FALSE("/light/color/r/deeper"_path.GetVal<int>(*view).has_value());
+    EXPECT_FALSE("/light/missing"_path.Resolve(*view).has_value());
+}
+
+TEST(BaoJsonCachedPath, ReusesTheNodeUntilTheJsonChanges)
+{
+    BaoJson json{KV{"a", 1}};
+    BaoJsonCachedPath path{"/b"_path};
+
+    EXPECT_FALSE(path.GetVal<int>(json).has_value());
+    EXPECT_FALSE(path.GetVal<int>(json).has_value());
+
+    json.AddVal("b", 2);
+    EXPECT_EQ(path.GetVal<int>(json), 2);
+
+    // a different json with the same content resolves again
+    BaoJson other{KV{"b", 3}};
+    EXPECT_EQ(path.GetVal<int>(other), 3);
+
+    // a tree moved out and replaced at the same address is not mistaken for the cached one
+    json = BaoJson{KV{"b", 4}};
+    EXPECT_EQ(path.GetVal<int>(json), 4);
+}
+
+TEST(BaoJsonCachedPath, ReturnsTheCachedNodeForAnUnchangedJson)
+{
+    const BaoJson json = *BaoJson::Parse(STATE.data());
+    BaoJsonCachedPath path{"/effects/2/speed"_path};
+
+    const cJSON *node = path.Resolve(json);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(path.Resolve(json), node);
+    EXPECT_EQ(path.GetVal<int>(json), 3);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "baozi_json.h"
+#include "baozi_json_print_pool.h"
+#include "baozi_mqtt.h"
+#include "cjson_allocations.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson message(int size)
+    {
+        return BaoJson{KV{"payload", std::string(size, 'x')}};
+    }
+} // namespace
+
+TEST(BaoJsonPrintPool, NullJsonPrintsNothing)
+{
+    BaoJsonPrintPool pool;
+    auto printed = pool.Print(nullptr, "topic");
+
+    EXPECT_FALSE(printed);
+    EXPECT_EQ(printed.length(), 0u);
+}
+
+TEST(BaoJsonPrintPool, LearnsTheSizeThenPrintsIntoThePool)
+{
+    BaoJsonPrintPool pool;
+    BaoJson json = message(50);
+
+    auto first = pool.Print(json.data(), "a/topic");
+    ASSERT_TRUE(first);
+    EXPECT_STREQ(first.c_str(), json.PrintRaw().get());
+    EXPECT_EQ(pool.GetStats().misses, 1u);
+
+    for (int i = 0; i < 10; i++)
+    {
+        auto printed = pool.Print(json.data(), "a/topic");
+        EXPECT_STREQ(printed.c_str(), first.c_str());
+        EXPECT_EQ(printed.length(), first.length());
+    }
+
+    EXPECT_EQ(pool.GetStats().hits, 10u);
+    EXPECT_EQ(pool.GetStats().allocatedBytes, BaoJsonPrintPool::SIZE_CLASSES[0]); // one buffer, reused
+}
+
+TEST(BaoJsonPrintPool, FallsBackToTheHeap)
+{
+    BaoJsonPrintPool pool;
+    BaoJson small = message(50);
+    BaoJson huge = message(2000);
+
+    // bigger than the largest class
+    pool.Print(huge.data(), "huge");
+    auto printed = pool.Print(huge.data(), "huge");
+    EXPECT_STREQ(printed.c_str(), huge.PrintRaw().get());
+    EXPECT_EQ(pool.GetStats().misses, 2u);
+
+    // every buffer taken
+    pool.Print(small.data(), "small");
+    std::vector<BaoJsonPrintPool::Printed> held;
+    for (size_t i = 0; i < BaoJsonPrintPool::SIZE_CLASSES.size() * BaoJsonPrintPool::BUFFERS_PER_CLASS; i++)
+        held.push_back(pool.Print(small.data(), "small"));
+
+    uint32_t misses = pool.GetStats().misses;
+    auto exhausted = pool.Print(small.data(), "small");
+    EXPECT_STREQ(exhausted.c_str(), small.PrintRaw().get());
+    EXPECT_EQ(pool.GetStats().misses, misses + 1);
+
+    // and buffers are handed back when released
+    held.clear();
+    pool.Print(small.data(), "small");
+    EXPECT_EQ(pool.GetStats().misses, misses + 1);
+}
+
+TEST(BaoJsonPrintPool, GrownMessagesAreLearnt)
+{
+    BaoJsonPrintPool pool;
+    BaoJson small = message(20);
+    BaoJson grown = message(400);
+
+    pool.Print(small.data(), "topic");
+    auto printed = pool.Print(grown.data(), "topic"); // predicted too small, printed on the heap
+    EXPECT_STREQ(printed.c_str(), grown.PrintRaw().get());
+
+    uint32_t hits = pool.GetStats().hits;
+    pool.Print(grown.data(), "topic");
+    EXPECT_EQ(pool.GetStats().hits, hits + 1);
+}
+
+TEST(BaoJsonPrintPool, IsThreadSafe)
+{
+    BaoJsonPrintPool pool;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&pool, t] {
+            BaoJson json = message(30 + t * 100);
+            std::string expected = json.PrintRaw().get();
+            std::string topic = "topic/" + std::to_string(t);
+            for (int i = 0; i < 2000; i++)
+            {
+                auto printed = pool.Print(json.data(), topic.c_str());
+                ASSERT_EQ(expected, printed.c_str());
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(pool.GetStats().hits + pool.GetStats().misses, 8000u);
+}
+
+TEST(BaoJsonPrintPool, PublishingAnEmptyJsonFails)
+{
+    HostMqtt::Reset();
+    MqttClient client;
+    client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"});
+    esp_mqtt_client_handle_t broker = HostMqtt::LastClient();
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+
+    BaoJson json{KV{"a", 1}};
+    BaoJson moved = std::move(json);
+
+    EXPECT_NE(client.Publish("topic", json), eResult::SUCCESS);
+    EXPECT_EQ(client.Publish("topic", moved), eResult::SUCCESS);
+    EXPECT_EQ(HostMqtt::Published(broker).size(), 1u);
+}
+
+TEST(BaoJsonPrintPool, SteadyPublishesDoNotAllocate)
+{
+    HostMqtt::Reset();
+    MqttClient client;
+    client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"});
+    esp_mqtt_client_handle_t broker = HostMqtt::LastClient();
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+
+    BaoJson state{KV{"temperature", 21.5}, KV{"humidity", 40}};
+    BaoJson discovery = message(600);
+
+    // warm up - learn both sizes, then allocate their buffers
+    for (int i = 0; i < 2; i++)
+    {
+        client.Publish("sensor/state", state);
+        client.Publish("sensor/config", discovery);
+    }
+    auto warm = client.GetPrintStats();
+
+    CJsonAllocations allocations;
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(client.Publish("sensor/state", state), eResult::SUCCESS);
+        ASSERT_EQ(client.Publish("sensor/config", discovery), eResult::SUCCESS);
+    }
+
+    EXPECT_EQ(allocations.Count(), 0u);
+    EXPECT_EQ(client.GetPrintStats().allocatedBytes, warm.allocatedBytes);
+    EXPECT_EQ(client.GetPrintStats().hits, warm.hits + 2000);
+}
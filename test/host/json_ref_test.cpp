@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "baozi_json.h"
+#include "cjson_allocations.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson makeLight()
+    {
+        BaoJson effects = BaoJson::CreateArray();
+        effects.AddValToArray("rainbow");
+        effects.AddValToArray("fire");
+
+        return BaoJson{KV{"name", "lamp"},
+                       KV{"light", BaoJson{KV{"brightness", 128}, KV{"color", BaoJson{KV{"r", 255}}}}},
+                       KV{"effects", std::move(effects)}};
+    }
+
+    std::string print(const BaoJson &json)
+    {
+        return json.PrintRaw().get();
+    }
+} // namespace
+
+TEST(BaoJsonRef, NestedReadsDoNotAllocate)
+{
+    const BaoJson json = makeLight();
+
+    int brightness = 0;
+    int red = 0;
+    std::vector<std::string> effects;
+    effects.reserve(2);
+
+    CJsonAllocations allocations;
+    {
+        auto light = json.GetVal<BaoJsonConstRef>("light");
+        ASSERT_TRUE(light.has_value());
+        brightness = light->GetVal<int>("brightness").value_or(0);
+        red = light->GetVal<BaoJsonConstRef>("color")->GetVal<int>("r").value_or(0);
+        json.GetVal<BaoJsonConstRef>("effects")->ArrayForEach<const char *>([&](const char *effect) { effects.emplace_back(effect); });
+    }
+
+    EXPECT_EQ(allocations.Count(), 0u);
+    EXPECT_EQ(brightness, 128);
+    EXPECT_EQ(red, 255);
+    EXPECT_EQ(effects, (std::vector<std::string>{"rainbow", "fire"}));
+}
+
+TEST(BaoJsonRef, ArrayForEachBorrowsObjects)
+{
+    BaoJson array = BaoJson::CreateArray();
+    array.AddValToArray(BaoJson{KV{"id", 1}});
+    array.AddValToArray(BaoJson{KV{"id", 2}});
+    const cJSON *first = array.data()->child;
+
+    std::vector<const cJSON *> seen;
+    CJsonAllocations allocations;
+    array.ArrayForEach<BaoJson>([&](BaoJsonConstRef item) { seen.push_back(item.data()); });
+
+    EXPECT_EQ(allocations.Count(), 0u);
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], first);
+    EXPECT_EQ(array.ArraySize(), 2);
+}
+
+TEST(BaoJsonRef, GetValOfBaoJsonCopiesAndLeavesTheSourceUntouched)
+{
+    const BaoJson json = makeLight();
+    const std::string before = print(json);
+
+    auto light = json.GetVal<BaoJson>("light");
+    ASSERT_TRUE(light.has_value());
+    light->AddVal("brightness_scale", 255);
+
+    EXPECT_EQ(print(json), before);
+    EXPECT_NE(light->data(), json.GetVal<BaoJsonConstRef>("light")->data());
+    EXPECT_EQ(light->GetVal<int>("brightness"), 128);
+}
+
+TEST(BaoJsonRef, GetRefModifiesInPlace)
+{
+    BaoJson json = makeLight();
+
+    auto light = json.GetRef("light");
+    ASSERT_TRUE(light.has_value());
+    light->AddVal("transition", 2);
+
+    EXPECT_EQ(json.GetVal<BaoJsonConstRef>("light")->GetVal<int>("transition"), 2);
+    EXPECT_FALSE(json.GetRef("name").has_value()); // not an object or array
+    EXPECT_FALSE(json.GetRef("missing").has_value());
+}
+
+TEST(BaoJsonRef, DuplicateIsADeepCopy)
+{
+    const BaoJson json = makeLight();
+    BaoJson copy = json.GetVal<BaoJsonConstRef>("light")->Duplicate();
+
+    copy.GetRef("color")->AddVal("g", 1);
+    EXPECT_FALSE(json.GetVal<BaoJsonConstRef>("light")->GetVal<BaoJsonConstRef>("color")->HasItem("g"));
+}
@@ -0,0 +1,65 @@
+// the Home Assistant sensor and binary sensor discovery payloads of Register(), built with copied keys against
+// static keys - allocsPerOp and peakHeapBytes give the allocations and bytes the static keys save per payload
+
+#include <cstdio>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+
+    const std::string name = "living_room_temperature";
+    const std::string stateTopic = "homeassistant/sensor/" + name + "/state";
+    const std::string valueTemplate = "{{ value_json.temperature | round(2) }}";
+
+    BaoJsonBench bench;
+
+    bench.Run("sensor_discovery_copied_keys", ITERATIONS, [&] {
+        BaoJson json{KV{"name", name},
+                     KV{"state_topic", stateTopic},
+                     KV{"value_template", valueTemplate},
+                     KV{"unit_of_measurement", "°C"}};
+        json.AddVal("device_class", "temperature");
+        auto printed = json.PrintRaw();
+    });
+
+    bench.Run("sensor_discovery_static_keys", ITERATIONS, [&] {
+        BaoJson json{KV{"name"_key, name},
+                     KV{"state_topic"_key, stateTopic},
+                     KV{"value_template"_key, valueTemplate},
+                     KV{"unit_of_measurement"_key, "°C"}};
+        json.AddVal("device_class"_key, "temperature");
+        auto printed = json.PrintRaw();
+    });
+
+    bench.Run("binary_sensor_discovery_copied_keys", ITERATIONS, [&] {
+        BaoJson json{KV{"name", name},
+                     KV{"state_topic", stateTopic},
+                     KV{"value_template", valueTemplate},
+                     KV{"unit_of_measurement", ""},
+                     KV{"icon", "mdi:door"},
+                     KV{"on_payload", "ON"},
+                     KV{"off_payload", "OFF"}};
+        json.AddVal("device_class", "door");
+        auto printed = json.PrintRaw();
+    });
+
+    bench.Run("binary_sensor_discovery_static_keys", ITERATIONS, [&] {
+        BaoJson json{KV{"name"_key, name},
+                     KV{"state_topic"_key, stateTopic},
+                     KV{"value_template"_key, valueTemplate},
+                     KV{"unit_of_measurement"_key, ""},
+                     KV{"icon"_key, "mdi:door"},
+                     KV{"on_payload"_key, "ON"},
+                     KV{"off_payload"_key, "OFF"}};
+        json.AddVal("device_class"_key, "door");
+        auto printed = json.PrintRaw();
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
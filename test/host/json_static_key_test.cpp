@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "baozi_json.h"
+#include "cjson_allocations.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr const char *STATE_NAME = "state";
+} // namespace
+
+TEST(StaticKey, AttachesTheKeyWithoutCopyingIt)
+{
+    static constexpr const char NAME[] = "name";
+    BaoJson json;
+    json.AddVal(StaticKey{NAME}, "lamp");
+
+    const cJSON *item = json.data()->child;
+    ASSERT_NE(item, nullptr);
+    EXPECT_EQ(item->string, NAME);
+    EXPECT_TRUE(item->type & cJSON_StringIsConst);
+    EXPECT_EQ(json.GetVal<const char *>("name"), std::string_view{"lamp"});
+}
+
+TEST(StaticKey, SavesOneAllocationPerKey)
+{
+    uint32_t copied = 0;
+    uint32_t borrowed = 0;
+    {
+        CJsonAllocations allocations;
+        BaoJson json{KV{"name", "lamp"}, KV{"state_topic", "baozi/lamp/state"}};
+        json.AddVal("icon", "mdi:lamp");
+        copied = allocations.Count();
+    }
+    {
+        CJsonAllocations allocations;
+        BaoJson json{KV{"name"_key, "lamp"}, KV{"state_topic"_key, "baozi/lamp/state"}};
+        json.AddVal("icon"_key, "mdi:lamp");
+        borrowed = allocations.Count();
+    }
+
+    EXPECT_EQ(copied - borrowed, 3u);
+}
+
+TEST(StaticKey, WorksThroughReferencesAndUnchecked)
+{
+    BaoJson json{KV{"device", BaoJson{}}};
+    json.GetRef("device")->AddVal("sw_version"_key, "1.0");
+    json.AddVal(StaticKey::Unchecked(STATE_NAME), "ON");
+
+    EXPECT_EQ(json.GetVal<BaoJsonConstRef>("device")->GetVal<const char *>("sw_version"), std::string_view{"1.0"});
+    EXPECT_EQ(json.data()->child->next->string, STATE_NAME);
+    EXPECT_STREQ(json.PrintRaw().get(), R"({"device":{"sw_version":"1.0"},"state":"ON"})");
+}
+
+TEST(StaticKey, DuplicatesBorrowTheSameKey)
+{
+    BaoJson json{KV{"name"_key, "lamp"}};
+    BaoJson copy = json.Duplicate();
+    json.reset();
+
+    EXPECT_EQ(copy.GetVal<const char *>("name"), std::string_view{"lamp"});
+    EXPECT_TRUE(copy.data()->child->type & cJSON_StringIsConst);
+}
@@ -0,0 +1,96 @@
+// the BaoJson suite of the home assistant payloads the firmware sends and receives - discovery configs, state
+// messages and command objects - through build, print, parse, GetVal, array ops and Duplicate
+
+#include <cstdio>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson buildDiscovery(const std::string &name)
+    {
+        BaoJson device{KV{"identifiers", "baozi_0a1b2c"},
+                       KV{"manufacturer", "Baozi"},
+                       KV{"model", "Sensor Hub"},
+                       KV{"sw_version", "1.4.2"}};
+
+        BaoJson json{KV{"name", name},
+                     KV{"unique_id", "baozi_0a1b2c_" + name},
+                     KV{"state_topic", "homeassistant/sensor/" + name + "/state"},
+                     KV{"value_template", "{{ value_json.temperature | round(2) }}"},
+                     KV{"unit_of_measurement", "°C"},
+                     KV{"device_class", "temperature"}};
+        json.AddVal("device", std::move(device));
+        return json;
+    }
+
+    BaoJson buildState()
+    {
+        return BaoJson{KV{"temperature", 21.37}, KV{"humidity", 48.5}, KV{"battery", 87}, KV{"online", true}};
+    }
+
+    BaoJson buildCommand()
+    {
+        BaoJson color{KV{"r", 255}, KV{"g", 128}, KV{"b", 0}};
+        BaoJson json{KV{"state", "ON"}, KV{"brightness", 180}, KV{"transition", 2}};
+        json.AddVal("color", std::move(color));
+        return json;
+    }
+} // namespace
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 10000;
+
+    const BaoJson discovery = buildDiscovery("living_room_temperature");
+    const BaoJson state = buildState();
+    const BaoJson command = buildCommand();
+
+    const std::string discoveryText = discovery.PrintRaw().get();
+    const std::string stateText = state.PrintRaw().get();
+    const std::string commandText = command.PrintRaw().get();
+
+    BaoJsonBench bench;
+    volatile int sink = 0;
+
+    bench.Run("discovery_build", ITERATIONS, [&] { BaoJson json = buildDiscovery("living_room_temperature"); });
+    bench.Run("discovery_print", ITERATIONS, [&] { auto printed = discovery.PrintRaw(); });
+    bench.Run("discovery_parse", ITERATIONS, [&] { auto json = BaoJson::Parse(discoveryText.c_str()); });
+    bench.Run("discovery_duplicate", ITERATIONS, [&] { BaoJson copy = discovery.Duplicate(); });
+
+    bench.Run("state_build", ITERATIONS, [&] { BaoJson json = buildState(); });
+    bench.Run("state_print", ITERATIONS, [&] { auto printed = state.PrintRaw(); });
+    bench.Run("state_parse", ITERATIONS, [&] { auto json = BaoJson::Parse(stateText.c_str()); });
+    bench.Run("state_getval", ITERATIONS, [&] {
+        sink = sink + static_cast<int>(state.GetVal<double>("temperature").value_or(0));
+        sink = sink + state.GetVal<int>("battery").value_or(0);
+        sink = sink + state.GetVal<bool>("online").value_or(false);
+    });
+
+    bench.Run("command_parse", ITERATIONS, [&] { auto json = BaoJson::Parse(commandText.c_str()); });
+    bench.Run("command_parse_getval", ITERATIONS, [&] {
+        auto json = BaoJson::Parse(commandText.c_str());
+        sink = sink + json->GetVal<int>("brightness").value_or(0);
+        sink = sink + json->GetVal<BaoJsonConstRef>("color")->GetVal<int>("g").value_or(0);
+    });
+    bench.Run("command_duplicate", ITERATIONS, [&] { BaoJson copy = command.Duplicate(); });
+
+    bench.Run("array_append_16_states", ITERATIONS / 10, [&] {
+        BaoJson array = BaoJson::CreateArray();
+        for (int i = 0; i < 16; i++)
+            array.AddValToArray(state.Duplicate());
+    });
+    bench.Run("array_drain_16_states", ITERATIONS / 10, [&] {
+        BaoJson array = BaoJson::CreateArray();
+        for (int i = 0; i < 16; i++)
+            array.AddValToArray(state.Duplicate());
+        while (array.ArraySize() > 0)
+            sink = sink + array.ArrayPopFront()->GetVal<int>("battery").value_or(0);
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
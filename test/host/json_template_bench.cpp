@@ -0,0 +1,37 @@
+// rendering a sensor state with BaoJsonTemplate, against BaoJsonWriter and building and printing a BaoJson
+
+#include <cstdio>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_template.h"
+#include "baozi_json_writer.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 200000;
+    static constexpr BaoJsonTemplate<32> TEMPERATURE{"temperature"};
+
+    BaoJsonBench bench;
+    volatile double value = 21.5; // not folded into a constant
+
+    bench.Run("state_cjson_build_print", ITERATIONS, [&] {
+        BaoJson json{KV{"temperature", static_cast<double>(value)}};
+        auto printed = json.PrintRaw();
+    });
+
+    bench.Run("state_writer", ITERATIONS, [&] {
+        char payload[64];
+        BaoJsonWriter writer{payload};
+        writer.AddVal("temperature", static_cast<double>(value));
+    });
+
+    bench.Run("state_template", ITERATIONS, [&] {
+        char payload[64];
+        TEMPERATURE.Render(payload, sizeof(payload), static_cast<double>(value));
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
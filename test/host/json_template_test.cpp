@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "baozi_json_template.h"
+#include "baozi_json_writer.h"
+#include "baozi_time_units.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr BaoJsonTemplate<32> TEMPERATURE{"temperature"};
+
+    template <size_t N, typename T>
+    std::string render(const BaoJsonTemplate<N> &jsonTemplate, T value, int8_t precision = JSON_PRECISION_SHORTEST)
+    {
+        char payload[64];
+        size_t length = jsonTemplate.Render(payload, sizeof(payload), value, precision);
+        EXPECT_EQ(length, strlen(payload));
+        return payload;
+    }
+} // namespace
+
+TEST(BaoJsonTemplate, RendersLikeTheWriter)
+{
+    for (double value : {21.5, -3.25, 0.0, 1e20, 123456789.0})
+    {
+        char buffer[64];
+        BaoJsonWriter writer{buffer};
+        writer.AddVal("temperature", value);
+
+        EXPECT_EQ(render(TEMPERATURE, value), writer.c_str());
+    }
+}
+
+TEST(BaoJsonTemplate, RendersFloatsInTheirShortestForm)
+{
+    EXPECT_EQ(render(TEMPERATURE, 21.3f), R"({"temperature":21.3})");
+}
+
+TEST(BaoJsonTemplate, RoundsToPrecision)
+{
+    EXPECT_EQ(render(TEMPERATURE, 21.46, 1), R"({"temperature":21.5})");
+    EXPECT_EQ(render(TEMPERATURE, 21.0, 2), R"({"temperature":21})");
+}
+
+TEST(BaoJsonTemplate, RendersIntegersBooleansAndUnits)
+{
+    constexpr BaoJsonTemplate<16> STATE{"state"};
+
+    EXPECT_EQ(render(STATE, -42), R"({"state":-42})");
+    EXPECT_EQ(render(STATE, 4000000000u), R"({"state":4000000000})");
+    EXPECT_EQ(render(STATE, true), R"({"state":true})");
+    EXPECT_EQ(render(STATE, MilliSeconds(250)), R"({"state":250})");
+}
+
+TEST(BaoJsonTemplate, EscapesTheKey)
+{
+    constexpr BaoJsonTemplate<16> QUOTED{"a\"b"};
+
+    EXPECT_EQ(render(QUOTED, 1), R"({"a\"b":1})");
+}
+
+TEST(BaoJsonTemplate, RuntimeKeyRendersLikeConstexpr)
+{
+    // sensors render their template once when they are constructed
+    std::string key = "temperature";
+    const BaoJsonTemplate<32> runtime{key.c_str()};
+
+    EXPECT_EQ(render(runtime, 21.5), render(TEMPERATURE, 21.5));
+}
+
+TEST(BaoJsonTemplate, RefusesTooSmallBuffer)
+{
+    char payload[16];
+
+    EXPECT_EQ(TEMPERATURE.Render(payload, sizeof(payload), 21.5), 0u);
+}
+
+TEST(BaoJsonTemplateDeathTest, KeyLongerThanTheTemplateAsserts)
+{
+    std::string key(40, 'k');
+
+    EXPECT_DEATH(BaoJsonTemplate<32>{key.c_str()}, "assert failed");
+}
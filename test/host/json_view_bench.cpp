@@ -0,0 +1,60 @@
+// parsing an incoming payload and reading a value - a cJSON tree, as MqttClient did before BaoJsonView,
+// against tokenizing into the fixed MqttClient token array, and into heap tokens for payloads that do not fit it
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_view.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+    static constexpr size_t MAX_PAYLOAD_TOKENS = 64; // MqttClient::MAX_PAYLOAD_TOKENS
+
+    const std::string command = R"({"state":"ON","brightness":128,"color":{"r":255,"g":120,"b":0},"effect":"rainbow"})";
+
+    std::string big = "{"; // 401 tokens
+    for (int i = 0; i < 200; i++)
+        big += (i ? ",\"v" : "\"v") + std::to_string(i) + "\":" + std::to_string(i);
+    big += "}";
+
+    BaoJsonBench bench;
+    volatile int sink = 0;
+
+    bench.Run("command_cjson_parse", ITERATIONS, [&] {
+        auto json = BaoJson::Parse(command.data(), command.size());
+        sink = json->GetVal<int>("brightness").value_or(0);
+    });
+
+    bench.Run("command_view_parse", ITERATIONS, [&] {
+        std::array<BaoJsonToken, MAX_PAYLOAD_TOKENS> tokens;
+        auto json = BaoJsonView::Parse(command, tokens);
+        sink = json->GetVal<int>("brightness").value_or(0);
+    });
+
+    bench.Run("big_cjson_parse", ITERATIONS / 10, [&] {
+        auto json = BaoJson::Parse(big.data(), big.size());
+        sink = json->GetVal<int>("v199").value_or(0);
+    });
+
+    // what MqttClient::parsePayload() does - run out of the fixed tokens, then double heap tokens until they suffice
+    bench.Run("big_view_heap_tokens", ITERATIONS / 10, [&] {
+        std::array<BaoJsonToken, MAX_PAYLOAD_TOKENS> tokens;
+        std::unique_ptr<BaoJsonToken[]> heapTokens;
+        auto json = BaoJsonView::Parse(big.data(), big.size(), tokens.data(), tokens.size());
+        for (size_t maxTokens = MAX_PAYLOAD_TOKENS * 2; !json.has_value(); maxTokens *= 2)
+        {
+            heapTokens = std::make_unique<BaoJsonToken[]>(maxTokens);
+            json = BaoJsonView::Parse(big.data(), big.size(), heapTokens.get(), maxTokens);
+        }
+        sink = json->GetVal<int>("v199").value_or(0);
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
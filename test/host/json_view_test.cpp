@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "baozi_json_view.h"
+
+using namespace Baozi;
+
+TEST(BaoJsonView, ReadsValuesLikeBaoJson)
+{
+    std::array<BaoJsonToken, 32> tokens;
+    std::string_view text = R"({"state":"ON","brightness":128,"ratio":0.5,"on":true,"color":{"r":255,"g":0}})";
+
+    auto json = BaoJsonView::Parse(text, tokens);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_TRUE(json->IsObject());
+    EXPECT_EQ(json->GetVal<std::string_view>("state"), "ON");
+    EXPECT_EQ(json->GetVal<int>("brightness"), 128);
+    EXPECT_EQ(json->GetVal<double>("ratio"), 0.5);
+    EXPECT_EQ(json->GetVal<bool>("on"), true);
+    EXPECT_FALSE(json->HasItem("missing"));
+    EXPECT_FALSE(json->GetVal<int>("state").has_value());
+
+    auto color = json->GetVal<BaoJsonView>("color");
+    ASSERT_TRUE(color.has_value());
+    EXPECT_EQ(color->GetVal<int>("r"), 255);
+    EXPECT_EQ(color->GetVal<int>("g"), 0);
+}
+
+TEST(BaoJsonView, WalksArraysAndObjects)
+{
+    std::array<BaoJsonToken, 32> tokens;
+    std::string_view text = R"({"effects":["rainbow","fire",{"skip":1},"strobe"],"n":[1,2,3]})";
+
+    auto json = BaoJsonView::Parse(text, tokens);
+    ASSERT_TRUE(json.has_value());
+
+    std::vector<std::string_view> effects;
+    json->GetVal<BaoJsonView>("effects")->ArrayForEach<std::string_view>([&](std::string_view effect) { effects.push_back(effect); });
+    EXPECT_EQ(effects, (std::vector<std::string_view>{"rainbow", "fire", "strobe"}));
+    EXPECT_EQ(json->GetVal<BaoJsonView>("n")->ArraySize(), 3);
+
+    std::vector<std::string_view> keys;
+    json->ObjectForEach([&](std::string_view key, const BaoJsonView &) { keys.push_back(key); });
+    EXPECT_EQ(keys, (std::vector<std::string_view>{"effects", "n"}));
+}
+
+TEST(BaoJsonView, UnescapesOnlyWhenReadAsString)
+{
+    std::array<BaoJsonToken, 8> tokens;
+    std::string_view text = R"({"name":"a\"bé"})";
+
+    auto json = BaoJsonView::Parse(text, tokens);
+    ASSERT_TRUE(json.has_value());
+    EXPECT_EQ(json->GetVal<std::string_view>("name"), R"(a\"bé)");
+    EXPECT_EQ(json->GetVal<std::string>("name"), "a\"b\xc3\xa9");
+}
+
+TEST(BaoJsonView, RejectsInvalidJsonAndTooFewTokens)
+{
+    std::array<BaoJsonToken, 4> tokens;
+
+    EXPECT_FALSE(BaoJsonView::Parse(std::string_view{"not json"}, tokens).has_value());
+    EXPECT_FALSE(BaoJsonView::Parse(std::string_view{R"({"a":1,)"}, tokens).has_value());
+    EXPECT_FALSE(BaoJsonView::Parse(std::string_view{R"({"a":1,"b":2,"c":3})"}, tokens).has_value());
+    EXPECT_TRUE(BaoJsonView::Parse(std::string_view{R"({"a":1})"}, tokens).has_value());
+}
+
+TEST(BaoJsonParser, ResumesAcrossChunks)
+{
+    std::array<BaoJsonToken, 16> tokens;
+    BaoJsonParser parser{tokens};
+    std::string text = R"({"temperature":21.5,"unit":"C"})";
+
+    // cut in the middle of a key, a number and a string
+    size_t cuts[] = {5, 17, 27, text.size()};
+    BaoJsonParser::eStatus status{};
+    for (size_t cut : cuts)
+        status = parser.Parse(text.data(), cut, cut == text.size());
+
+    ASSERT_EQ(status, BaoJsonParser::eStatus::COMPLETE);
+    auto json = parser.View(text.data());
+    EXPECT_EQ(json.GetVal<double>("temperature"), 21.5);
+    EXPECT_EQ(json.GetVal<std::string_view>("unit"), "C");
+}
+
+TEST(BaoJsonParser, ReportsNoMemory)
+{
+    std::array<BaoJsonToken, 2> tokens;
+    BaoJsonParser parser{tokens};
+    std::string_view text = R"({"a":1,"b":2})";
+
+    EXPECT_EQ(parser.Parse(text.data(), text.size()), BaoJsonParser::eStatus::NO_MEMORY);
+}
@@ -0,0 +1,28 @@
+// BaoJsonWriter against building and printing a BaoJson, for the payload of a sensor state publish
+
+#include <cstdio>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_writer.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+    BaoJsonBench bench;
+
+    bench.Run("state_cjson_build_print", ITERATIONS, [] {
+        BaoJson json{KV{"temperature", 21.5}, KV{"humidity", 40.2}, KV{"battery", 87}};
+        auto printed = json.PrintRaw();
+    });
+
+    bench.Run("state_writer", ITERATIONS, [] {
+        char buffer[128];
+        BaoJsonWriter writer{buffer};
+        writer.AddVals(KV{"temperature", 21.5}, KV{"humidity", 40.2}, KV{"battery", 87});
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    return 0;
+}
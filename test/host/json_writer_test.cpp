@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_writer.h"
+
+using namespace Baozi;
+
+namespace
+{
+    std::string printed(const BaoJson &json)
+    {
+        return json.PrintRaw().get();
+    }
+} // namespace
+
+TEST(BaoJsonWriter, WritesLikeCJsonPrints)
+{
+    char buffer[256];
+    BaoJsonWriter writer{buffer};
+    writer.AddVals(KV{"temperature", 21.5}, KV{"humidity", 40}, KV{"unit", "C"}, KV{"on", true}, KV{"big", 1e20}, KV{"neg", -7});
+
+    BaoJson json{KV{"temperature", 21.5}, KV{"humidity", 40}, KV{"unit", "C"}, KV{"on", true}, KV{"big", 1e20}, KV{"neg", -7}};
+
+    EXPECT_TRUE(writer);
+    EXPECT_EQ(std::string(writer.c_str()), printed(json));
+    EXPECT_EQ(writer.length(), strlen(writer.c_str()));
+}
+
+TEST(BaoJsonWriter, EscapesStrings)
+{
+    char buffer[64];
+    BaoJsonWriter writer{buffer};
+    writer.AddVal("s", "a\"b\\c\n\x01");
+
+    EXPECT_STREQ(writer.c_str(), R"({"s":"a\"b\\c\n\u0001"})");
+}
+
+TEST(BaoJsonWriter, WritesEmptyOptionalAsNull)
+{
+    char buffer[64];
+    BaoJsonWriter writer{buffer};
+    writer.AddVals(KV{"missing", std::optional<int>{}}, KV{"present", std::optional<int>{3}});
+
+    EXPECT_STREQ(writer.c_str(), R"({"missing":null,"present":3})");
+}
+
+TEST(BaoJsonWriter, DropsValueThatDoesNotFit)
+{
+    char buffer[20];
+    BaoJsonWriter writer{buffer};
+    writer.AddVal("a", 1);
+    writer.AddVal("bbbbbbbbbbbbbbbbb", 2);
+
+    EXPECT_FALSE(writer);
+    EXPECT_STREQ(writer.c_str(), R"({"a":1})");
+    EXPECT_TRUE(BaoJson::Parse(writer.c_str()).has_value());
+}
+
+TEST(BaoJsonWriter, ResetStartsAnEmptyObject)
+{
+    char buffer[8];
+    BaoJsonWriter writer{buffer};
+    writer.AddVal("too long for the buffer", 1);
+    ASSERT_FALSE(writer);
+
+    writer.Reset();
+    EXPECT_TRUE(writer);
+    EXPECT_STREQ(writer.c_str(), "{}");
+    EXPECT_EQ(writer.length(), 2u);
+}
+
+TEST(BaoJsonWriter, WritesNestedJson)
+{
+    char buffer[64];
+    BaoJsonWriter writer{buffer};
+    writer.AddVal("nested", BaoJson{KV{"x", 1}});
+
+    EXPECT_STREQ(writer.c_str(), R"({"nested":{"x":1}})");
+}
+
+TEST(BaoJsonWriter, PlainValuesMakeNoCJsonAllocation)
+{
+    BaoJsonBench bench;
+    const auto &result = bench.Run("writer", 100, [] {
+        char buffer[128];
+        BaoJsonWriter writer{buffer};
+        writer.AddVals(KV{"temperature", 21.5}, KV{"unit", "C"}, KV{"on", true});
+    });
+
+    EXPECT_EQ(result.allocsPerOp, 0.0f);
+}
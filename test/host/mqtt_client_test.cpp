@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "baozi_json_writer.h"
+#include "baozi_mqtt.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    // a client connected to the faked broker
+    class MqttClientTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            HostMqtt::Reset();
+            client.emplace();
+            ASSERT_EQ(client->TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"}), eResult::SUCCESS);
+            broker = HostMqtt::LastClient();
+            HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+            ASSERT_TRUE(client->IsConnected());
+        }
+
+        std::optional<MqttClient> client;
+        esp_mqtt_client_handle_t broker{};
+    };
+
+    // {"v0":0,"v1":1,...} - 1 + 2 * count tokens
+    std::string bigObject(int count)
+    {
+        std::string text = "{";
+        for (int i = 0; i < count; i++)
+            text += (i ? ",\"v" : "\"v") + std::to_string(i) + "\":" + std::to_string(i);
+        return text + "}";
+    }
+} // namespace
+
+TEST_F(MqttClientTest, SubscribesHandlersAndDeliversViews)
+{
+    std::vector<int> received;
+    client->On("baozi/light/set", [&](std::string_view topic, const BaoJsonView &payload) {
+        EXPECT_EQ(topic, "baozi/light/set");
+        received.push_back(payload.GetVal<int>("brightness").value_or(-1));
+    });
+
+    EXPECT_EQ(HostMqtt::Subscribed(broker), std::vector<std::string>{"baozi/light/set"});
+    EXPECT_EQ(client->UnsubscribedCount(), 0u);
+
+    HostMqtt::DeliverData(broker, "baozi/light/set", R"({"brightness":42})");
+    HostMqtt::DeliverData(broker, "baozi/other", R"({"brightness":1})");
+    EXPECT_EQ(received, std::vector<int>{42});
+}
+
+TEST_F(MqttClientTest, PayloadsBeyondTheTokenArrayUseHeapTokens)
+{
+    static constexpr int VALUES = 200; // 401 tokens, over MAX_PAYLOAD_TOKENS
+    static_assert(1 + 2 * VALUES > MqttClient::MAX_PAYLOAD_TOKENS);
+
+    std::optional<int> last;
+    client->On("baozi/big", [&](std::string_view, const BaoJsonView &payload) { last = payload.GetVal<int>("v199"); });
+
+    HostMqtt::DeliverData(broker, "baozi/big", bigObject(VALUES));
+    EXPECT_EQ(last, 199);
+
+    // and the fixed tokens are still used for the next small payload
+    HostMqtt::DeliverData(broker, "baozi/big", R"({"v199":7})");
+    EXPECT_EQ(last, 7);
+}
+
+TEST_F(MqttClientTest, TextPayloadsKeepTheirRawText)
+{
+    std::optional<std::string> raw;
+    client->On("baozi/text", [&](std::string_view, const BaoJsonView &payload) {
+        EXPECT_FALSE(payload);
+        raw = std::string{payload.Raw()};
+    });
+
+    HostMqtt::DeliverData(broker, "baozi/text", "ON");
+    EXPECT_EQ(raw, "ON");
+}
+
+TEST_F(MqttClientTest, PublishesTheWholeWriterPayload)
+{
+    char buffer[64];
+    BaoJsonWriter writer{buffer};
+    writer.AddVal("state", "ON");
+
+    ASSERT_EQ(client->Publish("baozi/light/state", writer), eResult::SUCCESS);
+
+    auto published = HostMqtt::Published(broker);
+    ASSERT_EQ(published.size(), 1u);
+    EXPECT_EQ(published[0].topic, "baozi/light/state");
+    EXPECT_EQ(published[0].payload, R"({"state":"ON"})");
+}
+
+// esp-mqtt holds its lock while its event handler runs, and a handler publishing takes the same lock - an incoming
+// message waiting for another task's drain (which publishes) would deadlock, so it is dispatched without waiting
+TEST_F(MqttClientTest, IncomingDataDoesNotWaitForAnotherTasksDrain)
+{
+    static constexpr int MESSAGES = 2000;
+    std::atomic<int> handled{0};
+    client->On("baozi/cmd", [&](std::string_view, const BaoJsonView &payload) {
+        client->Publish("baozi/ack", std::to_string(payload.GetVal<int>("n").value_or(-1)).c_str());
+        handled++;
+    });
+
+    std::atomic<bool> stop{false};
+    auto drainer = std::async(std::launch::async, [&] {
+        while (!stop)
+            client->ProcessInbox();
+    });
+
+    auto deliveries = std::async(std::launch::async, [&] {
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            HostMqtt::DeliverData(broker, "baozi/cmd", "{\"n\":" + std::to_string(i) + "}");
+            // a message keeps its reassembler slot until handled, and the one just handled may still hold its own -
+            // stay below the slots, no message is dropped
+            while (i - handled > static_cast<int>(MqttReassembler::SLOT_COUNT) - 2)
+                std::this_thread::yield();
+        }
+        while (handled < MESSAGES)
+            std::this_thread::yield();
+    });
+
+    if (deliveries.wait_for(std::chrono::seconds(20)) != std::future_status::ready)
+    {
+        fprintf(stderr, "incoming data deadlocked with a draining task\n");
+        std::_Exit(EXIT_FAILURE); // the deadlocked threads can not be joined
+    }
+    stop = true;
+    drainer.wait();
+
+    auto published = HostMqtt::Published(broker);
+    ASSERT_EQ(published.size(), static_cast<size_t>(MESSAGES));
+    for (int i = 0; i < MESSAGES; i++)
+        EXPECT_EQ(published[i].payload, std::to_string(i));
+}
+
+// handlers run without the handler mutex, so one may add handlers of its own
+TEST_F(MqttClientTest, AHandlerMayAddHandlers)
+{
+    std::optional<int> late;
+    client->On("baozi/discover", [&](std::string_view, const BaoJsonView &) {
+        client->On("baozi/late", [&](std::string_view, const BaoJsonView &payload) { late = payload.GetVal<int>("n"); });
+    });
+
+    HostMqtt::DeliverData(broker, "baozi/discover", "{}");
+    HostMqtt::DeliverData(broker, "baozi/late", R"({"n":3})");
+    EXPECT_EQ(late, 3);
+    EXPECT_EQ(client->UnsubscribedCount(), 0u);
+}
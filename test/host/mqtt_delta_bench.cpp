@@ -0,0 +1,62 @@
+// bytes sent for a light state where one or two members change per message, published whole with Publish()
+// against PublishDelta() with the default snapshot interval, and the time each takes per message
+
+#include <cstdio>
+#include <numeric>
+#include "baozi_json_bench.h"
+#include "baozi_mqtt.h"
+#include "esp_log.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    BaoJson lightState(int i)
+    {
+        static const char *EFFECTS[] = {"rainbow", "fire", "strobe"};
+        return BaoJson{KV{"state", "ON"},
+                       KV{"brightness", i % 256},
+                       KV{"color_temp", 300},
+                       KV{"color", BaoJson{KV{"r", 255}, KV{"g", 120}, KV{"b", 0}}},
+                       KV{"effect", EFFECTS[(i / 10) % 3]},
+                       KV{"transition", 2},
+                       KV{"power_w", 4.5 + (i % 7) * 0.5},
+                       KV{"energy_kwh", 12.75}};
+    }
+
+    size_t publishedBytes(esp_mqtt_client_handle_t broker)
+    {
+        auto published = HostMqtt::Published(broker);
+        return std::accumulate(published.begin(), published.end(), size_t{0},
+                               [](size_t sum, const HostMqtt::Message &message) { return sum + message.payload.size(); });
+    }
+} // namespace
+
+int main()
+{
+    static constexpr int MESSAGES = 1000;
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    MqttClient client;
+    client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"});
+    esp_mqtt_client_handle_t broker = HostMqtt::LastClient();
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+
+    BaoJsonBench bench;
+    int full = 0;
+    int delta = 0;
+
+    bench.Run("publish_full", MESSAGES, [&] { client.Publish("light/full", lightState(full++)); });
+    size_t fullBytes = publishedBytes(broker);
+    HostMqtt::ClearPublished(broker);
+
+    bench.Run("publish_delta", MESSAGES, [&] { client.PublishDelta("light/delta", lightState(delta++)); });
+    size_t deltaBytes = publishedBytes(broker);
+
+    // every Run() calls the op 2 * MESSAGES + 1 times
+    uint32_t calls = 2 * MESSAGES + 1;
+    printf("%s\n", bench.Report().PrintRaw().get());
+    printf("{\"bytesPerMessage\":{\"full\":%u,\"delta\":%u}}\n", static_cast<unsigned>(fullBytes / calls), static_cast<unsigned>(deltaBytes / calls));
+    return 0;
+}
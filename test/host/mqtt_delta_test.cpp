@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <optional>
+#include <thread>
+#include "baozi_mqtt.h"
+#include "esp_log.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    class MqttDeltaTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            esp_log_level_set("*", ESP_LOG_WARN);
+            HostMqtt::Reset();
+            client.emplace();
+            ASSERT_EQ(client->TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10", .deltaSnapshotInterval = 3}), eResult::SUCCESS);
+            broker = HostMqtt::LastClient();
+            HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+            ASSERT_TRUE(client->IsConnected());
+        }
+
+        void TearDown() override
+        {
+            esp_log_level_set("*", ESP_LOG_INFO);
+        }
+
+        std::string lastPayload()
+        {
+            auto published = HostMqtt::Published(broker);
+            return published.empty() ? std::string{} : published.back().payload;
+        }
+
+        size_t publishedCount()
+        {
+            return HostMqtt::Published(broker).size();
+        }
+
+        static BaoJson state(int brightness, const char *effect = "rainbow")
+        {
+            return BaoJson{KV{"state", "ON"}, KV{"brightness", brightness}, KV{"effect", effect}};
+        }
+
+        std::optional<MqttClient> client;
+        esp_mqtt_client_handle_t broker{};
+    };
+} // namespace
+
+TEST_F(MqttDeltaTest, PublishesASnapshotThenDeltas)
+{
+    ASSERT_EQ(client->PublishDelta("light/state", state(10)), eResult::SUCCESS);
+    EXPECT_EQ(lastPayload(), R"({"state":"ON","brightness":10,"effect":"rainbow"})");
+
+    ASSERT_EQ(client->PublishDelta("light/state", state(20)), eResult::SUCCESS);
+    EXPECT_EQ(lastPayload(), R"({"brightness":20})");
+
+    ASSERT_EQ(client->PublishDelta("light/state", state(20, "fire")), eResult::SUCCESS);
+    EXPECT_EQ(lastPayload(), R"({"effect":"fire"})");
+}
+
+TEST_F(MqttDeltaTest, SkipsUnchangedObjects)
+{
+    client->PublishDelta("light/state", state(10));
+    ASSERT_EQ(client->PublishDelta("light/state", state(10)), eResult::SUCCESS);
+    EXPECT_EQ(publishedCount(), 1u);
+}
+
+TEST_F(MqttDeltaTest, SubscribersRebuildTheObject)
+{
+    BaoJson subscriber;
+    for (int i = 0; i < 10; i++)
+    {
+        BaoJson current = state(i * 10, i % 2 ? "fire" : "rainbow");
+        ASSERT_EQ(client->PublishDelta("light/state", current), eResult::SUCCESS);
+
+        auto patch = BaoJson::Parse(lastPayload().c_str());
+        ASSERT_EQ(subscriber.ApplyMergePatch(patch.value()), eResult::SUCCESS);
+        EXPECT_STREQ(subscriber.PrintRaw().get(), current.PrintRaw().get());
+    }
+}
+
+TEST_F(MqttDeltaTest, SendsASnapshotEveryIntervalAndAfterAReconnect)
+{
+    client->PublishDelta("light/state", state(0)); // snapshot
+    for (int i = 1; i <= 3; i++)
+    {
+        client->PublishDelta("light/state", state(i));
+        EXPECT_EQ(lastPayload(), "{\"brightness\":" + std::to_string(i) + "}");
+    }
+
+    client->PublishDelta("light/state", state(4)); // the interval is 3
+    EXPECT_EQ(lastPayload(), R"({"state":"ON","brightness":4,"effect":"rainbow"})");
+
+    client->PublishDelta("light/state", state(5));
+    EXPECT_EQ(lastPayload(), R"({"brightness":5})");
+
+    HostMqtt::Deliver(broker, MQTT_EVENT_DISCONNECTED);
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+    client->PublishDelta("light/state", state(6));
+    EXPECT_EQ(lastPayload(), R"({"state":"ON","brightness":6,"effect":"rainbow"})");
+}
+
+TEST_F(MqttDeltaTest, AFailedPublishKeepsTheLastPublishedBase)
+{
+    client->PublishDelta("light/state", state(10));
+
+    HostMqtt::FailPublishes(true);
+    EXPECT_EQ(client->PublishDelta("light/state", state(20)), eResult::FAIL);
+    HostMqtt::FailPublishes(false);
+
+    client->PublishDelta("light/state", state(30, "fire"));
+    EXPECT_EQ(lastPayload(), R"({"brightness":30,"effect":"fire"})");
+
+    // a failed first snapshot leaves nothing behind, the next message is a snapshot again
+    HostMqtt::FailPublishes(true);
+    EXPECT_EQ(client->PublishDelta("other/state", state(1)), eResult::FAIL);
+    HostMqtt::FailPublishes(false);
+    client->PublishDelta("other/state", state(1));
+    EXPECT_EQ(lastPayload(), R"({"state":"ON","brightness":1,"effect":"rainbow"})");
+}
+
+// esp-mqtt holds its lock while the event handler runs on_entry(STATE_CONNECTED), which takes the delta mutex,
+// and takes the same lock to publish - PublishDelta must not publish while holding the delta mutex
+TEST_F(MqttDeltaTest, ReconnectsWhilePublishingDoNotDeadlock)
+{
+    std::atomic<bool> stop{false};
+    auto publisher = std::async(std::launch::async, [&] {
+        for (int i = 0; !stop; i++)
+            client->PublishDelta("light/state", state(i));
+    });
+
+    auto reconnects = std::async(std::launch::async, [&] {
+        for (int i = 0; i < 2000; i++)
+        {
+            HostMqtt::Deliver(broker, MQTT_EVENT_DISCONNECTED);
+            HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+        }
+        stop = true;
+    });
+
+    if (reconnects.wait_for(std::chrono::seconds(20)) != std::future_status::ready)
+    {
+        fprintf(stderr, "PublishDelta deadlocked with a reconnect\n");
+        std::_Exit(EXIT_FAILURE); // the deadlocked threads can not be joined
+    }
+    publisher.wait();
+}
@@ -0,0 +1,161 @@
+// MqttClient under FsmFuzzer - random broker events, subscriptions and incoming messages on a virtual clock, checking
+// that every handler is subscribed again after a reconnect and gets every message of its topic. Prints the report of
+// every seed with its events/sec
+//   mqtt_fuzz [seed...]
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <variant>
+#include "baozi_mqtt.h"
+#include "esp_log.h"
+#include "fsm_fuzz.h"
+#include "host_fuzz.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+using namespace Baozi::MqttFSM;
+
+namespace
+{
+    constexpr uint32_t STEPS = 200000;
+    constexpr uint32_t MAX_ADVANCE_MS = 2000;
+    constexpr uint32_t RECONNECT_MS = 10000; // esp-mqtt's reconnect_timeout_ms
+
+    // 8 topics get handlers, the last 2 never do
+    constexpr std::array<const char *, 10> TOPICS{"home/0", "home/1", "home/2", "home/3", "home/4",
+                                                  "home/5", "home/6", "home/7", "home/8", "home/9"};
+    constexpr size_t SUBSCRIBABLE = 8;
+
+    // raises each event where the field raises it - the broker (the faked esp-mqtt) or the app's On() - so the fuzzer
+    // reaches the fsm through the same handlers as a real broker does. Messages are made here, an event only says when
+    class FieldMqtt
+    {
+    public:
+        uint32_t handled = 0;     // messages that reached a handler
+        uint32_t deliverable = 0; // messages delivered while connected to a topic with a handler
+
+        explicit FieldMqtt(uint32_t seed) : m_random(seed)
+        {
+            configASSERT(m_client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"}) == eResult::SUCCESS);
+            m_broker = HostMqtt::LastClient();
+        }
+
+        void Dispatch(Events event)
+        {
+            std::visit([this](auto &e) { raise(e); }, event);
+        }
+
+        template <typename State>
+        bool IsInState() const
+        {
+            return m_client.IsInState<State>();
+        }
+
+        const MqttClient &Client() const { return m_client; }
+
+        // esp-mqtt reconnects by itself
+        void Reconnect()
+        {
+            HostMqtt::Deliver(m_broker, MQTT_EVENT_BEFORE_CONNECT);
+            HostMqtt::Deliver(m_broker, MQTT_EVENT_CONNECTED);
+        }
+
+    private:
+        MqttClient m_client;
+        esp_mqtt_client_handle_t m_broker{};
+        FsmFuzzRandom m_random; // chunk sizes, apart from the fuzzer's steps
+        std::array<bool, TOPICS.size()> m_hasHandler{};
+        size_t m_nextTopic = 0;
+
+        void raise(EVENT_BEFORE_CONNECT &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_BEFORE_CONNECT); }
+        void raise(EVENT_CONNECTED &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_CONNECTED); }
+        void raise(EVENT_CONNECT &) {} // TryConnect() once at boot
+        void raise(EVENT_DISCONNECTED &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_DISCONNECTED); }
+        void raise(EVENT_SUBSCRIBED &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_SUBSCRIBED); }
+        void raise(EVENT_PUBLISHED &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_PUBLISHED); }
+        void raise(EVENT_ERROR &) { HostMqtt::Deliver(m_broker, MQTT_EVENT_ERROR); }
+
+        void raise(EVENT_SUBSCRIBE &)
+        {
+            size_t topic = m_nextTopic++ % SUBSCRIBABLE;
+            m_client.On(TOPICS[topic], [this](std::string_view, const BaoJsonView &) { handled++; });
+            m_hasHandler[topic] = true;
+        }
+
+        // the broker sends a message to a random topic, whole or in chunks of 1 to 3 bytes
+        void raise(EVENT_INCOMING_DATA &)
+        {
+            size_t topic = m_random.Below(TOPICS.size());
+            if (m_client.IsConnected() && m_hasHandler[topic])
+                deliverable++;
+
+            std::string payload = "{\"n\":" + std::to_string(m_random.Next()) + "}";
+            HostMqtt::DeliverData(m_broker, TOPICS[topic], payload, m_random.Below(4));
+        }
+    };
+
+    bool fuzz(uint32_t seed)
+    {
+        HostMqtt::Reset();
+
+        FieldMqtt mqtt{seed};
+        FsmFuzzer<FieldMqtt, Events> fuzzer{mqtt, seed, MAX_ADVANCE_MS};
+        fuzzer.Disable<EVENT_CONNECT>();
+
+        // esp-mqtt tries again RECONNECT_MS after it lost the broker, and the broker takes it back
+        uint32_t lastMs = 0;
+        std::optional<uint32_t> reconnectAtMs;
+        fuzzer.OnAdvance([&](uint32_t nowMs) {
+            if (!mqtt.IsInState<STATE_CONNECTING>())
+            {
+                reconnectAtMs.reset();
+            }
+            else
+            {
+                if (!reconnectAtMs.has_value())
+                    reconnectAtMs = lastMs + RECONNECT_MS; // it started connecting since the last clock step
+
+                if (nowMs >= *reconnectAtMs)
+                    mqtt.Reconnect();
+            }
+
+            lastMs = nowMs;
+        });
+
+        fuzzer.AddInvariant("subscribed while connected", [&](uint32_t) {
+            return !mqtt.Client().IsConnected() || mqtt.Client().UnsubscribedCount() == 0;
+        });
+        fuzzer.AddInvariant("every message reaches its handler", [&](uint32_t) { return mqtt.handled == mqtt.deliverable; });
+        fuzzer.AddMaxDwell<STATE_CONNECTING>("not stuck connecting", RECONNECT_MS + MAX_ADVANCE_MS);
+
+        std::optional<FsmFuzzer<FieldMqtt, Events>::report_t> report;
+        {
+            HostFuzz::QuietStdout quiet;
+            report = fuzzer.Run(STEPS);
+        }
+
+        BaoJson json = HostFuzz::ToJson(*report);
+        json.AddVal("messages", static_cast<int>(mqtt.handled));
+        printf("%s\n", json.PrintRaw().get());
+        if (!report->passed)
+        {
+            esp_log_level_set("*", ESP_LOG_INFO);
+            fuzzer.Print();
+        }
+        return report->passed;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    for (uint32_t seed : HostFuzz::Seeds(argc, argv))
+    {
+        if (!fuzz(seed))
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <string>
+#include <vector>
+#include "baozi_mqtt.h"
+#include "baozi_mqtt_reassembly.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    const std::string TOPIC = "baozi/light/set";
+    const std::string PAYLOAD = R"({"state":"ON","brightness":128,"color":{"r":255,"g":120,"b":0},)"
+                                R"("effect":"rainbow","transition":2.5,"flash":null,"white_value":false})";
+
+    esp_mqtt_event_t chunk(int msgId, const std::string &payload, size_t offset, size_t length, const std::string &topic = TOPIC)
+    {
+        esp_mqtt_event_t event{};
+        event.event_id = MQTT_EVENT_DATA;
+        event.msg_id = msgId;
+        event.topic = offset == 0 ? const_cast<char *>(topic.data()) : nullptr;
+        event.topic_len = offset == 0 ? static_cast<int>(topic.size()) : 0;
+        event.data = const_cast<char *>(payload.data() + offset);
+        event.data_len = static_cast<int>(length);
+        event.total_data_len = static_cast<int>(payload.size());
+        event.current_data_offset = static_cast<int>(offset);
+        return event;
+    }
+
+    // feeds the payload in chunks of chunkSize, returns the message once complete
+    std::optional<MqttReassembler::message_t> feedAll(MqttReassembler &reassembler, int msgId, const std::string &payload, size_t chunkSize)
+    {
+        std::optional<MqttReassembler::message_t> message;
+        for (size_t offset = 0; offset < payload.size(); offset += chunkSize)
+        {
+            EXPECT_FALSE(message.has_value()) << "complete before the last chunk";
+            message = reassembler.Feed(chunk(msgId, payload, offset, std::min(chunkSize, payload.size() - offset)));
+        }
+        return message;
+    }
+} // namespace
+
+TEST(MqttReassembler, ReassemblesAtEverySplit)
+{
+    MqttReassembler reassembler;
+
+    for (size_t chunkSize = 1; chunkSize <= 120; chunkSize++)
+    {
+        auto message = feedAll(reassembler, static_cast<int>(chunkSize), PAYLOAD, chunkSize);
+        ASSERT_TRUE(message.has_value()) << "chunk size " << chunkSize;
+        EXPECT_EQ(message->topic, TOPIC);
+        EXPECT_EQ(message->payload, PAYLOAD);
+        ASSERT_TRUE(message->json.has_value()) << "chunk size " << chunkSize;
+        EXPECT_EQ(message->json->GetVal<int>("brightness"), 128);
+        EXPECT_EQ(message->json->GetVal<double>("transition"), 2.5);
+        EXPECT_EQ(message->json->GetVal<BaoJsonView>("color")->GetVal<int>("b"), 0);
+        EXPECT_EQ(message->json->GetVal<bool>("white_value"), false);
+        reassembler.Release(message.value());
+    }
+
+    EXPECT_EQ(reassembler.GetStats().dropped, 0u);
+    EXPECT_EQ(reassembler.GetStats().allocatedBytes,
+              MqttReassembler::MAX_PAYLOAD_SIZE + MqttReassembler::MAX_TOKENS * sizeof(BaoJsonToken)); // one slot, reused
+}
+
+TEST(MqttReassembler, InterleavesTwoMessages)
+{
+    MqttReassembler reassembler;
+    const std::string other = R"({"state":"OFF"})";
+
+    EXPECT_FALSE(reassembler.Feed(chunk(1, PAYLOAD, 0, 10)).has_value());
+    EXPECT_FALSE(reassembler.Feed(chunk(2, other, 0, 5)).has_value());
+    EXPECT_FALSE(reassembler.Feed(chunk(1, PAYLOAD, 10, 20)).has_value());
+
+    auto second = reassembler.Feed(chunk(2, other, 5, other.size() - 5));
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->json->GetVal<std::string_view>("state"), "OFF");
+    reassembler.Release(second.value());
+
+    auto first = reassembler.Feed(chunk(1, PAYLOAD, 30, PAYLOAD.size() - 30));
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->payload, PAYLOAD);
+    EXPECT_EQ(reassembler.GetStats().peakInFlightBytes, PAYLOAD.size()); // counted with the last chunk in place
+}
+
+TEST(MqttReassembler, DropsOversizedAndOutOfOrderMessages)
+{
+    MqttReassembler reassembler;
+
+    std::string huge(MqttReassembler::MAX_PAYLOAD_SIZE + 1, ' ');
+    EXPECT_FALSE(reassembler.Feed(chunk(1, huge, 0, 100)).has_value());
+    EXPECT_EQ(reassembler.GetStats().dropped, 1u);
+
+    // a chunk that skips bytes has no slot to go to
+    EXPECT_FALSE(reassembler.Feed(chunk(2, PAYLOAD, 0, 10)).has_value());
+    EXPECT_FALSE(reassembler.Feed(chunk(2, PAYLOAD, 20, PAYLOAD.size() - 20)).has_value());
+
+    // a chunk that overflows its message drops it
+    std::string shorter = PAYLOAD.substr(0, 40);
+    EXPECT_FALSE(reassembler.Feed(chunk(3, shorter, 0, 30)).has_value());
+    EXPECT_FALSE(reassembler.Feed(chunk(3, PAYLOAD, 30, 20)).has_value());
+    EXPECT_EQ(reassembler.GetStats().dropped, 2u);
+}
+
+TEST(MqttReassembler, EvictsTheLeastRecentlyFedMessage)
+{
+    MqttReassembler reassembler;
+    constexpr int SLOTS = static_cast<int>(MqttReassembler::SLOT_COUNT);
+
+    for (int msgId = 1; msgId <= SLOTS; msgId++)
+        reassembler.Feed(chunk(msgId, PAYLOAD, 0, 10));
+    for (int msgId = 1; msgId <= SLOTS; msgId++)
+    {
+        if (msgId != 2)
+            reassembler.Feed(chunk(msgId, PAYLOAD, 10, 10)); // 2 is now the oldest
+    }
+    reassembler.Feed(chunk(SLOTS + 1, PAYLOAD, 0, 10));
+    EXPECT_EQ(reassembler.GetStats().dropped, 1u);
+
+    EXPECT_FALSE(reassembler.Feed(chunk(2, PAYLOAD, 10, PAYLOAD.size() - 10)).has_value());
+    EXPECT_TRUE(reassembler.Feed(chunk(1, PAYLOAD, 20, PAYLOAD.size() - 20)).has_value());
+}
+
+TEST(MqttReassembler, CompleteMessagesKeepTheirSlotsUntilReleased)
+{
+    MqttReassembler reassembler;
+
+    // whole messages take a slot too, esp-mqtt's buffer is gone once its event handler returns
+    std::vector<MqttReassembler::message_t> held;
+    for (int msgId = 1; msgId <= static_cast<int>(MqttReassembler::SLOT_COUNT); msgId++)
+    {
+        auto message = reassembler.Feed(chunk(msgId, PAYLOAD, 0, PAYLOAD.size()));
+        ASSERT_TRUE(message.has_value());
+        held.push_back(message.value());
+    }
+
+    // neither evicted nor overwritten by a message that finds no free slot
+    EXPECT_FALSE(reassembler.Feed(chunk(99, PAYLOAD, 0, 10)).has_value());
+    EXPECT_EQ(reassembler.GetStats().dropped, 1u);
+    for (const auto &message : held)
+    {
+        EXPECT_EQ(message.payload, PAYLOAD);
+        EXPECT_EQ(message.json->GetVal<int>("brightness"), 128);
+    }
+
+    // a disconnect drops in-flight messages only
+    reassembler.Reset();
+    EXPECT_EQ(held.front().payload, PAYLOAD);
+
+    {
+        MqttHeldMessage owner{reassembler, held.front()}; // releases the slot when it goes out of scope
+    }
+    EXPECT_TRUE(reassembler.Feed(chunk(100, PAYLOAD, 0, PAYLOAD.size())).has_value());
+}
+
+TEST(MqttReassembler, ResetDropsInFlightMessages)
+{
+    MqttReassembler reassembler;
+
+    reassembler.Feed(chunk(1, PAYLOAD, 0, 10));
+    reassembler.Reset();
+
+    EXPECT_FALSE(reassembler.Feed(chunk(1, PAYLOAD, 10, PAYLOAD.size() - 10)).has_value());
+}
+
+TEST(MqttReassembler, NonJsonPayloadsHaveNoView)
+{
+    MqttReassembler reassembler;
+    const std::string text = "just some text that is not json";
+
+    auto message = feedAll(reassembler, 1, text, 7);
+    ASSERT_TRUE(message.has_value());
+    EXPECT_EQ(message->payload, text);
+    EXPECT_FALSE(message->json.has_value());
+}
+
+TEST(MqttReassembler, ChunkedMessagesReachTheClientHandlers)
+{
+    HostMqtt::Reset();
+    MqttClient client;
+    ASSERT_EQ(client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"}), eResult::SUCCESS);
+    esp_mqtt_client_handle_t broker = HostMqtt::LastClient();
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+
+    std::vector<std::string> received;
+    client.On("baozi/light/#", [&](std::string_view topic, const BaoJsonView &payload) {
+        EXPECT_EQ(topic, TOPIC);
+        received.emplace_back(payload.GetVal<std::string_view>("effect").value_or(""));
+    });
+
+    for (size_t chunkSize : {size_t{1}, size_t{7}, size_t{64}, PAYLOAD.size()})
+        HostMqtt::DeliverData(broker, TOPIC, PAYLOAD, chunkSize);
+
+    EXPECT_EQ(received, (std::vector<std::string>(4, "rainbow")));
+}
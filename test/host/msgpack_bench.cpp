@@ -0,0 +1,75 @@
+// a sensor reading encoded and decoded as json text through cJSON, as json with BaoJsonWriter/BaoJsonView,
+// and as MessagePack with BaoMsgPackWriter/BaoMsgPackView - the last line reports the bytes per message
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include "baozi_json.h"
+#include "baozi_json_bench.h"
+#include "baozi_json_view.h"
+#include "baozi_json_writer.h"
+#include "baozi_msgpack_view.h"
+#include "baozi_msgpack_writer.h"
+
+using namespace Baozi;
+
+int main()
+{
+    static constexpr uint32_t ITERATIONS = 100000;
+
+    BaoJsonBench bench;
+    volatile double temperature = 21.5;
+    volatile int sink = 0;
+
+    auto encodeCJson = [&] {
+        BaoJson json{KV{"temperature", static_cast<double>(temperature)}, KV{"humidity", 40}, KV{"battery", 87},
+                     KV{"unit", "C"}, KV{"online", true}};
+        return json.PrintRaw();
+    };
+
+    char text[128];
+    BaoJsonWriter writer{text};
+    uint8_t binary[128];
+    BaoMsgPackWriter msgpack{binary};
+
+    auto encodeWriter = [&] {
+        writer.Reset();
+        writer.AddVals(KV{"temperature", static_cast<double>(temperature)}, KV{"humidity", 40}, KV{"battery", 87},
+                       KV{"unit", "C"}, KV{"online", true});
+    };
+
+    auto encodeMsgPack = [&] {
+        msgpack.Reset();
+        msgpack.AddVals(KV{"temperature", static_cast<double>(temperature)}, KV{"humidity", 40}, KV{"battery", 87},
+                        KV{"unit", "C"}, KV{"online", true});
+    };
+
+    bench.Run("encode_cjson", ITERATIONS, [&] { auto printed = encodeCJson(); });
+    bench.Run("encode_json_writer", ITERATIONS, encodeWriter);
+    bench.Run("encode_msgpack", ITERATIONS, encodeMsgPack);
+
+    auto printed = encodeCJson();
+    encodeWriter();
+    encodeMsgPack();
+    const std::string json = printed.get();
+
+    bench.Run("decode_cjson", ITERATIONS, [&] {
+        auto parsed = BaoJson::Parse(json.data(), json.size());
+        sink = parsed->GetVal<int>("battery").value_or(0);
+    });
+
+    bench.Run("decode_json_view", ITERATIONS, [&] {
+        std::array<BaoJsonToken, 16> tokens;
+        auto parsed = BaoJsonView::Parse(json, tokens);
+        sink = parsed->GetVal<int>("battery").value_or(0);
+    });
+
+    bench.Run("decode_msgpack_view", ITERATIONS, [&] {
+        auto parsed = BaoMsgPackView::Parse(msgpack.data(), msgpack.length());
+        sink = parsed->GetVal<int>("battery").value_or(0);
+    });
+
+    printf("%s\n", bench.Report().PrintRaw().get());
+    printf("{\"bytes\":{\"json\":%u,\"msgpack\":%u}}\n", static_cast<unsigned>(json.size()), static_cast<unsigned>(msgpack.length()));
+    return 0;
+}
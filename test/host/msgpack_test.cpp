@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+#include "baozi_json_fields.h"
+#include "baozi_msgpack_view.h"
+#include "baozi_msgpack_writer.h"
+#include "baozi_mqtt.h"
+#include "host_mqtt.h"
+
+using namespace Baozi;
+
+namespace
+{
+    struct Reading
+    {
+        float temperature;
+        int humidity;
+        std::optional<std::string> room;
+
+        BAOZI_JSON_FIELDS(Reading, temperature, humidity, room)
+    };
+
+    std::vector<uint8_t> bytes(const BaoMsgPackWriter &msg)
+    {
+        return std::vector<uint8_t>(msg.data(), msg.data() + msg.length());
+    }
+} // namespace
+
+TEST(BaoMsgPackWriter, UsesTheSmallestEncodings)
+{
+    uint8_t buffer[64];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddVals(KV{"temperature", 21.5}, KV{"unit", "C"});
+
+    std::vector<uint8_t> expected{0x82, 0xab};
+    expected.insert(expected.end(), {'t', 'e', 'm', 'p', 'e', 'r', 'a', 't', 'u', 'r', 'e'});
+    expected.insert(expected.end(), {0xca, 0x41, 0xac, 0x00, 0x00}); // float32 21.5
+    expected.insert(expected.end(), {0xa4, 'u', 'n', 'i', 't', 0xa1, 'C'});
+    EXPECT_EQ(bytes(msg), expected);
+
+    msg.Reset();
+    msg.AddVals(KV{"a", 5}, KV{"b", -3}, KV{"c", 300}, KV{"d", 2.0}, KV{"e", true}, KV{"f", std::optional<int>{}});
+    EXPECT_EQ(bytes(msg), (std::vector<uint8_t>{0x86, 0xa1, 'a', 0x05, 0xa1, 'b', 0xfd, 0xa1, 'c', 0xcd, 0x01, 0x2c,
+                                                0xa1, 'd', 0x02, 0xa1, 'e', 0xc3, 0xa1, 'f', 0xc0}));
+}
+
+TEST(BaoMsgPackWriter, RoundTripsThroughTheView)
+{
+    BaoJson effects = BaoJson::CreateArray();
+    effects.AddValToArray("rainbow");
+    effects.AddValToArray("fire");
+
+    uint8_t buffer[128];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddVals(KV{"big", 5000000000LL}, KV{"negative", -100000}, KV{"pi", 3.141592653589793}, KV{"name", std::string{"lamp"}},
+                KV{"light", BaoJson{KV{"on", true}, KV{"effects", std::move(effects)}}});
+    ASSERT_TRUE(msg);
+
+    auto view = BaoMsgPackView::Parse(msg.data(), msg.length());
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->GetVal<long long>("big"), 5000000000LL);
+    EXPECT_EQ(view->GetVal<int>("negative"), -100000);
+    EXPECT_EQ(view->GetVal<double>("pi"), 3.141592653589793);
+    EXPECT_EQ(view->GetVal<std::string_view>("name"), "lamp");
+
+    auto light = view->GetVal<BaoMsgPackView>("light");
+    ASSERT_TRUE(light.has_value());
+    EXPECT_EQ(light->GetVal<bool>("on"), true);
+
+    std::vector<std::string> seen;
+    light->GetVal<BaoMsgPackView>("effects")->ArrayForEach<std::string_view>([&](std::string_view effect) { seen.emplace_back(effect); });
+    EXPECT_EQ(seen, (std::vector<std::string>{"rainbow", "fire"}));
+}
+
+TEST(BaoMsgPackWriter, RoundTripsFieldStructs)
+{
+    uint8_t buffer[64];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddFields(Reading{.temperature = 21.25f, .humidity = 40, .room = "kitchen"});
+
+    auto view = BaoMsgPackView::Parse(msg.data(), msg.length());
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->GetVal<float>("temperature"), 21.25f);
+    EXPECT_EQ(view->GetVal<int>("humidity"), 40);
+    EXPECT_EQ(view->GetVal<std::string>("room"), "kitchen");
+}
+
+TEST(BaoMsgPackWriter, GrowsTheMapHeaderPastFifteenMembers)
+{
+    uint8_t buffer[256];
+    BaoMsgPackWriter msg{buffer};
+    for (int i = 0; i < 20; i++)
+        msg.AddVal(("k" + std::to_string(i)).c_str(), i);
+
+    ASSERT_TRUE(msg);
+    EXPECT_EQ(msg.data()[0], 0xde); // map16
+    auto view = BaoMsgPackView::Parse(msg.data(), msg.length());
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->GetVal<int>("k0"), 0);
+    EXPECT_EQ(view->GetVal<int>("k19"), 19);
+}
+
+TEST(BaoMsgPackWriter, DropsWhatDoesNotFitAndStaysValid)
+{
+    uint8_t buffer[16];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddVal("a", 1);
+    msg.AddVal("long", "a string that does not fit");
+
+    EXPECT_FALSE(msg);
+    auto view = BaoMsgPackView::Parse(msg.data(), msg.length());
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->GetVal<int>("a"), 1);
+    EXPECT_FALSE(view->HasItem("long"));
+}
+
+TEST(BaoMsgPackView, RejectsTruncatedAndTrailingBytes)
+{
+    uint8_t buffer[64];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddVals(KV{"temperature", 21.5}, KV{"unit", "C"});
+
+    for (size_t length = 0; length < msg.length(); length++)
+        EXPECT_FALSE(BaoMsgPackView::Parse(msg.data(), length).has_value()) << length;
+
+    buffer[msg.length()] = 0xc0;
+    EXPECT_FALSE(BaoMsgPackView::Parse(msg.data(), msg.length() + 1).has_value());
+}
+
+TEST(BaoMsgPackMqtt, BinaryTopicsPublishAndReceiveMessagePack)
+{
+    HostMqtt::Reset();
+    MqttClient client;
+    ASSERT_EQ(client.TryConnect(MqttClient::Config{.broker_ip = "192.168.1.10"}), eResult::SUCCESS);
+    esp_mqtt_client_handle_t broker = HostMqtt::LastClient();
+    HostMqtt::Deliver(broker, MQTT_EVENT_CONNECTED);
+
+    std::optional<int> received;
+    int invalid = 0;
+    client.On("baozi/peer/state", [&](std::string_view, const BaoMsgPackView &payload) {
+        received = payload.GetVal<int>("level");
+    });
+    client.On("baozi/peer/json", [&](std::string_view, const BaoJsonView &) { invalid++; });
+
+    uint8_t buffer[32];
+    BaoMsgPackWriter msg{buffer};
+    msg.AddVals(KV{"level", 0}, KV{"id", 7});
+    ASSERT_EQ(client.Publish("baozi/peer/state", msg), eResult::SUCCESS);
+
+    // published by length, the zero byte of level does not cut it
+    auto published = HostMqtt::Published(broker);
+    ASSERT_EQ(published.size(), 1u);
+    EXPECT_EQ(published[0].payload, std::string(reinterpret_cast<const char *>(msg.data()), msg.length()));
+
+    HostMqtt::DeliverData(broker, "baozi/peer/state", published[0].payload);
+    EXPECT_EQ(received, 0);
+
+    received.reset();
+    HostMqtt::DeliverData(broker, "baozi/peer/state", "\x82\xa5level"); // truncated, dropped
+    EXPECT_FALSE(received.has_value());
+    EXPECT_EQ(invalid, 0);
+}
@@ -0,0 +1,19 @@
+#ifndef HOST_STUB_ESP_CPU_H__
+#define HOST_STUB_ESP_CPU_H__
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the host counts nanoseconds of a steady clock as cycles
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_ESP_CPU_H__
@@ -0,0 +1,17 @@
+#ifndef HOST_STUB_ESP_MAC_H__
+#define HOST_STUB_ESP_MAC_H__
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_ESP_MAC_H__
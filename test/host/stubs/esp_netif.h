@@ -0,0 +1,26 @@
+#ifndef HOST_STUB_ESP_NETIF_H__
+#define HOST_STUB_ESP_NETIF_H__
+
+#include "esp_err.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef enum
+{
+    IP_EVENT_STA_GOT_IP,
+    IP_EVENT_STA_LOST_IP,
+} ip_event_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_netif_init(void);
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_ESP_NETIF_H__
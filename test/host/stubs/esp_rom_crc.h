@@ -0,0 +1,17 @@
+#ifndef HOST_STUB_ESP_ROM_CRC_H__
+#define HOST_STUB_ESP_ROM_CRC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the crc32 (0xEDB88320) of the rom, ~crc in and out like esp_rom_crc32_le
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_ESP_ROM_CRC_H__
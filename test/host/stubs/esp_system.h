@@ -0,0 +1,15 @@
+#ifndef HOST_STUB_ESP_SYSTEM_H__
+#define HOST_STUB_ESP_SYSTEM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// does not restart on the host, fakes/esp_system_host.cpp counts the calls (see host_esp_restart_count())
+void esp_restart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_ESP_SYSTEM_H__
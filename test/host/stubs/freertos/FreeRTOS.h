@@ -0,0 +1,62 @@
+#ifndef HOST_STUB_FREERTOS_H__
+#define HOST_STUB_FREERTOS_H__
+
+// host stand-in for the FreeRTOS kernel headers, implemented by fakes/freertos_host.cpp on std::thread
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void vHostAssertFailed(const char *file, int line, const char *expression);
+
+// every critical section of the host shares one recursive lock, the same serialization a single core gives
+typedef struct
+{
+    int owner;
+} portMUX_TYPE;
+
+void vHostEnterCritical(portMUX_TYPE *mux);
+void vHostExitCritical(portMUX_TYPE *mux);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define configASSERT(x)                                     \
+    do                                                      \
+    {                                                       \
+        if (!(x))                                           \
+            vHostAssertFailed(__FILE__, __LINE__, #x);      \
+    } while (0)
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) vHostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vHostExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vHostEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vHostExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vHostEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) vHostExitCritical(mux)
+#define taskENTER_CRITICAL(mux) vHostEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux) vHostExitCritical(mux)
+#define portYIELD_FROM_ISR(...) ((void)0)
+#define xPortInIsrContext() pdFALSE
+
+#endif // HOST_STUB_FREERTOS_H__
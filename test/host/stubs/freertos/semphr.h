@@ -0,0 +1,33 @@
+#ifndef HOST_STUB_FREERTOS_SEMPHR_H__
+#define HOST_STUB_FREERTOS_SEMPHR_H__
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HostSemaphore *SemaphoreHandle_t;
+
+// the static buffer is not used on the host, the semaphore is allocated and freed by vSemaphoreDelete
+typedef struct
+{
+    void *reserved[4];
+} StaticSemaphore_t;
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t maxCount, UBaseType_t initialCount, StaticSemaphore_t *buffer);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_FREERTOS_SEMPHR_H__
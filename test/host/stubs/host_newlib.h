@@ -0,0 +1,18 @@
+#ifndef HOST_STUB_NEWLIB_H__
+#define HOST_STUB_NEWLIB_H__
+
+// newlib functions the C library of the host may lack, force included where the host has no strlcpy
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_NEWLIB_H__
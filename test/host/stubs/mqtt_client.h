@@ -0,0 +1,97 @@
+#ifndef HOST_STUB_MQTT_CLIENT_H__
+#define HOST_STUB_MQTT_CLIENT_H__
+
+// host stand-in for esp-mqtt, implemented by fakes/esp_mqtt_host.cpp - publishes and subscribes are recorded, and a
+// test delivers broker events through host_mqtt.h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_event.h"
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum
+{
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+    MQTT_EVENT_DELETED,
+} esp_mqtt_event_id_t;
+
+typedef struct esp_mqtt_event_t
+{
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    char *data;
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+    char *topic;
+    int topic_len;
+    int msg_id;
+    int session_present;
+    void *error_handle;
+    bool retain;
+    int qos;
+    bool dup;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct
+{
+    struct
+    {
+        struct
+        {
+            const char *uri;
+            const char *hostname;
+            uint32_t port;
+        } address;
+    } broker;
+    struct
+    {
+        const char *username;
+        const char *client_id;
+        bool set_null_client_id;
+        struct
+        {
+            const char *password;
+        } authentication;
+    } credentials;
+    struct
+    {
+        struct
+        {
+            const char *topic;
+            const char *msg;
+            int msg_len;
+            int qos;
+            int retain;
+        } last_will;
+    } session;
+} esp_mqtt_client_config_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event, esp_event_handler_t event_handler,
+                                         void *event_handler_arg);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data, int len, int qos, int retain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_MQTT_CLIENT_H__
@@ -0,0 +1,16 @@
+#ifndef HOST_STUB_NVS_FLASH_H__
+#define HOST_STUB_NVS_FLASH_H__
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_STUB_NVS_FLASH_H__
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <thread>
+#include <vector>
+#include "baozi_timer_wheel.h"
+
+using namespace Baozi;
+
+namespace
+{
+    constexpr uint32_t LEVEL1 = BaoTimerWheel::SLOTS;
+    constexpr uint32_t LEVEL2 = LEVEL1 * BaoTimerWheel::SLOTS;
+    constexpr uint32_t LEVEL3 = LEVEL2 * BaoTimerWheel::SLOTS;
+
+    // delays on both sides of every boundary where a timer starts on a higher level and cascades down
+    const std::vector<uint32_t> BOUNDARY_DELAYS{1, 2, LEVEL1 - 1, LEVEL1, LEVEL1 + 1, LEVEL2 - 1, LEVEL2, LEVEL2 + 1,
+                                                LEVEL3 - 1, LEVEL3, LEVEL3 + 1};
+
+    // ticks at which each delay fired, scheduled from now
+    std::map<uint32_t, uint32_t> fireTicks(BaoTimerWheel &wheel)
+    {
+        std::map<uint32_t, uint32_t> fired;
+        uint32_t start = wheel.Now();
+        for (uint32_t delay : BOUNDARY_DELAYS)
+        {
+            EXPECT_NE(wheel.Schedule(delay, [&wheel, &fired, delay]() { fired[delay] = wheel.Now(); }), BaoTimerWheel::INVALID_TIMER);
+        }
+
+        wheel.Advance(LEVEL3 + 2);
+        for (auto &[delay, tick] : fired)
+        {
+            tick -= start;
+        }
+        return fired;
+    }
+} // namespace
+
+TEST(BaoTimerWheel, FiresOnTheExactTickAcrossEveryLevel)
+{
+    BaoTimerWheel wheel{16};
+    auto fired = fireTicks(wheel);
+
+    ASSERT_EQ(fired.size(), BOUNDARY_DELAYS.size());
+    for (uint32_t delay : BOUNDARY_DELAYS)
+    {
+        EXPECT_EQ(fired[delay], delay) << "delay " << delay;
+    }
+    EXPECT_EQ(wheel.PendingCount(), 0u);
+}
+
+TEST(BaoTimerWheel, FiresOnTheExactTickWhenScheduledBetweenCascades)
+{
+    // the slots of the higher levels are partly gone by, the timers must still land in the right ones
+    for (uint32_t offset : {37u, LEVEL1 + 5, LEVEL2 - 3, LEVEL2 + LEVEL1 + 1})
+    {
+        BaoTimerWheel wheel{16};
+        wheel.Advance(offset);
+
+        auto fired = fireTicks(wheel);
+        ASSERT_EQ(fired.size(), BOUNDARY_DELAYS.size()) << "offset " << offset;
+        for (uint32_t delay : BOUNDARY_DELAYS)
+        {
+            EXPECT_EQ(fired[delay], delay) << "offset " << offset << " delay " << delay;
+        }
+    }
+}
+
+TEST(BaoTimerWheel, ZeroTicksFireOnTheNextTick)
+{
+    BaoTimerWheel wheel{4};
+    int calls = 0;
+    wheel.Schedule(0, [&calls]() { calls++; });
+
+    wheel.Advance(0);
+    EXPECT_EQ(calls, 0);
+    wheel.Advance(1);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(BaoTimerWheel, RequeuesDelaysLongerThanTheWheel)
+{
+    BaoTimerWheel wheel{4};
+    uint32_t firedAt = 0;
+    wheel.Schedule(BaoTimerWheel::MAX_TICKS + 10, [&]() { firedAt = wheel.Now(); });
+
+    wheel.Advance(BaoTimerWheel::MAX_TICKS + 9);
+    EXPECT_EQ(firedAt, 0u);
+    wheel.Advance(1);
+    EXPECT_EQ(firedAt, BaoTimerWheel::MAX_TICKS + 10);
+}
+
+TEST(BaoTimerWheel, CancelledTimersNeverFire)
+{
+    BaoTimerWheel wheel{4};
+    int calls = 0;
+    auto id = wheel.Schedule(100, [&calls]() { calls++; });
+
+    wheel.Advance(50);
+    EXPECT_TRUE(wheel.IsPending(id));
+    EXPECT_TRUE(wheel.Cancel(id));
+    EXPECT_FALSE(wheel.IsPending(id));
+    EXPECT_FALSE(wheel.Cancel(id));
+    EXPECT_EQ(wheel.PendingCount(), 0u);
+
+    wheel.Advance(100);
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(BaoTimerWheel, CancelsATimerThatCascadedDown)
+{
+    BaoTimerWheel wheel{4};
+    int calls = 0;
+    auto id = wheel.Schedule(LEVEL2 + 904, [&calls]() { calls++; });
+
+    // by now it moved from level 2 through level 1 to level 0
+    wheel.Advance(LEVEL2 + 900);
+    EXPECT_TRUE(wheel.Cancel(id));
+
+    wheel.Advance(100);
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(wheel.PendingCount(), 0u);
+}
+
+TEST(BaoTimerWheel, IdsTurnStaleOnceTheTimerFired)
+{
+    BaoTimerWheel wheel{1};
+    int first = 0;
+    int second = 0;
+
+    auto old = wheel.Schedule(1, [&first]() { first++; });
+    wheel.Advance(1);
+    EXPECT_EQ(first, 1);
+    EXPECT_FALSE(wheel.IsPending(old));
+    EXPECT_FALSE(wheel.Cancel(old));
+
+    // the single timer is reused under a new generation, the old id can not cancel it
+    auto reused = wheel.Schedule(1, [&second]() { second++; });
+    EXPECT_NE(reused, old);
+    EXPECT_FALSE(wheel.Cancel(old));
+    EXPECT_TRUE(wheel.IsPending(reused));
+
+    wheel.Advance(1);
+    EXPECT_EQ(second, 1);
+    EXPECT_FALSE(wheel.Cancel(BaoTimerWheel::INVALID_TIMER));
+}
+
+TEST(BaoTimerWheel, ReturnsInvalidTimerWhenThePoolIsEmpty)
+{
+    BaoTimerWheel wheel{2};
+    EXPECT_NE(wheel.Schedule(5, []() {}), BaoTimerWheel::INVALID_TIMER);
+    EXPECT_NE(wheel.Schedule(10, []() {}), BaoTimerWheel::INVALID_TIMER);
+    EXPECT_EQ(wheel.Schedule(1, []() {}), BaoTimerWheel::INVALID_TIMER);
+
+    wheel.Advance(5);
+    EXPECT_NE(wheel.Schedule(1, []() {}), BaoTimerWheel::INVALID_TIMER);
+    EXPECT_EQ(wheel.PendingCount(), 2u);
+}
+
+TEST(BaoTimerWheel, CallbacksScheduleAndCancelTimers)
+{
+    BaoTimerWheel wheel{4};
+    std::vector<std::pair<const char *, uint32_t>> fired;
+    BaoTimerWheel::timer_id_t sameTick = BaoTimerWheel::INVALID_TIMER;
+
+    wheel.Schedule(10, [&]() {
+        fired.emplace_back("first", wheel.Now());
+        wheel.Schedule(3, [&]() { fired.emplace_back("rescheduled", wheel.Now()); });
+
+        // already expired on this tick, cancelling still keeps it from firing
+        EXPECT_TRUE(wheel.Cancel(sameTick));
+    });
+    sameTick = wheel.Schedule(10, [&]() { fired.emplace_back("cancelled", wheel.Now()); });
+
+    wheel.Advance(20);
+    EXPECT_EQ(fired, (std::vector<std::pair<const char *, uint32_t>>{{"first", 10}, {"rescheduled", 13}}));
+}
+
+TEST(BaoTimerService, FiresAfterTheDelayOnTheTimerTask)
+{
+    auto &timers = BaoTimerService::GetInstance();
+    std::promise<void> fired;
+    auto start = std::chrono::steady_clock::now();
+
+    ASSERT_NE(timers.Schedule(30, [&fired]() { fired.set_value(); }), BaoTimerWheel::INVALID_TIMER);
+    ASSERT_EQ(fired.get_future().wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(30));
+}
+
+TEST(BaoTimerService, CancelledTimersNeverFire)
+{
+    auto &timers = BaoTimerService::GetInstance();
+    std::atomic<int> calls{};
+
+    auto id = timers.Schedule(50, [&calls]() { calls++; });
+    EXPECT_TRUE(timers.Cancel(id));
+    EXPECT_FALSE(timers.Cancel(id));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(BaoTimerService, AManualClockFiresOnlyWhenAdvanced)
+{
+    BaoTimerService timers{BaoTimerService::eClock::MANUAL};
+    std::vector<uint32_t> fired;
+    uint32_t nowMs = 0;
+    auto advance = [&](uint32_t ms) {
+        nowMs += ms;
+        timers.Advance(ms);
+    };
+
+    ASSERT_NE(timers.Schedule(30, [&]() { fired.push_back(nowMs); }), BaoTimerWheel::INVALID_TIMER);
+    auto cancelled = timers.Schedule(40, [&]() { fired.push_back(0); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_TRUE(fired.empty());
+
+    advance(20);
+    EXPECT_TRUE(fired.empty());
+    EXPECT_TRUE(timers.Cancel(cancelled));
+    advance(10);
+    EXPECT_EQ(fired, (std::vector<uint32_t>{30}));
+
+    // a timer scheduled between advances counts from the time it was scheduled at
+    ASSERT_NE(timers.Schedule(25, [&]() { fired.push_back(nowMs); }), BaoTimerWheel::INVALID_TIMER);
+    advance(1000);
+    EXPECT_EQ(fired, (std::vector<uint32_t>{30, 1030}));
+}
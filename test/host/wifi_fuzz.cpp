@@ -0,0 +1,147 @@
+// Wifi under FsmFuzzer - random app calls and driver events on a virtual clock, with an access point that comes and
+// goes, checking that a station that never gets an ip restarts the chip instead of retrying forever. Prints the report
+// of every seed with its events/sec
+//   wifi_fuzz [seed...]
+
+#include <cstdio>
+#include <iterator>
+#include <optional>
+#include <variant>
+#include "baozi_wifi.h"
+#include "esp_log.h"
+#include "fsm_fuzz.h"
+#include "host_fuzz.h"
+#include "host_idf.h"
+#include "host_wifi.h"
+
+using namespace Baozi;
+using namespace Baozi::WifiFSM;
+
+namespace
+{
+    constexpr uint32_t STEPS = 200000;
+    constexpr uint32_t MAX_ADVANCE_MS = 60000;
+    constexpr uint32_t AP_TOGGLE_PERCENT = 5; // of the clock steps, the access point stays away for ~10 minutes
+
+    // the longest a station may stay in STATE_Connecting without a restart - every timeout retries, the one after
+    // MAX_RETRIES restarts. The wheel may fire a timeout a tick early, never late
+    constexpr uint32_t MAX_CONNECTING_MS = (Wifi::MAX_RETRIES + 1) * Wifi::CONNECT_TIMEOUT.value() + BaoTimerService::TICK.value();
+
+    // raises each event where the field raises it - the app's calls or the faked driver - so the fuzzer reaches the
+    // fsm through the same handlers as a real access point does. Out of range, the access point never connects
+    class FieldWifi
+    {
+    public:
+        bool apInRange = true;
+
+        explicit FieldWifi(BaoTimerService &timers) : m_wifi(timers) { m_wifi.Init(); }
+
+        void Dispatch(Events event)
+        {
+            std::visit([this](auto &e) { raise(e); }, event);
+        }
+
+        template <typename State>
+        bool IsInState() const
+        {
+            return m_wifi.IsInState<State>();
+        }
+
+    private:
+        Wifi m_wifi;
+
+        void raise(EVENT_APStart &) { m_wifi.SwitchToAP(); }
+        void raise(EVENT_APStop &) { HostWifi::Post(WIFI_EVENT_AP_STOP); }
+        void raise(EVENT_Disconnect &) { m_wifi.Disconnect(); }
+        void raise(EVENT_StaConnect &) { m_wifi.Connect("home", "secret"); }
+        void raise(EVENT_StaStart &) { HostWifi::Post(WIFI_EVENT_STA_START); }
+        void raise(EVENT_StaConnected &)
+        {
+            if (apInRange)
+                HostWifi::Post(WIFI_EVENT_STA_CONNECTED);
+        }
+
+        void raise(EVENT_LoseConnection &event) { HostWifi::PostDisconnected(event.reason); }
+        void raise(EVENT_UserConnected &) { HostWifi::Post(WIFI_EVENT_AP_STACONNECTED); }
+        void raise(EVENT_GotIP &)
+        {
+            if (apInRange)
+                HostWifi::PostGotIp();
+        }
+
+        void raise(EVENT_ConnectTimeout &) {} // only the timer raises it
+    };
+
+    constexpr wifi_err_reason_t REASONS[] = {WIFI_REASON_BEACON_TIMEOUT, WIFI_REASON_ASSOC_LEAVE, WIFI_REASON_NO_AP_FOUND,
+                                             WIFI_REASON_AUTH_FAIL};
+
+    bool fuzz(uint32_t seed)
+    {
+        HostWifi::Reset();
+        HostIdf::ResetRestartCount();
+
+        BaoTimerService timers{BaoTimerService::eClock::MANUAL};
+        FieldWifi wifi{timers};
+        FsmFuzzer<FieldWifi, Events> fuzzer{wifi, seed, MAX_ADVANCE_MS};
+        fuzzer.Disable<EVENT_ConnectTimeout>();
+        fuzzer.SetGenerator<EVENT_LoseConnection>([](FsmFuzzRandom &random) {
+            return EVENT_LoseConnection{.reason = REASONS[random.Below(std::size(REASONS))]};
+        });
+
+        // a timeout retries only the attempt in progress
+        bool retriedWhileNotConnecting = false;
+        uint32_t lastMs = 0;
+        fuzzer.OnAdvance([&](uint32_t nowMs) {
+            bool wasConnecting = wifi.IsInState<STATE_Connecting>();
+            uint32_t connects = HostWifi::GetCalls().connects;
+            timers.Advance(nowMs - lastMs);
+            lastMs = nowMs;
+            retriedWhileNotConnecting |= !wasConnecting && HostWifi::GetCalls().connects != connects;
+
+            if (fuzzer.Random().Percent(AP_TOGGLE_PERCENT))
+                wifi.apInRange = !wifi.apInRange;
+        });
+        fuzzer.AddInvariant("retries only while connecting", [&](uint32_t) { return !retriedWhileNotConnecting; });
+
+        uint32_t connectingSinceMs = 0;
+        uint32_t restarts = 0;
+        bool wasConnecting = false;
+        fuzzer.AddInvariant("restarts instead of connecting forever", [&](uint32_t nowMs) {
+            bool isConnecting = wifi.IsInState<STATE_Connecting>();
+            if ((isConnecting && !wasConnecting) || HostIdf::RestartCount() != restarts)
+                connectingSinceMs = nowMs;
+
+            restarts = HostIdf::RestartCount();
+            wasConnecting = isConnecting;
+            return !isConnecting || nowMs - connectingSinceMs <= MAX_CONNECTING_MS;
+        });
+
+        std::optional<FsmFuzzer<FieldWifi, Events>::report_t> report;
+        {
+            HostFuzz::QuietStdout quiet;
+            report = fuzzer.Run(STEPS);
+        }
+
+        BaoJson json = HostFuzz::ToJson(*report);
+        json.AddVal("restarts", static_cast<int>(HostIdf::RestartCount()));
+        printf("%s\n", json.PrintRaw().get());
+        if (!report->passed)
+        {
+            esp_log_level_set("*", ESP_LOG_INFO);
+            fuzzer.Print();
+        }
+        return report->passed;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    for (uint32_t seed : HostFuzz::Seeds(argc, argv))
+    {
+        if (!fuzz(seed))
+            return 1;
+    }
+    return 0;
+}
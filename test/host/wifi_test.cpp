@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include "baozi_wifi.h"
+#include "esp_log.h"
+#include "host_idf.h"
+#include "host_wifi.h"
+
+using namespace Baozi;
+using namespace Baozi::WifiFSM;
+
+namespace
+{
+    class WifiTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            esp_log_level_set("*", ESP_LOG_WARN);
+            HostWifi::Reset();
+            HostIdf::ResetRestartCount();
+            wifi.emplace(timers);
+            wifi->Init();
+        }
+
+        void TearDown() override
+        {
+            HostWifi::Reset();
+            esp_log_level_set("*", ESP_LOG_INFO);
+        }
+
+        // connect and let the driver start the station
+        void connecting()
+        {
+            ASSERT_TRUE(wifi->Connect("home", "secret"));
+            HostWifi::Post(WIFI_EVENT_STA_START);
+            ASSERT_TRUE(wifi->IsInState<STATE_Connecting>());
+        }
+
+        // nothing times out unless a test advances the clock
+        BaoTimerService timers{BaoTimerService::eClock::MANUAL};
+        std::optional<Wifi> wifi;
+    };
+} // namespace
+
+TEST_F(WifiTest, ConnectsWhenTheIpArrives)
+{
+    connecting();
+    EXPECT_EQ(HostWifi::GetCalls().mode, WIFI_MODE_STA);
+    EXPECT_EQ(HostWifi::GetCalls().staSsid, "home");
+    EXPECT_EQ(HostWifi::GetCalls().connects, 1u);
+
+    HostWifi::PostGotIp();
+    EXPECT_TRUE(wifi->IsConnected());
+}
+
+TEST_F(WifiTest, ReconnectsAfterLosingTheAccessPoint)
+{
+    connecting();
+    HostWifi::PostGotIp();
+
+    HostWifi::PostDisconnected(WIFI_REASON_BEACON_TIMEOUT);
+    EXPECT_TRUE(wifi->IsInState<STATE_Connecting>());
+
+    HostWifi::PostDisconnected(WIFI_REASON_ASSOC_LEAVE);
+    HostWifi::Post(WIFI_EVENT_STA_START);
+    HostWifi::PostGotIp();
+    EXPECT_TRUE(wifi->IsConnected());
+}
+
+// the timer of a finished attempt can fire while stopConnectTimeout() cancels it, its event must not retry the
+// attempt that followed
+TEST_F(WifiTest, IgnoresTheTimeoutOfAFinishedConnectAttempt)
+{
+    connecting(); // attempt 1
+    HostWifi::PostGotIp();  // over, the timer is cancelled
+    HostWifi::PostDisconnected(WIFI_REASON_BEACON_TIMEOUT);
+    HostWifi::Post(WIFI_EVENT_STA_START);
+    ASSERT_TRUE(wifi->IsInState<STATE_Connecting>());
+    uint32_t connects = HostWifi::GetCalls().connects;
+
+    // the first attempt's timeout and the one stopped when the ip arrived
+    EXPECT_TRUE(wifi->Dispatch(EVENT_ConnectTimeout{.attempt = 1}));
+    EXPECT_TRUE(wifi->Dispatch(EVENT_ConnectTimeout{.attempt = 2}));
+
+    EXPECT_EQ(HostWifi::GetCalls().connects, connects);
+    EXPECT_TRUE(wifi->IsInState<STATE_Connecting>());
+    EXPECT_EQ(HostIdf::RestartCount(), 0u);
+}
+
+TEST_F(WifiTest, RetriesWhenNoIpArrivesInTime)
+{
+    connecting();
+    uint32_t connects = HostWifi::GetCalls().connects;
+
+    timers.Advance(Wifi::CONNECT_TIMEOUT.value() - BaoTimerService::TICK.value());
+    EXPECT_EQ(HostWifi::GetCalls().connects, connects);
+
+    timers.Advance(BaoTimerService::TICK);
+    EXPECT_EQ(HostWifi::GetCalls().connects, connects + 1);
+    EXPECT_TRUE(wifi->IsInState<STATE_Connecting>());
+
+    // the retry waits a whole timeout again
+    timers.Advance(Wifi::CONNECT_TIMEOUT);
+    EXPECT_EQ(HostWifi::GetCalls().connects, connects + 2);
+}
+
+TEST_F(WifiTest, RestartsAfterMaxRetriesTimeouts)
+{
+    connecting();
+
+    for (int i = 0; i < Wifi::MAX_RETRIES; i++)
+        timers.Advance(Wifi::CONNECT_TIMEOUT);
+    EXPECT_EQ(HostIdf::RestartCount(), 0u);
+
+    timers.Advance(Wifi::CONNECT_TIMEOUT);
+    EXPECT_EQ(HostIdf::RestartCount(), 1u);
+}
+
+TEST_F(WifiTest, AConnectionStartsTheRetriesOver)
+{
+    connecting();
+    for (int i = 0; i < Wifi::MAX_RETRIES; i++)
+        timers.Advance(Wifi::CONNECT_TIMEOUT);
+
+    HostWifi::PostGotIp();
+    HostWifi::PostDisconnected(WIFI_REASON_BEACON_TIMEOUT);
+    for (int i = 0; i < Wifi::MAX_RETRIES; i++)
+        timers.Advance(Wifi::CONNECT_TIMEOUT);
+
+    EXPECT_TRUE(wifi->IsInState<STATE_Connecting>());
+    EXPECT_EQ(HostIdf::RestartCount(), 0u);
+}